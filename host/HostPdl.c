@@ -0,0 +1,500 @@
+/******************************************************************************
+* File Name: HostPdl.c
+*
+* Description: This file emulates, on a Linux host, the interrupts, the
+*              SysTick timer and the GPIO used by the SPI slave.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <stdio.h>
+#include "cy_pdl.h"
+#include "cybsp.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define HOST_CORE_CLOCK_HZ      (48000000UL)
+#define HOST_SYSTICK_SLOTS      (5u)
+#define NS_PER_S                (1000000000ULL)
+
+/* Longest sleep, in case no interrupt ends it */
+#define HOST_SLEEP_MAX_NS       (2000000ULL)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+uint32_t SystemCoreClock = HOST_CORE_CLOCK_HZ;
+GPIO_PRT_Type host_led_port;
+
+/* Interrupt lock, held by a thread in a critical section or running an
+ * interrupt; the depth allows nesting within a thread */
+static pthread_mutex_t irq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t irq_event = PTHREAD_COND_INITIALIZER;
+static __thread uint32_t irq_depth;
+static volatile bool irq_enabled;
+
+/* SysTick state */
+static SCB_Type scb_regs;
+static uint32_t systick_reload;
+static uint64_t systick_period_start_ns;
+static bool systick_running;
+static Cy_SysTick_Callback systick_callbacks[HOST_SYSTICK_SLOTS];
+static pthread_t systick_thread;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint64_t now_ns(void);
+static uint64_t systick_period_ns(void);
+static uint64_t systick_elapsed_cycles(void);
+static void systick_isr(void);
+static void *systick_main(void *);
+
+/*******************************************************************************
+* Function Name: now_ns
+********************************************************************************
+*
+* Summary:
+*  Returns the monotonic time in nanoseconds.
+*
+*******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * NS_PER_S) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+* Function Name: systick_period_ns
+********************************************************************************
+*
+* Summary:
+*  Returns the SysTick period in nanoseconds.
+*
+*******************************************************************************/
+static uint64_t systick_period_ns(void)
+{
+    return (((uint64_t)systick_reload + 1ULL) * NS_PER_S) / SystemCoreClock;
+}
+
+/*******************************************************************************
+* Function Name: systick_elapsed_cycles
+********************************************************************************
+*
+* Summary:
+*  Returns the CPU cycles since the start of the period not yet serviced.
+*
+*******************************************************************************/
+static uint64_t systick_elapsed_cycles(void)
+{
+    return ((now_ns() - systick_period_start_ns) * SystemCoreClock) / NS_PER_S;
+}
+
+/*******************************************************************************
+* Function Name: systick_isr
+********************************************************************************
+*
+* Summary:
+*  SysTick interrupt: ends the current period and calls the callbacks.
+*
+*******************************************************************************/
+static void systick_isr(void)
+{
+    uint32_t slot;
+
+    systick_period_start_ns += systick_period_ns();
+
+    for (slot = 0u; slot < HOST_SYSTICK_SLOTS; slot++)
+    {
+        if (NULL != systick_callbacks[slot])
+        {
+            systick_callbacks[slot]();
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: systick_main
+********************************************************************************
+*
+* Summary:
+*  SysTick thread. Takes the interrupt at the end of each period. While
+*  the interrupt lock is held elsewhere, the wrap shows as pending.
+*
+*******************************************************************************/
+static void *systick_main(void *arg)
+{
+    struct timespec ts;
+    uint64_t deadline;
+
+    (void) arg;
+
+    for (;;)
+    {
+        deadline = systick_period_start_ns + systick_period_ns();
+        ts.tv_sec = (time_t)(deadline / NS_PER_S);
+        ts.tv_nsec = (long)(deadline % NS_PER_S);
+        (void) clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        (void) Cy_SysLib_EnterCriticalSection();
+        host_irq_run(&systick_isr);
+        Cy_SysLib_ExitCriticalSection(0UL);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysLib_EnterCriticalSection
+********************************************************************************
+*
+* Summary:
+*  Takes the interrupt lock, so no emulated interrupt runs until the
+*  matching Cy_SysLib_ExitCriticalSection().
+*
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    if (0u == irq_depth)
+    {
+        (void) pthread_mutex_lock(&irq_mutex);
+    }
+    irq_depth++;
+
+    return 0UL;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysLib_ExitCriticalSection
+********************************************************************************
+*
+* Summary:
+*  Releases the interrupt lock taken by the matching enter call. The
+*  thread then yields, so an interrupt waiting for the lock is not held
+*  off by a main loop that polls in critical sections.
+*
+*******************************************************************************/
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus)
+{
+    (void) savedIntrStatus;
+
+    irq_depth--;
+    if (0u == irq_depth)
+    {
+        (void) pthread_mutex_unlock(&irq_mutex);
+        (void) sched_yield();
+    }
+}
+
+/*******************************************************************************
+* Function Name: host_irq_run
+********************************************************************************
+*
+* Summary:
+*  Runs an interrupt service routine once interrupts are enabled, and
+*  wakes the main thread if it sleeps. The caller holds the interrupt lock.
+*
+*******************************************************************************/
+void host_irq_run(void (*isr)(void))
+{
+    if (irq_enabled)
+    {
+        isr();
+        (void) pthread_cond_broadcast(&irq_event);
+    }
+}
+
+/*******************************************************************************
+* Function Name: __enable_irq
+********************************************************************************
+*
+* Summary:
+*  Lets the emulated interrupts run.
+*
+*******************************************************************************/
+void __enable_irq(void)
+{
+    irq_enabled = true;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysPm_CpuEnterSleep
+********************************************************************************
+*
+* Summary:
+*  Waits for the next interrupt. As on the device, a caller in a critical
+*  section is woken by an interrupt, which runs during the wait.
+*
+*******************************************************************************/
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void)
+{
+    struct timespec ts;
+    uint64_t deadline = now_ns() + HOST_SLEEP_MAX_NS;
+
+    ts.tv_sec = (time_t)(deadline / NS_PER_S);
+    ts.tv_nsec = (long)(deadline % NS_PER_S);
+
+    (void) Cy_SysLib_EnterCriticalSection();
+    (void) pthread_cond_timedwait(&irq_event, &irq_mutex, &ts);
+    Cy_SysLib_ExitCriticalSection(0UL);
+
+    return CY_SYSPM_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: NVIC_SetPriority
+********************************************************************************
+*
+* Summary:
+*  Emulated interrupts all have the same priority.
+*
+*******************************************************************************/
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    (void) IRQn;
+    (void) priority;
+}
+
+/*******************************************************************************
+* Function Name: NVIC_SystemReset
+********************************************************************************
+*
+* Summary:
+*  Ends the process; a supervisor can start it again.
+*
+*******************************************************************************/
+void NVIC_SystemReset(void)
+{
+    exit(EXIT_SUCCESS);
+}
+
+/*******************************************************************************
+* Function Name: SystemCoreClockUpdate
+********************************************************************************
+*
+* Summary:
+*  The emulated clock does not change.
+*
+*******************************************************************************/
+void SystemCoreClockUpdate(void)
+{
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_Init
+********************************************************************************
+*
+* Summary:
+*  Sets the SysTick period. The timer starts with Cy_SysTick_Enable().
+*
+*******************************************************************************/
+void Cy_SysTick_Init(cy_en_systick_clock_source_t clockSource, uint32_t interval)
+{
+    (void) clockSource;
+
+    systick_reload = interval;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_SetCallback
+********************************************************************************
+*
+* Summary:
+*  Sets the callback of a slot and returns the previous one.
+*
+*******************************************************************************/
+Cy_SysTick_Callback Cy_SysTick_SetCallback(uint32_t number, Cy_SysTick_Callback function)
+{
+    Cy_SysTick_Callback previous = NULL;
+
+    if (number < HOST_SYSTICK_SLOTS)
+    {
+        (void) Cy_SysLib_EnterCriticalSection();
+        previous = systick_callbacks[number];
+        systick_callbacks[number] = function;
+        Cy_SysLib_ExitCriticalSection(0UL);
+    }
+
+    return previous;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_Enable
+********************************************************************************
+*
+* Summary:
+*  Starts the SysTick thread.
+*
+*******************************************************************************/
+void Cy_SysTick_Enable(void)
+{
+    if (!systick_running)
+    {
+        systick_running = true;
+        systick_period_start_ns = now_ns();
+        CY_ASSERT(0 == pthread_create(&systick_thread, NULL, &systick_main, NULL));
+    }
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_GetValue
+********************************************************************************
+*
+* Summary:
+*  Returns the current value of the down counter.
+*
+*******************************************************************************/
+uint32_t Cy_SysTick_GetValue(void)
+{
+    return systick_reload - (uint32_t)(systick_elapsed_cycles() % ((uint64_t)systick_reload + 1ULL));
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_GetReload
+********************************************************************************
+*
+* Summary:
+*  Returns the reload value.
+*
+*******************************************************************************/
+uint32_t Cy_SysTick_GetReload(void)
+{
+    return systick_reload;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_SetReload
+********************************************************************************
+*
+* Summary:
+*  Sets the reload value, used from the next period on.
+*
+*******************************************************************************/
+void Cy_SysTick_SetReload(uint32_t value)
+{
+    systick_reload = value;
+}
+
+/*******************************************************************************
+* Function Name: Cy_SysTick_Clear
+********************************************************************************
+*
+* Summary:
+*  Restarts the current period.
+*
+*******************************************************************************/
+void Cy_SysTick_Clear(void)
+{
+    systick_period_start_ns = now_ns();
+}
+
+/*******************************************************************************
+* Function Name: host_scb
+********************************************************************************
+*
+* Summary:
+*  Returns the SCB registers with the SysTick pending flag set if the
+*  current period has ended but its interrupt has not run yet. Writes to
+*  the registers have no effect.
+*
+*******************************************************************************/
+SCB_Type *host_scb(void)
+{
+    scb_regs.ICSR = (systick_elapsed_cycles() > systick_reload) ? SCB_ICSR_PENDSTSET_Msk : 0UL;
+
+    return &scb_regs;
+}
+
+/*******************************************************************************
+* Function Name: cybsp_init
+********************************************************************************
+*
+* Summary:
+*  Nothing to initialize on the host.
+*
+*******************************************************************************/
+cy_rslt_t cybsp_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: Cy_Flash_WriteRow
+********************************************************************************
+*
+* Summary:
+*  The host build has no flash; every write fails.
+*
+*******************************************************************************/
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    (void) rowAddr;
+    (void) data;
+
+    return CY_FLASH_DRV_INV_PROT;
+}
+
+/*******************************************************************************
+* Function Name: Cy_GPIO_Set
+********************************************************************************
+*
+* Summary:
+*  Sets an output.
+*
+*******************************************************************************/
+void Cy_GPIO_Set(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    base->out |= (1UL << pinNum);
+}
+
+/*******************************************************************************
+* Function Name: Cy_GPIO_Clr
+********************************************************************************
+*
+* Summary:
+*  Clears an output.
+*
+*******************************************************************************/
+void Cy_GPIO_Clr(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    base->out &= ~(1UL << pinNum);
+}
+
+/* [] END OF FILE */
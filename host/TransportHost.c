@@ -0,0 +1,598 @@
+/******************************************************************************
+* File Name: TransportHost.c
+*
+* Description: This file contains the host backend of the byte transport
+*              under the SPI slave driver: a Unix domain socket or a pty.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Transport.h"
+#include "SpiSlave.h"
+#include "AdcStream.h"
+#include "GpioCapture.h"
+#include "ClockGovernor.h"
+#include "FlashScan.h"
+#include "DualSlot.h"
+#include "StackMonitor.h"
+
+#if (SPI_TRANSPORT == SPI_TRANSPORT_HOST)
+
+#if ((ADC_STREAM != 0u) || (GPIO_CAPTURE != 0u) || (CLOCK_GOVERNOR != 0u) ||\
+     (FLASH_SCAN != 0u) || (DUAL_SLOT != 0u) || (STACK_MONITOR != 0u) || (SPI_MULTIDROP != 0u))
+#error "The host build does not emulate the ADC, GPIO capture, clock, flash or stack"
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* FIFO depth of the SCB in byte mode */
+#define HOST_FIFO_SIZE          (8u)
+
+/* Socket path, unless set in the SPI_SLAVE_SOCKET environment variable.
+ * With SPI_SLAVE_PTY set, a pty is used instead and its name printed. */
+#define HOST_SOCKET_PATH        "/tmp/spi-slave.sock"
+
+/* Byte sent by the slave while it has nothing to shift out */
+#define HOST_IDLE_BYTE          (0xFFu)
+
+/* Bytes exchanged per read from the link */
+#define HOST_CHUNK_SIZE         (256u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Emulated FIFOs, accessed under the interrupt lock */
+static uint8_t rx_fifo[HOST_FIFO_SIZE];
+static uint32_t rx_head;
+static uint32_t rx_count;
+static bool rx_overflow;
+static uint8_t tx_fifo[HOST_FIFO_SIZE];
+static uint32_t tx_head;
+static uint32_t tx_count;
+
+/* RX interrupt: enabled, and trigger level, 0 for any byte */
+static bool rx_irq_enabled;
+static uint32_t rx_irq_level;
+
+static bool miso_driven = true;
+
+/* Transfer of a fixed number of bytes */
+static uint8_t const *transfer_tx;
+static uint8_t *transfer_rx;
+static uint32_t transfer_size;
+static uint32_t transfer_count;
+static volatile bool transfer_active;
+
+static transport_isr_t host_isr;
+static int listen_fd = -1;
+static int link_fd = -1;
+static pthread_t link_thread;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint8_t shift_byte(uint8_t);
+static bool rx_irq_pending(void);
+static bool write_all(int, uint8_t const *, size_t);
+static int open_pty(void);
+static int open_socket(char const *);
+static void *link_main(void *);
+
+/*******************************************************************************
+* Function Name: shift_byte
+********************************************************************************
+*
+* Summary:
+*  Exchanges one byte with the master, as the SCB does for each byte
+*  clocked: the received byte goes to the RX FIFO, or to the transfer
+*  buffer, and the byte returned is taken from the TX FIFO.
+*
+*******************************************************************************/
+static uint8_t shift_byte(uint8_t in)
+{
+    uint8_t out = HOST_IDLE_BYTE;
+
+    if (transfer_active)
+    {
+        out = transfer_tx[transfer_count];
+        transfer_rx[transfer_count] = in;
+        transfer_count++;
+        transfer_active = (transfer_count < transfer_size);
+    }
+    else
+    {
+        if (0u != tx_count)
+        {
+            out = tx_fifo[tx_head];
+            tx_head = (tx_head + 1u) % HOST_FIFO_SIZE;
+            tx_count--;
+        }
+
+        if (rx_count < HOST_FIFO_SIZE)
+        {
+            rx_fifo[(rx_head + rx_count) % HOST_FIFO_SIZE] = in;
+            rx_count++;
+        }
+        else
+        {
+            rx_overflow = true;
+        }
+    }
+
+    return miso_driven ? out : HOST_IDLE_BYTE;
+}
+
+/*******************************************************************************
+* Function Name: rx_irq_pending
+********************************************************************************
+*
+* Summary:
+*  Returns true if the RX FIFO raises the interrupt.
+*
+*******************************************************************************/
+static bool rx_irq_pending(void)
+{
+    return rx_irq_enabled && (rx_count > rx_irq_level);
+}
+
+/*******************************************************************************
+* Function Name: write_all
+********************************************************************************
+*
+* Summary:
+*  Writes a whole buffer to the link. Returns false if the link closed.
+*
+*******************************************************************************/
+static bool write_all(int fd, uint8_t const *data, size_t length)
+{
+    ssize_t written;
+
+    while (0u != length)
+    {
+        written = write(fd, data, length);
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: open_pty
+********************************************************************************
+*
+* Summary:
+*  Opens a pty in raw mode and prints the name the master opens. The
+*  slave side is kept open so the link survives the master closing it.
+*
+*******************************************************************************/
+static int open_pty(void)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    int peer;
+
+    if ((fd < 0) || (0 != grantpt(fd)) || (0 != unlockpt(fd)))
+    {
+        perror("pty");
+        return -1;
+    }
+
+    peer = open(ptsname(fd), O_RDWR | O_NOCTTY);
+    if ((peer < 0) || (0 != tcgetattr(peer, &tio)))
+    {
+        perror("pty");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    (void) tcsetattr(peer, TCSANOW, &tio);
+
+    printf("SPI slave on %s\n", ptsname(fd));
+    (void) fflush(stdout);
+
+    return fd;
+}
+
+/*******************************************************************************
+* Function Name: open_socket
+********************************************************************************
+*
+* Summary:
+*  Creates the listening Unix domain socket. One master connects at a
+*  time.
+*
+*******************************************************************************/
+static int open_socket(char const *path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    (void) memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void) strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1u);
+    (void) unlink(path);
+
+    if ((0 != bind(fd, (struct sockaddr const *)&addr, sizeof(addr))) || (0 != listen(fd, 1)))
+    {
+        perror(path);
+        (void) close(fd);
+        return -1;
+    }
+
+    printf("SPI slave on %s\n", path);
+    (void) fflush(stdout);
+
+    return fd;
+}
+
+/*******************************************************************************
+* Function Name: link_main
+********************************************************************************
+*
+* Summary:
+*  Link thread. Every byte read from the master is shifted through the
+*  emulated FIFOs under the interrupt lock, taking the SPI interrupt as
+*  the SCB would, and the bytes shifted out are written back, so the
+*  master receives exactly one byte for each byte it sends.
+*
+*******************************************************************************/
+static void *link_main(void *arg)
+{
+    uint8_t in[HOST_CHUNK_SIZE];
+    uint8_t out[HOST_CHUNK_SIZE];
+    ssize_t length;
+    ssize_t index;
+
+    (void) arg;
+
+    for (;;)
+    {
+        if (link_fd < 0)
+        {
+            link_fd = accept(listen_fd, NULL, NULL);
+            continue;
+        }
+
+        length = read(link_fd, in, sizeof(in));
+        if (length <= 0)
+        {
+            if (listen_fd >= 0)
+            {
+                (void) close(link_fd);
+                link_fd = -1;
+            }
+            else
+            {
+                /* The pty has no master connected */
+                (void) usleep(10000u);
+            }
+            continue;
+        }
+
+        (void) Cy_SysLib_EnterCriticalSection();
+        for (index = 0; index < length; index++)
+        {
+            out[index] = shift_byte(in[index]);
+
+            if (rx_irq_pending())
+            {
+                host_irq_run(host_isr);
+            }
+        }
+        Cy_SysLib_ExitCriticalSection(0UL);
+
+        if ((!write_all(link_fd, out, (size_t)length)) && (listen_fd >= 0))
+        {
+            (void) close(link_fd);
+            link_fd = -1;
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: transport_init
+********************************************************************************
+*
+* Summary:
+*  Opens the socket, or the pty, and keeps the interrupt service routine.
+*  The master can connect once transport_enable() has been called.
+*
+* Parameters:
+*  (transport_isr_t) isr - Interrupt service routine
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t transport_init(transport_isr_t isr)
+{
+    char const *path = getenv("SPI_SLAVE_SOCKET");
+
+    host_isr = isr;
+
+    if (NULL != getenv("SPI_SLAVE_PTY"))
+    {
+        link_fd = open_pty();
+        return (link_fd < 0) ? INIT_FAILURE : INIT_SUCCESS;
+    }
+
+    listen_fd = open_socket((NULL != path) ? path : HOST_SOCKET_PATH);
+
+    return (listen_fd < 0) ? INIT_FAILURE : INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: transport_enable
+********************************************************************************
+*
+* Summary:
+*  Starts the link thread.
+*
+*******************************************************************************/
+void transport_enable(void)
+{
+    CY_ASSERT(0 == pthread_create(&link_thread, NULL, &link_main, NULL));
+}
+
+/*******************************************************************************
+* Function Name: transport_fifo_size
+********************************************************************************
+*
+* Summary:
+*  Returns the depth of each FIFO in bytes.
+*
+*******************************************************************************/
+uint32_t transport_fifo_size(void)
+{
+    return HOST_FIFO_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: transport_rx_count
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes in the RX FIFO.
+*
+*******************************************************************************/
+uint32_t transport_rx_count(void)
+{
+    return rx_count;
+}
+
+/*******************************************************************************
+* Function Name: transport_read
+********************************************************************************
+*
+* Summary:
+*  Reads a byte from the RX FIFO, which must not be empty.
+*
+*******************************************************************************/
+uint8_t transport_read(void)
+{
+    uint8_t byte = rx_fifo[rx_head];
+
+    rx_head = (rx_head + 1u) % HOST_FIFO_SIZE;
+    rx_count--;
+
+    return byte;
+}
+
+/*******************************************************************************
+* Function Name: transport_clear_rx_status
+********************************************************************************
+*
+* Summary:
+*  Returns true if the RX FIFO overflowed since the previous call.
+*
+*******************************************************************************/
+bool transport_clear_rx_status(void)
+{
+    bool overflow = rx_overflow;
+
+    rx_overflow = false;
+
+    return overflow;
+}
+
+/*******************************************************************************
+* Function Name: transport_set_rx_interrupt
+********************************************************************************
+*
+* Summary:
+*  Enables or disables the RX interrupt, with the same levels as the SCB
+*  backend.
+*
+*******************************************************************************/
+void transport_set_rx_interrupt(bool enable, uint32_t level)
+{
+    rx_irq_enabled = enable;
+    rx_irq_level = level;
+}
+
+/*******************************************************************************
+* Function Name: transport_tx_count
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes in the TX FIFO.
+*
+*******************************************************************************/
+uint32_t transport_tx_count(void)
+{
+    return tx_count;
+}
+
+/*******************************************************************************
+* Function Name: transport_write
+********************************************************************************
+*
+* Summary:
+*  Writes a byte to the TX FIFO, which must not be full.
+*
+*******************************************************************************/
+void transport_write(uint8_t byte)
+{
+    tx_fifo[(tx_head + tx_count) % HOST_FIFO_SIZE] = byte;
+    tx_count++;
+}
+
+/*******************************************************************************
+* Function Name: transport_write_array
+********************************************************************************
+*
+* Summary:
+*  Writes as many bytes of a buffer as fit in the TX FIFO.
+*
+*******************************************************************************/
+void transport_write_array(uint8_t const *data, uint32_t length)
+{
+    while ((0UL != length) && (tx_count < HOST_FIFO_SIZE))
+    {
+        transport_write(*data++);
+        length--;
+    }
+}
+
+/*******************************************************************************
+* Function Name: transport_clear_tx
+********************************************************************************
+*
+* Summary:
+*  Empties the TX FIFO.
+*
+*******************************************************************************/
+void transport_clear_tx(void)
+{
+    tx_count = 0u;
+}
+
+/*******************************************************************************
+* Function Name: transport_drive_miso
+********************************************************************************
+*
+* Summary:
+*  A released MISO reads as HOST_IDLE_BYTE on the master side.
+*
+*******************************************************************************/
+void transport_drive_miso(bool drive)
+{
+    miso_driven = drive;
+}
+
+/*******************************************************************************
+* Function Name: transport_pend_interrupt
+********************************************************************************
+*
+* Summary:
+*  Runs the interrupt service routine. The caller is an emulated interrupt
+*  and holds the interrupt lock.
+*
+*******************************************************************************/
+void transport_pend_interrupt(void)
+{
+    host_irq_run(host_isr);
+}
+
+/*******************************************************************************
+* Function Name: transport_transfer
+********************************************************************************
+*
+* Summary:
+*  Starts a transfer of a fixed number of bytes, exchanged by the link
+*  thread.
+*
+*******************************************************************************/
+bool transport_transfer(uint8_t const *tx, uint8_t *rx, uint32_t size)
+{
+    (void) Cy_SysLib_EnterCriticalSection();
+    transfer_tx = tx;
+    transfer_rx = rx;
+    transfer_size = size;
+    transfer_count = 0UL;
+    transfer_active = (0UL != size);
+    Cy_SysLib_ExitCriticalSection(0UL);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: transport_transfer_active
+********************************************************************************
+*
+* Summary:
+*  Returns true while the transfer started last is in progress.
+*
+*******************************************************************************/
+bool transport_transfer_active(void)
+{
+    return transfer_active;
+}
+
+/*******************************************************************************
+* Function Name: transport_service
+********************************************************************************
+*
+* Summary:
+*  Transfers are completed by the link thread; nothing to do.
+*
+*******************************************************************************/
+void transport_service(void)
+{
+}
+#endif
+
+/* [] END OF FILE */
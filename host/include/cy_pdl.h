@@ -0,0 +1,147 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Subset of the PDL used by the SPI slave, emulated on a
+*              Linux host for the host build.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_CY_PDL_H_
+#define HOST_CY_PDL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define CY_RSLT_SUCCESS         (0UL)
+#define CY_ASSERT(x)            do { if (!(x)) { abort(); } } while (0)
+#define CY_ALIGN(align)         __attribute__((aligned(align)))
+#define CY_ARRAY_SIZE(x)        (sizeof(x) / sizeof((x)[0]))
+
+/* Flash geometry of the smallest PMG1 device, for sizes in macros only;
+ * the host build has no flash */
+#define CY_FLASH_BASE           (0x00000000UL)
+#define CY_FLASH_SIZE           (0x00010000UL)
+#define CY_FLASH_SIZEOF_ROW     (128UL)
+
+/* SysTick and the SCB registers read by the system timer */
+#define SCB_ICSR_PENDSTSET_Msk  (1UL << 26u)
+#define SCB_ICSR_PENDSTCLR_Msk  (1UL << 25u)
+#define SCB                     (host_scb())
+#define SysTick_IRQn            (-1)
+
+/* GPIO drive modes */
+#define CY_GPIO_DM_HIGHZ        (1UL)
+#define CY_GPIO_DM_STRONG_IN_OFF (6UL)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef uint32_t cy_rslt_t;
+typedef int32_t IRQn_Type;
+
+typedef enum
+{
+    CY_FLASH_DRV_SUCCESS = 0,
+    CY_FLASH_DRV_INV_PROT = 1,
+    CY_FLASH_DRV_INVALID_INPUT_PARAMETERS = 2
+} cy_en_flashdrv_status_t;
+
+typedef enum
+{
+    CY_SYSTICK_CLOCK_SOURCE_CLK_CPU = 0
+} cy_en_systick_clock_source_t;
+
+typedef void (*Cy_SysTick_Callback)(void);
+
+typedef enum
+{
+    CY_SYSPM_SUCCESS = 0
+} cy_en_syspm_status_t;
+
+typedef struct
+{
+    volatile uint32_t ICSR;
+} SCB_Type;
+
+typedef struct
+{
+    uint32_t out;                       /* Output register */
+} GPIO_PRT_Type;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern uint32_t SystemCoreClock;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+
+/* Interrupts: every emulated interrupt runs in a thread of its own, under
+ * the lock taken by Cy_SysLib_EnterCriticalSection() */
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t);
+void __enable_irq(void);
+void NVIC_SetPriority(IRQn_Type, uint32_t);
+void NVIC_SystemReset(void);
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void);
+void SystemCoreClockUpdate(void);
+
+/* SysTick, counting down at SystemCoreClock in real time */
+void Cy_SysTick_Init(cy_en_systick_clock_source_t, uint32_t);
+Cy_SysTick_Callback Cy_SysTick_SetCallback(uint32_t, Cy_SysTick_Callback);
+void Cy_SysTick_Enable(void);
+uint32_t Cy_SysTick_GetValue(void);
+uint32_t Cy_SysTick_GetReload(void);
+void Cy_SysTick_SetReload(uint32_t);
+void Cy_SysTick_Clear(void);
+SCB_Type *host_scb(void);
+
+/* Flash: writes are refused, there is no flash on the host */
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t, const uint32_t *);
+
+/* GPIO outputs */
+void Cy_GPIO_Set(GPIO_PRT_Type *, uint32_t);
+void Cy_GPIO_Clr(GPIO_PRT_Type *, uint32_t);
+
+/* Host emulation: runs an interrupt service routine as an interrupt
+ * would, and wakes a CPU sleeping in Cy_SysPm_CpuEnterSleep(). The caller
+ * holds the interrupt lock. */
+void host_irq_run(void (*)(void));
+
+#endif
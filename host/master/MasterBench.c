@@ -0,0 +1,361 @@
+/******************************************************************************
+* File Name: MasterBench.c
+*
+* Description: This file contains a tool that runs the on-target benchmark of
+*              the slave and prints the cycles per frame of each hot path.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "SpiMaster.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Benchmark command and reply layout, as in Benchmark.h */
+#define BENCH_CMD               (0x90u)
+#define BENCH_HEADER_SIZE       (6u)
+#define BENCH_RUNS              (16u)
+#define BENCH_PATHS_PER_REPLY   ((SPIM_FRAME_MAX_SIZE - BENCH_HEADER_SIZE) / 4u)
+
+/* First path of the encryption, whose cycles are also given per byte */
+#define BENCH_CRYPT_PATH        (7u)
+
+/* Echo request of the largest size, as in Command.h */
+#define BENCH_ECHO_CMD          (0x10u)
+#define BENCH_ECHO_HEADER_SIZE  (9u)
+#define BENCH_ECHO_SIZE         (SPIM_FRAME_MAX_SIZE - BENCH_ECHO_HEADER_SIZE + 1u)
+
+/* The benchmark runs far longer than an ordinary command */
+#define BENCH_TIMEOUT_MS        (1000u)
+
+/* SPI clock used with spidev */
+#define BENCH_SPEED_HZ          (1000000u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Names of the paths, in reply order */
+static char const *const bench_paths[] =
+{
+    "rx_ring_put", "rx_parse", "dispatch", "tx_encode", "crc32", "isr_min", "isr_max",
+    "crypt_xor", "keystream"
+};
+
+/* Echo replies received in the throughput test */
+static uint32_t echo_replies;
+static uint32_t echo_failures;
+
+/*******************************************************************************
+* Function Name: get_u32
+********************************************************************************
+*
+* Summary:
+*  Reads a 32-bit little-endian value.
+*
+*******************************************************************************/
+static uint32_t get_u32(uint8_t const *source)
+{
+    return (uint32_t) source[0] | ((uint32_t) source[1] << 8u) |
+           ((uint32_t) source[2] << 16u) | ((uint32_t) source[3] << 24u);
+}
+
+/*******************************************************************************
+* Function Name: path_name
+********************************************************************************
+*
+* Summary:
+*  Returns the name of a path, or "path" for one this program does not know.
+*
+*******************************************************************************/
+static char const *path_name(uint32_t path)
+{
+    return (path < (sizeof(bench_paths) / sizeof(bench_paths[0]))) ? bench_paths[path] : "path";
+}
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+*
+* Summary:
+*  Returns the monotonic time in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+/*******************************************************************************
+* Function Name: echo_complete
+********************************************************************************
+*
+* Summary:
+*  Reply callback of the throughput test.
+*
+*******************************************************************************/
+static void echo_complete(void *context, int result, uint8_t const *reply, uint32_t length)
+{
+    if ((result == SPIM_OK) && (length == SPIM_FRAME_MAX_SIZE))
+    {
+        echo_replies++;
+    }
+    else
+    {
+        echo_failures++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: run_paths
+********************************************************************************
+*
+* Summary:
+*  Reads the cycles of every path, as many per request as fit in a reply,
+*  and prints one "path,cycles,microseconds" line per path, and per byte
+*  for the encryption paths, which process SPIM_FRAME_MAX_SIZE bytes.
+*
+*******************************************************************************/
+static int run_paths(spim_t *master, uint8_t runs)
+{
+    uint8_t request[3] = { BENCH_CMD, runs, 0u };
+    uint8_t reply[SPIM_FRAME_MAX_SIZE];
+    uint32_t reply_length;
+    uint32_t clock_hz = 0u;
+    uint32_t cycles;
+    uint32_t path;
+    uint32_t index;
+    int result;
+
+    do
+    {
+        result = spim_call(master, request, sizeof(request), reply, sizeof(reply), &reply_length);
+        if ((result == SPIM_REJECTED) && (request[2] > 0u))
+        {
+            /* The path count is a multiple of the paths per reply */
+            break;
+        }
+        if ((result != SPIM_OK) || (reply_length < BENCH_HEADER_SIZE) ||
+            (reply_length < (BENCH_HEADER_SIZE + (4u * (uint32_t) reply[1]))))
+        {
+            fprintf(stderr, "No benchmark reply (%d); is the slave built with BENCHMARK=1u?\n", result);
+            return EXIT_FAILURE;
+        }
+
+        if (request[2] == 0u)
+        {
+            clock_hz = get_u32(&reply[2]);
+            printf("clock_hz,%u\n", clock_hz);
+        }
+        for (index = 0u; index < reply[1]; index++)
+        {
+            path = request[2] + index;
+            cycles = get_u32(&reply[BENCH_HEADER_SIZE + (4u * index)]);
+            printf("%s,%u,%.2f\n", path_name(path), cycles,
+                   (clock_hz > 0u) ? ((double) cycles * 1e6 / (double) clock_hz) : 0.0);
+            if (path >= BENCH_CRYPT_PATH)
+            {
+                printf("%s_per_byte,%.2f,%.4f\n", path_name(path),
+                       (double) cycles / SPIM_FRAME_MAX_SIZE,
+                       (clock_hz > 0u) ? ((double) cycles * 1e6 / (double) clock_hz / SPIM_FRAME_MAX_SIZE) : 0.0);
+            }
+        }
+        request[2] = (uint8_t)(request[2] + reply[1]);
+    } while (reply[1] == BENCH_PATHS_PER_REPLY);
+
+    return EXIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: run_throughput
+********************************************************************************
+*
+* Summary:
+*  Keeps the link busy with pipelined echo requests of the largest size
+*  and prints the sustained rates: frames, payload bytes each way, bytes
+*  clocked and the share of them carrying frames, and with spidev the
+*  line rate of the SPI clock.
+*
+*******************************************************************************/
+static int run_throughput(spim_t *master, double seconds)
+{
+    uint8_t request[BENCH_ECHO_SIZE];
+    spim_stats_t before;
+    spim_stats_t after;
+    double start;
+    double elapsed;
+    uint32_t index;
+    int result;
+
+    request[0] = BENCH_ECHO_CMD;
+    for (index = 1u; index < BENCH_ECHO_SIZE; index++)
+    {
+        request[index] = (uint8_t) index;
+    }
+
+    spim_get_stats(master, &before);
+    start = now_s();
+    do
+    {
+        result = spim_submit(master, request, sizeof(request), echo_complete, NULL);
+        if (result == SPIM_BUSY)
+        {
+            result = (spim_poll(master) < 0) ? SPIM_ERROR : SPIM_OK;
+        }
+        if (result != SPIM_OK)
+        {
+            fprintf(stderr, "Link failure\n");
+            return EXIT_FAILURE;
+        }
+    } while ((now_s() - start) < seconds);
+    if (spim_flush(master) != SPIM_OK)
+    {
+        return EXIT_FAILURE;
+    }
+    elapsed = now_s() - start;
+    spim_get_stats(master, &after);
+
+    printf("frames_per_s,%.1f\n", (double) echo_replies / elapsed);
+    printf("payload_bytes_per_s,%.1f\n",
+           (double) echo_replies * (BENCH_ECHO_SIZE - 1u) / elapsed);
+    printf("clocked_bytes_per_s,%.1f\n", (double) (after.bytes_clocked - before.bytes_clocked) / elapsed);
+    printf("useful_share,%.3f\n", (double) (after.bytes_useful - before.bytes_useful) /
+           (double) (after.bytes_clocked - before.bytes_clocked));
+    if (master->speed_hz > 0u)
+    {
+        printf("line_bytes_per_s,%.1f\n", (double) master->speed_hz / 8.0);
+    }
+    printf("failures,%u\n", echo_failures);
+
+    return (echo_failures == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+*
+* Summary:
+*  Runs the benchmark command and prints one "path,cycles,microseconds" line
+*  per path, for the benchmark script to collect. With -t, measures the
+*  sustained echo throughput instead. With -k, the link is encrypted first.
+*
+* Parameters:
+*  -k key - Key of a slave built with SPI_CRYPT, 64 hexadecimal digits
+*  -t seconds - Throughput test duration
+*  argv[1] - Device or socket path (default /tmp/spi-slave.sock)
+*  argv[2] - Runs of each path, of which the fastest is reported
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static spim_t master;
+    char const *path = "/tmp/spi-slave.sock";
+    uint8_t key[CHACHA_KEY_SIZE];
+    bool crypt = false;
+    double seconds = 0.0;
+    uint8_t runs = BENCH_RUNS;
+    int option;
+    int result;
+
+    while ((option = getopt(argc, argv, "k:t:")) != -1)
+    {
+        switch (option)
+        {
+            case 'k':
+                crypt = spim_parse_key(optarg, key);
+                if (!crypt)
+                {
+                    fprintf(stderr, "The key must be 64 hexadecimal digits\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case 't':
+                seconds = strtod(optarg, NULL);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-k key] [-t seconds] [path] [runs]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc)
+    {
+        path = argv[optind];
+    }
+    if ((optind + 1) < argc)
+    {
+        runs = (uint8_t) strtoul(argv[optind + 1], NULL, 0);
+    }
+
+    if (0 == strncmp(path, "/dev/spidev", 11))
+    {
+        result = spim_open_spidev(&master, path, BENCH_SPEED_HZ, 0u);
+    }
+    else
+    {
+        result = spim_open_socket(&master, path);
+    }
+    if (result != SPIM_OK)
+    {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    spim_set_timeout(&master, BENCH_TIMEOUT_MS);
+    if (crypt && (spim_start_crypt(&master, key) != SPIM_OK))
+    {
+        fprintf(stderr, "No encrypted session; is the slave built with SPI_CRYPT=1u and this key?\n");
+        spim_close(&master);
+        return EXIT_FAILURE;
+    }
+
+    result = (seconds > 0.0) ? run_throughput(&master, seconds) : run_paths(&master, runs);
+    spim_close(&master);
+
+    return result;
+}
+
+/* [] END OF FILE */
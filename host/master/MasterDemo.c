@@ -0,0 +1,323 @@
+/******************************************************************************
+* File Name: MasterDemo.c
+*
+* Description: This file contains a demo of the master client library: echo
+*              requests sent stop-and-wait and then pipelined, with the round
+*              trip rate and link use of each.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "SpiMaster.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Requests sent in each mode, unless given on the command line */
+#define DEMO_REQUESTS           (1000u)
+
+/* Echo request: opcode and payload. The reply carries the opcode, two
+ * timestamps and the payload. */
+#define DEMO_CMD_ECHO           (0x10u)
+#define DEMO_ECHO_HEADER_SIZE   (9u)
+#define DEMO_PAYLOAD_SIZE       (8u)
+
+/* SPI clock used with spidev */
+#define DEMO_SPEED_HZ           (1000000u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+typedef struct
+{
+    uint8_t request[1u + DEMO_PAYLOAD_SIZE];
+    int result;
+    bool matched;
+} demo_echo_t;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static double now_s(void);
+static void build_echo(demo_echo_t *, uint32_t);
+static bool check_echo(uint8_t const *, uint8_t const *, uint32_t);
+static void echo_complete(void *, int, uint8_t const *, uint32_t);
+static void report(char const *, spim_t *, spim_stats_t const *, double, uint32_t, uint32_t);
+
+/*******************************************************************************
+* Function Name: now_s
+********************************************************************************
+*
+* Summary:
+*  Returns the monotonic time in seconds.
+*
+*******************************************************************************/
+static double now_s(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ((double) ts.tv_nsec * 1e-9);
+}
+
+/*******************************************************************************
+* Function Name: build_echo
+********************************************************************************
+*
+* Summary:
+*  Fills an echo request with a payload derived from its index.
+*
+*******************************************************************************/
+static void build_echo(demo_echo_t *echo, uint32_t index)
+{
+    uint32_t byte;
+
+    echo->request[0] = DEMO_CMD_ECHO;
+    for (byte = 0u; byte < DEMO_PAYLOAD_SIZE; byte++)
+    {
+        echo->request[1u + byte] = (uint8_t)(index >> (byte * 3u)) ^ (uint8_t) byte;
+    }
+    echo->result = SPIM_ERROR;
+    echo->matched = false;
+}
+
+/*******************************************************************************
+* Function Name: check_echo
+********************************************************************************
+*
+* Summary:
+*  Checks that the reply carries the payload of the request.
+*
+*******************************************************************************/
+static bool check_echo(uint8_t const *request, uint8_t const *reply, uint32_t length)
+{
+    return (length == (DEMO_ECHO_HEADER_SIZE + DEMO_PAYLOAD_SIZE)) &&
+           (0 == memcmp(&reply[DEMO_ECHO_HEADER_SIZE], &request[1], DEMO_PAYLOAD_SIZE));
+}
+
+/*******************************************************************************
+* Function Name: echo_complete
+********************************************************************************
+*
+* Summary:
+*  Reply callback of the pipelined requests.
+*
+*******************************************************************************/
+static void echo_complete(void *context, int result, uint8_t const *reply, uint32_t length)
+{
+    demo_echo_t *echo = (demo_echo_t *) context;
+
+    echo->result = result;
+    echo->matched = (result == SPIM_OK) && check_echo(echo->request, reply, length);
+}
+
+/*******************************************************************************
+* Function Name: report
+********************************************************************************
+*
+* Summary:
+*  Prints the results of one mode, from the statistics taken before it ran.
+*
+*******************************************************************************/
+static void report(char const *mode, spim_t *master, spim_stats_t const *before,
+                   double seconds, uint32_t count, uint32_t matched)
+{
+    spim_stats_t after;
+    uint64_t clocked;
+    uint64_t useful;
+
+    spim_get_stats(master, &after);
+    clocked = after.bytes_clocked - before->bytes_clocked;
+    useful = after.bytes_useful - before->bytes_useful;
+
+    printf("%-14s %u/%u replies matched, %.3f s, %.0f round trips/s, "
+           "%llu bytes clocked, %.1f%% carrying requests, %u timeouts\n",
+           mode, matched, count, seconds, (double) count / seconds,
+           (unsigned long long) clocked,
+           (clocked > 0u) ? (100.0 * (double) useful / (double) clocked) : 0.0,
+           after.timeouts - before->timeouts);
+}
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+*
+* Summary:
+*  Connects to the slave, a spidev device when the path starts with
+*  /dev/spidev and the socket of the host build otherwise, and runs the
+*  same echo requests stop-and-wait and pipelined. With -k, the link is
+*  encrypted first.
+*
+* Parameters:
+*  -k key - Key of a slave built with SPI_CRYPT, 64 hexadecimal digits
+*  argv[1] - Device or socket path (default /tmp/spi-slave.sock)
+*  argv[2] - Number of requests per mode
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static spim_t master;
+    static spim_request_t requests[DEMO_REQUESTS];
+    static demo_echo_t echoes[DEMO_REQUESTS];
+    char const *path = "/tmp/spi-slave.sock";
+    uint32_t count = DEMO_REQUESTS;
+    uint8_t key[CHACHA_KEY_SIZE];
+    bool crypt = false;
+    uint8_t reply[SPIM_FRAME_MAX_SIZE];
+    uint32_t reply_length;
+    spim_stats_t before;
+    uint32_t matched = 0u;
+    uint32_t index;
+    double start;
+    int option;
+    int result;
+
+    while ((option = getopt(argc, argv, "k:")) != -1)
+    {
+        switch (option)
+        {
+            case 'k':
+                crypt = spim_parse_key(optarg, key);
+                if (!crypt)
+                {
+                    fprintf(stderr, "The key must be 64 hexadecimal digits\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-k key] [path] [count]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc)
+    {
+        path = argv[optind];
+    }
+    if ((optind + 1) < argc)
+    {
+        count = (uint32_t) strtoul(argv[optind + 1], NULL, 0);
+    }
+
+    if ((count == 0u) || (count > DEMO_REQUESTS))
+    {
+        count = DEMO_REQUESTS;
+    }
+
+    if (0 == strncmp(path, "/dev/spidev", 11))
+    {
+        result = spim_open_spidev(&master, path, DEMO_SPEED_HZ, 0u);
+    }
+    else
+    {
+        result = spim_open_socket(&master, path);
+    }
+    if (result != SPIM_OK)
+    {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (crypt && (spim_start_crypt(&master, key) != SPIM_OK))
+    {
+        fprintf(stderr, "No encrypted session; is the slave built with SPI_CRYPT=1u and this key?\n");
+        spim_close(&master);
+        return EXIT_FAILURE;
+    }
+
+    /* Stop-and-wait: one request on the link at a time */
+    spim_get_stats(&master, &before);
+    start = now_s();
+    for (index = 0u; index < count; index++)
+    {
+        build_echo(&echoes[index], index);
+        result = spim_call(&master, echoes[index].request, sizeof(echoes[index].request),
+                           reply, sizeof(reply), &reply_length);
+        if ((result == SPIM_OK) && check_echo(echoes[index].request, reply, reply_length))
+        {
+            matched++;
+        }
+        else if (result == SPIM_ERROR)
+        {
+            fprintf(stderr, "Link failure\n");
+            return EXIT_FAILURE;
+        }
+        else if ((result == SPIM_TIMEOUT) && (!crypt) && (matched == 0u) && (index == 0u))
+        {
+            /* A slave built with SPI_CRYPT drops frames in clear */
+            fprintf(stderr, "No reply; if the slave is built with SPI_CRYPT=1u, give its key with -k\n");
+        }
+        else
+        {
+            /* Counted as not matched */
+        }
+    }
+    report("stop-and-wait", &master, &before, now_s() - start, count, matched);
+
+    /* Pipelined: the window is kept full */
+    for (index = 0u; index < count; index++)
+    {
+        build_echo(&echoes[index], index + count);
+        requests[index].data = echoes[index].request;
+        requests[index].length = sizeof(echoes[index].request);
+        requests[index].callback = echo_complete;
+        requests[index].context = &echoes[index];
+    }
+    spim_get_stats(&master, &before);
+    start = now_s();
+    if (spim_batch(&master, requests, count) != SPIM_OK)
+    {
+        fprintf(stderr, "Link failure\n");
+        return EXIT_FAILURE;
+    }
+    matched = 0u;
+    for (index = 0u; index < count; index++)
+    {
+        matched += echoes[index].matched ? 1u : 0u;
+    }
+    report("pipelined", &master, &before, now_s() - start, count, matched);
+
+    spim_close(&master);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,1389 @@
+/******************************************************************************
+* File Name: SpiMaster.c
+*
+* Description: This file contains the master-side client library for Linux
+*              hosts: fixed packets with PACKET_SOP/PACKET_EOP markers, COBS
+*              command frames with pipelining, and the spidev and socket
+*              backends.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/spi/spidev.h>
+#include "SpiMaster.h"
+#include "Kernels.h"
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void init_state(spim_t *, uint32_t, int);
+static uint64_t now_ms(void);
+static bool write_all(int, uint8_t const *, uint32_t);
+static bool read_all(int, uint8_t *, uint32_t);
+static void receive_byte(spim_t *, uint8_t);
+static uint8_t *open_frame(spim_t *, uint8_t *, uint32_t *);
+static void dispatch_frame(spim_t *, uint8_t const *, uint32_t);
+static void expire_requests(spim_t *);
+static void call_complete(void *, int, uint8_t const *, uint32_t);
+static void cancel_requests(spim_t *, void *);
+static void fragment_complete(void *, int, uint8_t const *, uint32_t);
+
+/* Progress of spim_send_message() */
+typedef struct
+{
+    uint8_t type;
+    uint8_t id;
+    uint32_t count;
+    uint32_t crc;
+    bool acked[SPIM_FRAGMENT_MAX_COUNT];
+    bool in_flight[SPIM_FRAGMENT_MAX_COUNT];
+    uint8_t tries[SPIM_FRAGMENT_MAX_COUNT];
+    bool done;
+    int result;
+} message_state_t;
+
+/* Reply context of one fragment */
+typedef struct
+{
+    message_state_t *message;
+    uint32_t index;
+} fragment_context_t;
+
+/* Reply storage of spim_call() */
+typedef struct
+{
+    bool done;
+    int result;
+    uint8_t *reply;
+    uint32_t size;
+    uint32_t *length;
+} call_state_t;
+
+/*******************************************************************************
+* Function Name: init_state
+********************************************************************************
+*
+* Summary:
+*  Clears the connection state and attaches the backend descriptor.
+*
+*******************************************************************************/
+static void init_state(spim_t *master, uint32_t backend, int fd)
+{
+    memset(master, 0, sizeof(*master));
+    master->backend = backend;
+    master->fd = fd;
+    master->gap_us = SPIM_PACKET_GAP_US;
+    master->timeout_ms = SPIM_TIMEOUT_MS;
+    /* A restarted master does not resume the identifiers of the last run */
+    (void) getrandom(&master->message_id, sizeof(master->message_id), 0u);
+    cobs_decoder_init(&master->decoder, master->frame, sizeof(master->frame));
+}
+
+/*******************************************************************************
+* Function Name: now_ms
+********************************************************************************
+*
+* Summary:
+*  Returns the monotonic time in milliseconds.
+*
+*******************************************************************************/
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000u) + ((uint64_t) ts.tv_nsec / 1000000u);
+}
+
+/*******************************************************************************
+* Function Name: write_all
+********************************************************************************
+*
+* Summary:
+*  Writes a whole buffer to the socket or pty.
+*
+*******************************************************************************/
+static bool write_all(int fd, uint8_t const *data, uint32_t size)
+{
+    while (size > 0u)
+    {
+        ssize_t count = write(fd, data, size);
+
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += count;
+        size -= (uint32_t) count;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: read_all
+********************************************************************************
+*
+* Summary:
+*  Reads exactly the given number of bytes from the socket or pty.
+*
+*******************************************************************************/
+static bool read_all(int fd, uint8_t *data, uint32_t size)
+{
+    while (size > 0u)
+    {
+        ssize_t count = read(fd, data, size);
+
+        if (count <= 0)
+        {
+            if ((count < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return false;
+        }
+        data += count;
+        size -= (uint32_t) count;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: spim_open_spidev
+********************************************************************************
+*
+* Summary:
+*  Opens a spidev device and configures the SPI mode, word size and clock.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (char const *) device - Device path, for example /dev/spidev0.0
+*  - (uint32_t) speed_hz - SPI clock frequency
+*  - (uint8_t) mode - SPI mode, SPI_MODE_0 to SPI_MODE_3
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR if the device cannot be opened or configured
+*
+*******************************************************************************/
+int spim_open_spidev(spim_t *master, char const *device, uint32_t speed_hz, uint8_t mode)
+{
+    uint8_t bits = 8u;
+    int fd = open(device, O_RDWR);
+
+    if (fd < 0)
+    {
+        return SPIM_ERROR;
+    }
+
+    if ((ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+        (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+        (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0))
+    {
+        (void) close(fd);
+        return SPIM_ERROR;
+    }
+
+    init_state(master, SPIM_BACKEND_SPIDEV, fd);
+    master->speed_hz = speed_hz;
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: spim_open_socket
+********************************************************************************
+*
+* Summary:
+*  Connects to the Unix domain socket of the host build of the slave. Every
+*  byte written is answered by one byte, as on the SPI bus.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (char const *) path - Socket path
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR if the connection fails
+*
+*******************************************************************************/
+int spim_open_socket(spim_t *master, char const *path)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return SPIM_ERROR;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return SPIM_ERROR;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) < 0)
+    {
+        (void) close(fd);
+        return SPIM_ERROR;
+    }
+
+    init_state(master, SPIM_BACKEND_SOCKET, fd);
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: spim_open_pty
+********************************************************************************
+*
+* Summary:
+*  Opens the pty of the host build of the slave in raw mode. The exchange
+*  is the same as over the socket.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (char const *) path - Pty path printed by the slave
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR if the pty cannot be opened
+*
+*******************************************************************************/
+int spim_open_pty(spim_t *master, char const *path)
+{
+    struct termios settings;
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        return SPIM_ERROR;
+    }
+
+    if (tcgetattr(fd, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        (void) tcsetattr(fd, TCSANOW, &settings);
+    }
+
+    init_state(master, SPIM_BACKEND_SOCKET, fd);
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: spim_close
+********************************************************************************
+*
+* Summary:
+*  Closes the backend. Requests still waiting are not completed.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spim_close(spim_t *master)
+{
+    if (master->fd >= 0)
+    {
+        (void) close(master->fd);
+        master->fd = -1;
+    }
+}
+
+/*******************************************************************************
+* Function Name: spim_set_timeout
+********************************************************************************
+*
+* Summary:
+*  Sets how long a request waits for its reply.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint32_t) timeout_ms - Reply timeout in milliseconds
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spim_set_timeout(spim_t *master, uint32_t timeout_ms)
+{
+    master->timeout_ms = timeout_ms;
+}
+
+/*******************************************************************************
+* Function Name: spim_set_packet_gap
+********************************************************************************
+*
+* Summary:
+*  Sets the idle time left between fixed packets, which the slave needs to
+*  process a packet and re-arm the next transfer.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint16_t) gap_us - Gap in microseconds
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spim_set_packet_gap(spim_t *master, uint16_t gap_us)
+{
+    master->gap_us = gap_us;
+}
+
+/*******************************************************************************
+* Function Name: spim_set_frame_callback
+********************************************************************************
+*
+* Summary:
+*  Registers the callback for frames that answer no request: debug log
+*  records, streamed data and replies that arrive after their timeout.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (spim_frame_cb_t) callback - Callback, NULL to drop such frames
+*  - (void *) context - Passed to the callback
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spim_set_frame_callback(spim_t *master, spim_frame_cb_t callback, void *context)
+{
+    master->frame_callback = callback;
+    master->frame_context = context;
+}
+
+/*******************************************************************************
+* Function Name: spim_transfer
+********************************************************************************
+*
+* Summary:
+*  Clocks one full-duplex transfer with slave select held for its length.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t const *) tx - Bytes sent
+*  - (uint8_t *) rx - Bytes received, same length
+*  - (uint32_t) size - Transfer length
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR on a backend failure
+*
+*******************************************************************************/
+int spim_transfer(spim_t *master, uint8_t const *tx, uint8_t *rx, uint32_t size)
+{
+    if (master->backend == SPIM_BACKEND_SPIDEV)
+    {
+        struct spi_ioc_transfer transfer;
+
+        memset(&transfer, 0, sizeof(transfer));
+        transfer.tx_buf = (uintptr_t) tx;
+        transfer.rx_buf = (uintptr_t) rx;
+        transfer.len = size;
+        transfer.speed_hz = master->speed_hz;
+        transfer.bits_per_word = 8u;
+        if (ioctl(master->fd, SPI_IOC_MESSAGE(1), &transfer) < 0)
+        {
+            return SPIM_ERROR;
+        }
+    }
+    else
+    {
+        if ((!write_all(master->fd, tx, size)) || (!read_all(master->fd, rx, size)))
+        {
+            return SPIM_ERROR;
+        }
+    }
+
+    master->stats.bytes_clocked += size;
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: spim_packet
+********************************************************************************
+*
+* Summary:
+*  Sends one fixed packet with the original framing. The slave answers each
+*  packet with the status of the previous command while the packet itself
+*  is being clocked in.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t) command - Command byte
+*  - (uint8_t *) status - Status returned by the slave, may be NULL
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR on a backend failure or when the reply has
+*  no valid markers (the slave was not ready)
+*
+*******************************************************************************/
+int spim_packet(spim_t *master, uint8_t command, uint8_t *status)
+{
+    return spim_packet_batch(master, &command, status, 1u);
+}
+
+/*******************************************************************************
+* Function Name: spim_packet_batch
+********************************************************************************
+*
+* Summary:
+*  Sends a series of fixed packets in one backend call. With spidev the
+*  packets go in a single SPI_IOC_MESSAGE, with slave select released and
+*  the packet gap left between them, so the kernel clocks them without a
+*  round trip through user space per packet.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t const *) commands - Command bytes
+*  - (uint8_t *) statuses - Status returned during each packet, that is
+*    the status of the command before it; may be NULL
+*  - (uint32_t) count - Number of packets, at most SPIM_BATCH_MAX
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR on a backend failure or when a reply has
+*  no valid markers
+*
+*******************************************************************************/
+int spim_packet_batch(spim_t *master, uint8_t const *commands, uint8_t *statuses, uint32_t count)
+{
+    uint8_t tx[SPIM_BATCH_MAX][SPIM_PACKET_SIZE];
+    uint8_t rx[SPIM_BATCH_MAX][SPIM_PACKET_SIZE];
+    int result = SPIM_OK;
+    uint32_t index;
+
+    if ((count == 0u) || (count > SPIM_BATCH_MAX))
+    {
+        return SPIM_ERROR;
+    }
+
+    for (index = 0u; index < count; index++)
+    {
+        tx[index][0] = SPIM_PACKET_SOP;
+        tx[index][SPIM_PACKET_CMD_POS] = commands[index];
+        tx[index][SPIM_PACKET_SIZE - 1u] = SPIM_PACKET_EOP;
+    }
+
+    if (master->backend == SPIM_BACKEND_SPIDEV)
+    {
+        struct spi_ioc_transfer transfers[SPIM_BATCH_MAX];
+
+        memset(transfers, 0, sizeof(transfers));
+        for (index = 0u; index < count; index++)
+        {
+            transfers[index].tx_buf = (uintptr_t) tx[index];
+            transfers[index].rx_buf = (uintptr_t) rx[index];
+            transfers[index].len = SPIM_PACKET_SIZE;
+            transfers[index].speed_hz = master->speed_hz;
+            transfers[index].bits_per_word = 8u;
+            transfers[index].delay_usecs = master->gap_us;
+            /* Release slave select after every packet but the last */
+            transfers[index].cs_change = (index + 1u < count) ? 1u : 0u;
+        }
+        if (ioctl(master->fd, SPI_IOC_MESSAGE(count), transfers) < 0)
+        {
+            return SPIM_ERROR;
+        }
+        master->stats.bytes_clocked += count * SPIM_PACKET_SIZE;
+    }
+    else
+    {
+        for (index = 0u; index < count; index++)
+        {
+            if (spim_transfer(master, tx[index], rx[index], SPIM_PACKET_SIZE) != SPIM_OK)
+            {
+                return SPIM_ERROR;
+            }
+            if (master->gap_us > 0u)
+            {
+                (void) usleep(master->gap_us);
+            }
+        }
+    }
+
+    for (index = 0u; index < count; index++)
+    {
+        if ((rx[index][0] != SPIM_PACKET_SOP) || (rx[index][SPIM_PACKET_SIZE - 1u] != SPIM_PACKET_EOP))
+        {
+            result = SPIM_ERROR;
+        }
+        if (NULL != statuses)
+        {
+            statuses[index] = rx[index][SPIM_PACKET_CMD_POS];
+        }
+    }
+    master->stats.bytes_useful += count * SPIM_PACKET_SIZE;
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: spim_submit
+********************************************************************************
+*
+* Summary:
+*  Queues a request frame without waiting for its reply. Up to SPIM_WINDOW
+*  requests are in flight at once; the reply is matched to the oldest
+*  request with the same opcode and passed to the callback from
+*  spim_poll(). A request submitted without a callback expects no reply
+*  and does not take a window slot. After spim_start_crypt() the request
+*  is encrypted.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t const *) request - Request frame, opcode first
+*  - (uint32_t) length - Length, 1 to SPIM_FRAME_MAX_SIZE bytes
+*  - (spim_reply_cb_t) callback - Completion callback, may be NULL
+*  - (void *) context - Passed to the callback
+*
+* Return:
+*  (int) SPIM_OK, SPIM_BUSY when the window or the TX queue is full, or
+*  SPIM_ERROR for an invalid frame
+*
+*******************************************************************************/
+int spim_submit(spim_t *master, uint8_t const *request, uint32_t length,
+                spim_reply_cb_t callback, void *context)
+{
+    uint8_t sealed[SPIM_FRAME_MAX_SIZE + SPIM_CRYPT_OVERHEAD];
+    uint8_t keystream[SPIM_FRAME_MAX_SIZE];
+    bool seal = master->crypt;
+    uint32_t slot = SPIM_WINDOW;
+    uint32_t index;
+
+    if ((length == 0u) || (length > SPIM_FRAME_MAX_SIZE))
+    {
+        return SPIM_ERROR;
+    }
+
+    if ((master->tx_length + COBS_ENCODED_MAX(length + SPIM_CRYPT_OVERHEAD) + 1u) > SPIM_TX_QUEUE_SIZE)
+    {
+        return SPIM_BUSY;
+    }
+
+    if (NULL != callback)
+    {
+        for (index = 0u; index < SPIM_WINDOW; index++)
+        {
+            if (!master->pending[index].in_use)
+            {
+                slot = index;
+                break;
+            }
+        }
+        if (slot == SPIM_WINDOW)
+        {
+            return SPIM_BUSY;
+        }
+
+        master->pending[slot].in_use = true;
+        master->pending[slot].opcode = request[0];
+        master->pending[slot].sequence = master->sequence++;
+        master->pending[slot].deadline_ms = now_ms() + master->timeout_ms;
+        master->pending[slot].callback = callback;
+        master->pending[slot].context = context;
+        master->pending_count++;
+    }
+
+    if (seal)
+    {
+        chacha_block(&master->crypt_keys[SPIM_CRYPT_TO_SLAVE], master->crypt_tx_next, keystream, length);
+        sealed[0] = SPIM_CRYPT_FRAME_ID;
+        sealed[1] = (uint8_t) master->crypt_tx_next;
+        for (index = 0u; index < length; index++)
+        {
+            sealed[SPIM_CRYPT_OVERHEAD + index] = request[index] ^ keystream[index];
+        }
+        master->crypt_tx_next++;
+        request = sealed;
+        length += SPIM_CRYPT_OVERHEAD;
+    }
+
+    master->tx_length += cobs_encode(request, length, &master->tx_queue[master->tx_length]);
+    master->tx_queue[master->tx_length++] = COBS_DELIMITER;
+    master->stats.requests++;
+
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: receive_byte
+********************************************************************************
+*
+* Summary:
+*  Feeds one byte from the slave to the frame decoder. The idle byte the
+*  slave shifts out when its TX FIFO runs empty is dropped between frames;
+*  as a COBS code it would start a frame longer than any the slave sends.
+*
+*******************************************************************************/
+static void receive_byte(spim_t *master, uint8_t byte)
+{
+    uint32_t status;
+
+    if ((!master->rx_in_frame) && (byte == SPIM_IDLE_BYTE))
+    {
+        return;
+    }
+    master->rx_in_frame = (byte != COBS_DELIMITER);
+
+    status = cobs_decode_byte(&master->decoder, byte);
+    if (status == COBS_DECODE_COMPLETE)
+    {
+        uint32_t length = master->decoder.length;
+        uint8_t *frame = master->frame;
+
+        if (master->crypt)
+        {
+            frame = open_frame(master, frame, &length);
+        }
+        if ((NULL != frame) && (length > 0u))
+        {
+            dispatch_frame(master, frame, length);
+        }
+    }
+    else if (status == COBS_DECODE_ERROR)
+    {
+        master->stats.frame_errors++;
+    }
+    else
+    {
+        /* Frame in progress */
+    }
+}
+
+/*******************************************************************************
+* Function Name: open_frame
+********************************************************************************
+*
+* Summary:
+*  Decrypts a frame of the slave in place, recovering the frame counter
+*  of its TX class from the low byte. Returns the decrypted frame, or NULL
+*  for a frame in clear, of the previous session or with a counter already
+*  used.
+*
+*******************************************************************************/
+static uint8_t *open_frame(spim_t *master, uint8_t *frame, uint32_t *length)
+{
+    uint8_t keystream[SPIM_FRAME_MAX_SIZE];
+    uint32_t tx_class = (uint8_t)((frame[0] & ~SPIM_CRYPT_SESSION_FLAG) - SPIM_CRYPT_FRAME_ID);
+    uint32_t gap;
+    uint32_t counter;
+    uint32_t index;
+
+    if ((*length <= SPIM_CRYPT_OVERHEAD) || (tx_class >= SPIM_CRYPT_CLASSES) ||
+        ((frame[0] & SPIM_CRYPT_SESSION_FLAG) != master->crypt_session))
+    {
+        master->stats.crypt_errors++;
+        return NULL;
+    }
+
+    gap = (uint8_t)(frame[1] - (uint8_t) master->crypt_rx_next[tx_class]);
+    if (gap > SPIM_CRYPT_MAX_GAP)
+    {
+        master->stats.crypt_errors++;
+        return NULL;
+    }
+
+    counter = master->crypt_rx_next[tx_class] + gap;
+    master->crypt_rx_next[tx_class] = counter + 1u;
+
+    *length -= SPIM_CRYPT_OVERHEAD;
+    chacha_block(&master->crypt_keys[SPIM_CRYPT_TO_MASTER + tx_class], counter, keystream, *length);
+    for (index = 0u; index < *length; index++)
+    {
+        frame[SPIM_CRYPT_OVERHEAD + index] ^= keystream[index];
+    }
+
+    return &frame[SPIM_CRYPT_OVERHEAD];
+}
+
+/*******************************************************************************
+* Function Name: dispatch_frame
+********************************************************************************
+*
+* Summary:
+*  Completes the oldest request waiting for the opcode of the frame, or a
+*  CMD_ERROR frame's failed opcode, and passes any other frame to the frame
+*  callback.
+*
+*******************************************************************************/
+static void dispatch_frame(spim_t *master, uint8_t const *frame, uint32_t length)
+{
+    uint8_t opcode = frame[0];
+    int result = SPIM_OK;
+    uint32_t slot = SPIM_WINDOW;
+    uint32_t index;
+
+    if ((opcode == SPIM_CMD_ERROR) && (length >= 2u))
+    {
+        opcode = frame[1];
+        result = SPIM_REJECTED;
+    }
+
+    if (opcode != SPIM_LOG_FRAME_ID)
+    {
+        for (index = 0u; index < SPIM_WINDOW; index++)
+        {
+            if (master->pending[index].in_use && (master->pending[index].opcode == opcode) &&
+                ((slot == SPIM_WINDOW) ||
+                 ((int32_t)(master->pending[index].sequence - master->pending[slot].sequence) < 0)))
+            {
+                slot = index;
+            }
+        }
+    }
+
+    if (slot < SPIM_WINDOW)
+    {
+        spim_pending_t request = master->pending[slot];
+
+        /* Free the slot first, so the callback can submit again */
+        master->pending[slot].in_use = false;
+        master->pending_count--;
+        master->stats.replies++;
+        request.callback(request.context, result, frame, length);
+    }
+    else
+    {
+        master->stats.unsolicited++;
+        if (NULL != master->frame_callback)
+        {
+            master->frame_callback(master->frame_context, frame, length);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: expire_requests
+********************************************************************************
+*
+* Summary:
+*  Completes the requests whose reply timeout has passed with SPIM_TIMEOUT.
+*
+*******************************************************************************/
+static void expire_requests(spim_t *master)
+{
+    uint64_t now = now_ms();
+    uint32_t index;
+
+    for (index = 0u; index < SPIM_WINDOW; index++)
+    {
+        if (master->pending[index].in_use && (now >= master->pending[index].deadline_ms))
+        {
+            spim_pending_t request = master->pending[index];
+
+            master->pending[index].in_use = false;
+            master->pending_count--;
+            master->stats.timeouts++;
+            request.callback(request.context, SPIM_TIMEOUT, NULL, 0u);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: spim_poll
+********************************************************************************
+*
+* Summary:
+*  Clocks one transfer of SPIM_CHUNK_SIZE bytes: queued request bytes first,
+*  padded with delimiters, which give the slave room to send its replies and
+*  any streamed frames. Received frames are dispatched and expired requests
+*  completed before returning.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*
+* Return:
+*  (int) Number of requests still waiting for a reply, or SPIM_ERROR on a
+*  backend failure
+*
+*******************************************************************************/
+int spim_poll(spim_t *master)
+{
+    uint8_t tx[SPIM_CHUNK_SIZE];
+    uint8_t rx[SPIM_CHUNK_SIZE];
+    uint32_t count = (master->tx_length < SPIM_CHUNK_SIZE) ? master->tx_length : SPIM_CHUNK_SIZE;
+    uint32_t index;
+
+    memcpy(tx, master->tx_queue, count);
+    memset(&tx[count], COBS_DELIMITER, SPIM_CHUNK_SIZE - count);
+    master->tx_length -= count;
+    memmove(master->tx_queue, &master->tx_queue[count], master->tx_length);
+
+    for (index = 0u; index < count; index++)
+    {
+        if (tx[index] != COBS_DELIMITER)
+        {
+            master->stats.bytes_useful++;
+        }
+    }
+
+    if (spim_transfer(master, tx, rx, SPIM_CHUNK_SIZE) != SPIM_OK)
+    {
+        return SPIM_ERROR;
+    }
+
+    for (index = 0u; index < SPIM_CHUNK_SIZE; index++)
+    {
+        receive_byte(master, rx[index]);
+    }
+    expire_requests(master);
+
+    return (int) master->pending_count;
+}
+
+/*******************************************************************************
+* Function Name: spim_flush
+********************************************************************************
+*
+* Summary:
+*  Polls until every queued byte is sent and every request is completed,
+*  by its reply or by its timeout.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR on a backend failure
+*
+*******************************************************************************/
+int spim_flush(spim_t *master)
+{
+    while ((master->tx_length > 0u) || (master->pending_count > 0u))
+    {
+        if (spim_poll(master) < 0)
+        {
+            return SPIM_ERROR;
+        }
+    }
+    return SPIM_OK;
+}
+
+/*******************************************************************************
+* Function Name: spim_batch
+********************************************************************************
+*
+* Summary:
+*  Sends a list of requests pipelined: the window is kept full, a new
+*  request going out as soon as a reply frees a slot, and the transfers
+*  carry request and reply bytes at the same time. Returns when every
+*  request is completed; each result is passed to its own callback.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (spim_request_t const *) requests - Requests, in order
+*  - (uint32_t) count - Number of requests
+*
+* Return:
+*  (int) SPIM_OK, or SPIM_ERROR on a backend failure or an invalid request
+*
+*******************************************************************************/
+int spim_batch(spim_t *master, spim_request_t const *requests, uint32_t count)
+{
+    uint32_t index = 0u;
+
+    while (index < count)
+    {
+        int result = spim_submit(master, requests[index].data, requests[index].length,
+                                 requests[index].callback, requests[index].context);
+
+        if (result == SPIM_OK)
+        {
+            index++;
+        }
+        else if (result == SPIM_BUSY)
+        {
+            if (spim_poll(master) < 0)
+            {
+                return SPIM_ERROR;
+            }
+        }
+        else
+        {
+            return result;
+        }
+    }
+
+    return spim_flush(master);
+}
+
+/*******************************************************************************
+* Function Name: call_complete
+********************************************************************************
+*
+* Summary:
+*  Reply callback of spim_call(), copies the reply to the caller's buffer.
+*
+*******************************************************************************/
+static void call_complete(void *context, int result, uint8_t const *reply, uint32_t length)
+{
+    call_state_t *call = (call_state_t *) context;
+
+    if (length > call->size)
+    {
+        length = call->size;
+    }
+    if (length > 0u)
+    {
+        memcpy(call->reply, reply, length);
+    }
+    if (NULL != call->length)
+    {
+        *call->length = length;
+    }
+    call->result = result;
+    call->done = true;
+}
+
+/*******************************************************************************
+* Function Name: cancel_requests
+********************************************************************************
+*
+* Summary:
+*  Drops the requests submitted with the given callback context, without
+*  completing them.
+*
+*******************************************************************************/
+static void cancel_requests(spim_t *master, void *context)
+{
+    uint32_t index;
+
+    for (index = 0u; index < SPIM_WINDOW; index++)
+    {
+        if (master->pending[index].in_use && (master->pending[index].context == context))
+        {
+            master->pending[index].in_use = false;
+            master->pending_count--;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: spim_call
+********************************************************************************
+*
+* Summary:
+*  Sends one request and waits for its reply (stop-and-wait). Requests
+*  already in flight keep being served while waiting.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t const *) request - Request frame, opcode first
+*  - (uint32_t) length - Length of the request
+*  - (uint8_t *) reply - Reply storage
+*  - (uint32_t) size - Size of the reply storage
+*  - (uint32_t *) reply_length - Length of the reply, may be NULL
+*
+* Return:
+*  (int) SPIM_OK, SPIM_REJECTED with the CMD_ERROR frame as the reply,
+*  SPIM_TIMEOUT or SPIM_ERROR
+*
+*******************************************************************************/
+int spim_call(spim_t *master, uint8_t const *request, uint32_t length,
+              uint8_t *reply, uint32_t size, uint32_t *reply_length)
+{
+    call_state_t call = { false, SPIM_ERROR, reply, size, reply_length };
+    int result;
+
+    do
+    {
+        result = spim_submit(master, request, length, call_complete, &call);
+        if ((result == SPIM_BUSY) && (spim_poll(master) < 0))
+        {
+            return SPIM_ERROR;
+        }
+    } while (result == SPIM_BUSY);
+
+    if (result != SPIM_OK)
+    {
+        return result;
+    }
+
+    while (!call.done)
+    {
+        if (spim_poll(master) < 0)
+        {
+            /* The reply storage is on this stack frame */
+            cancel_requests(master, &call);
+            return SPIM_ERROR;
+        }
+    }
+
+    return call.result;
+}
+
+/*******************************************************************************
+* Function Name: spim_start_crypt
+********************************************************************************
+*
+* Summary:
+*  Starts an encrypted session with a slave built with SPI_CRYPT. Queued
+*  requests are completed first. The session request carries a random
+*  nonce; the slave answers it already encrypted, so a reply proves that
+*  both ends hold the same key. From then on every frame in both
+*  directions is encrypted. The first request goes in clear; called again,
+*  the request is encrypted with the current session, as the slave refuses
+*  a restart in clear. Frames of the previous session still queued are
+*  dropped. After a failure, the session can only be started again once
+*  the slave is reset.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t const *) key - CHACHA_KEY_SIZE bytes, SPI_CRYPT_KEY of the slave
+*
+* Return:
+*  (int) SPIM_OK, SPIM_TIMEOUT if the slave does not answer or holds
+*  another key, or SPIM_ERROR
+*
+*******************************************************************************/
+int spim_start_crypt(spim_t *master, uint8_t const *key)
+{
+    uint8_t request[1u + SPIM_CRYPT_NONCE_SIZE];
+    uint8_t nonce[CHACHA_NONCE_SIZE] = {0u};
+    uint8_t reply[SPIM_FRAME_MAX_SIZE];
+    uint32_t reply_length = 0u;
+    call_state_t call = { false, SPIM_ERROR, reply, sizeof(reply), &reply_length };
+    uint32_t index;
+    int result;
+
+    if (spim_flush(master) != SPIM_OK)
+    {
+        return SPIM_ERROR;
+    }
+
+    request[0] = SPIM_CMD_CRYPT_START;
+    if (getrandom(&request[1], SPIM_CRYPT_NONCE_SIZE, 0u) != (ssize_t) SPIM_CRYPT_NONCE_SIZE)
+    {
+        return SPIM_ERROR;
+    }
+
+    /* In clear, or encrypted with the current session for a restart */
+    result = spim_submit(master, request, sizeof(request), call_complete, &call);
+    if (result != SPIM_OK)
+    {
+        return result;
+    }
+
+    /* The reply comes with the new session. Nonce layout of the slave:
+     * stream, then the session nonce. */
+    memcpy(&nonce[CHACHA_NONCE_SIZE - SPIM_CRYPT_NONCE_SIZE], &request[1], SPIM_CRYPT_NONCE_SIZE);
+    for (index = 0u; index < SPIM_CRYPT_STREAMS; index++)
+    {
+        nonce[0] = (uint8_t) index;
+        chacha_init(&master->crypt_keys[index], key, nonce);
+    }
+    master->crypt_tx_next = 0u;
+    memset(master->crypt_rx_next, 0, sizeof(master->crypt_rx_next));
+    master->crypt_session = master->crypt ? (uint8_t)(master->crypt_session ^ SPIM_CRYPT_SESSION_FLAG) : 0u;
+    master->crypt = true;
+
+    while (!call.done)
+    {
+        if (spim_poll(master) < 0)
+        {
+            /* The reply storage is on this stack frame */
+            cancel_requests(master, &call);
+            call.result = SPIM_ERROR;
+            break;
+        }
+    }
+
+    result = call.result;
+    if ((result == SPIM_OK) && ((reply_length != 1u) || (reply[0] != SPIM_CMD_CRYPT_START)))
+    {
+        result = SPIM_ERROR;
+    }
+    if (result != SPIM_OK)
+    {
+        master->crypt = false;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: spim_parse_key
+********************************************************************************
+*
+* Summary:
+*  Reads a key for spim_start_crypt() given as 64 hexadecimal digits, as on
+*  the command line of the example programs.
+*
+* Parameters:
+*  - (char const *) text - Hexadecimal digits
+*  - (uint8_t *) key - CHACHA_KEY_SIZE bytes
+*
+* Return:
+*  (bool) true if the text is a valid key
+*
+*******************************************************************************/
+bool spim_parse_key(char const *text, uint8_t *key)
+{
+    uint32_t index;
+    char digits[3] = { 0, 0, 0 };
+    char *end;
+
+    if (strlen(text) != (2u * CHACHA_KEY_SIZE))
+    {
+        return false;
+    }
+    for (index = 0u; index < CHACHA_KEY_SIZE; index++)
+    {
+        digits[0] = text[2u * index];
+        digits[1] = text[(2u * index) + 1u];
+        key[index] = (uint8_t) strtoul(digits, &end, 16);
+        if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: fragment_complete
+********************************************************************************
+*
+* Summary:
+*  Reply callback of a fragment. Replies are matched by opcode only, so the
+*  fragment acknowledged is taken from the reply; the fragment the callback
+*  was registered for is sent again unless it was acknowledged.
+*
+*******************************************************************************/
+static void fragment_complete(void *context, int result, uint8_t const *reply, uint32_t length)
+{
+    fragment_context_t *fragment = (fragment_context_t *) context;
+    message_state_t *message = fragment->message;
+    uint32_t index;
+
+    message->in_flight[fragment->index] = false;
+
+    if (result == SPIM_REJECTED)
+    {
+        message->result = SPIM_REJECTED;
+        message->done = true;
+        return;
+    }
+
+    if ((result != SPIM_OK) || (length < SPIM_FRAGMENT_ACK_SIZE) ||
+        (reply[1] != message->type) || (reply[2] != message->id) || (reply[3] >= message->count))
+    {
+        return;
+    }
+
+    index = reply[3];
+    message->acked[index] = true;
+
+    if ((reply[4] == SPIM_FRAGMENT_COMPLETE) || (reply[4] == SPIM_FRAGMENT_REJECTED))
+    {
+        message->done = true;
+        if ((length < SPIM_FRAGMENT_ACK_CRC_SIZE) ||
+            (((uint32_t) reply[5] | ((uint32_t) reply[6] << 8u) | ((uint32_t) reply[7] << 16u) |
+              ((uint32_t) reply[8] << 24u)) != message->crc))
+        {
+            message->result = SPIM_ERROR;
+        }
+        else
+        {
+            message->result = (reply[4] == SPIM_FRAGMENT_COMPLETE) ? SPIM_OK : SPIM_REJECTED;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: spim_send_message
+********************************************************************************
+*
+* Summary:
+*  Sends a message of any length up to SPIM_FRAGMENT_MAX_COUNT fragments to
+*  a slave built with FRAGMENT, pipelined. Every fragment is acknowledged;
+*  fragments whose ack does not come are sent again. The slave reassembles
+*  them in any order and answers the last one with the CRC-32 of the
+*  message, which is checked here.
+*
+* Parameters:
+*  - (spim_t *) master - Connection state
+*  - (uint8_t) type - Message type registered on the slave
+*  - (uint8_t const *) data - Message
+*  - (uint32_t) length - Length of the message
+*
+* Return:
+*  (int) SPIM_OK once delivered, SPIM_REJECTED if the slave refused it,
+*  SPIM_TIMEOUT if a fragment went unacknowledged SPIM_FRAGMENT_TRIES
+*  times, or SPIM_ERROR
+*
+*******************************************************************************/
+int spim_send_message(spim_t *master, uint8_t type, uint8_t const *data, uint32_t length)
+{
+    message_state_t message;
+    fragment_context_t contexts[SPIM_FRAGMENT_MAX_COUNT];
+    uint8_t request[SPIM_FRAME_MAX_SIZE];
+    uint32_t next = 0u;
+    uint32_t index;
+    uint32_t offset;
+    uint32_t size;
+    bool idle;
+    int result = SPIM_OK;
+
+    memset(&message, 0, sizeof(message));
+    message.type = type;
+    message.id = master->message_id++;
+    message.count = (length == 0u) ? 1u : ((length + SPIM_FRAGMENT_DATA_SIZE - 1u) / SPIM_FRAGMENT_DATA_SIZE);
+    message.crc = kernel_crc32(KERNEL_CRC32_INIT, data, length);
+    if (message.count > SPIM_FRAGMENT_MAX_COUNT)
+    {
+        return SPIM_ERROR;
+    }
+
+    while ((!message.done) && (result == SPIM_OK))
+    {
+        /* Next fragment neither acknowledged nor in flight, in order */
+        idle = true;
+        for (index = 0u; index < message.count; index++)
+        {
+            uint32_t candidate = (next + index) % message.count;
+
+            if ((!message.acked[candidate]) && (!message.in_flight[candidate]))
+            {
+                idle = false;
+                next = candidate;
+                break;
+            }
+        }
+
+        if (!idle)
+        {
+            if (message.tries[next] >= SPIM_FRAGMENT_TRIES)
+            {
+                result = SPIM_TIMEOUT;
+                break;
+            }
+
+            offset = next * SPIM_FRAGMENT_DATA_SIZE;
+            size = ((length - offset) < SPIM_FRAGMENT_DATA_SIZE) ? (length - offset) : SPIM_FRAGMENT_DATA_SIZE;
+            request[0] = SPIM_CMD_FRAGMENT;
+            request[1] = type;
+            request[2] = message.id;
+            request[3] = (uint8_t) next;
+            request[4] = (uint8_t) message.count;
+            if (size > 0u)
+            {
+                memcpy(&request[SPIM_FRAGMENT_HEADER_SIZE], &data[offset], size);
+            }
+            contexts[next].message = &message;
+            contexts[next].index = next;
+
+            result = spim_submit(master, request, SPIM_FRAGMENT_HEADER_SIZE + size,
+                                 fragment_complete, &contexts[next]);
+            if (result == SPIM_OK)
+            {
+                message.in_flight[next] = true;
+                message.tries[next]++;
+                next = (next + 1u) % message.count;
+                continue;
+            }
+            if (result != SPIM_BUSY)
+            {
+                break;
+            }
+            result = SPIM_OK;
+        }
+        else if (master->pending_count == 0u)
+        {
+            /* Every fragment acknowledged, yet the slave did not complete
+             * the message: it dropped the partial one, so start over */
+            for (index = 0u; index < message.count; index++)
+            {
+                message.acked[index] = false;
+            }
+            continue;
+        }
+        else
+        {
+            /* Waiting for acks */
+        }
+
+        if (spim_poll(master) < 0)
+        {
+            result = SPIM_ERROR;
+        }
+    }
+
+    /* The contexts do not outlive this call */
+    for (index = 0u; index < message.count; index++)
+    {
+        if (message.in_flight[index])
+        {
+            cancel_requests(master, &contexts[index]);
+        }
+    }
+
+    return (result == SPIM_OK) ? message.result : result;
+}
+
+/*******************************************************************************
+* Function Name: spim_get_stats
+********************************************************************************
+*
+* Summary:
+*  Copies the link statistics.
+*
+* Parameters:
+*  - (spim_t const *) master - Connection state
+*  - (spim_stats_t *) stats - Destination
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spim_get_stats(spim_t const *master, spim_stats_t *stats)
+{
+    *stats = master->stats;
+}
+
+/* [] END OF FILE */
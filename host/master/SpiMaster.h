@@ -0,0 +1,227 @@
+/******************************************************************************
+* File Name: SpiMaster.h
+*
+* Description: This file contains the function prototypes of the master-side
+*              client library for Linux hosts talking to the SPI slave.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef HOST_MASTER_SPIMASTER_H_
+#define HOST_MASTER_SPIMASTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Cobs.h"
+#include "ChaCha.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Result codes */
+#define SPIM_OK                 (0)
+#define SPIM_ERROR              (-1)    /* Backend failure or malformed packet */
+#define SPIM_TIMEOUT            (-2)    /* No reply within the timeout */
+#define SPIM_BUSY               (-3)    /* Pipelining window full, poll first */
+#define SPIM_REJECTED           (-4)    /* The slave answered with CMD_ERROR */
+
+/* Backends */
+#define SPIM_BACKEND_SPIDEV     (0u)    /* /dev/spidevB.C */
+#define SPIM_BACKEND_SOCKET     (1u)    /* Socket or pty of the host build */
+
+/* Fixed packet markers and layout, as in SpiSlave.h (without multi-drop) */
+#define SPIM_PACKET_SOP         (0x01u)
+#define SPIM_PACKET_EOP         (0x17u)
+#define SPIM_PACKET_SIZE        (3u)
+#define SPIM_PACKET_CMD_POS     (1u)
+
+/* Largest fixed packet batch clocked in one backend call */
+#define SPIM_BATCH_MAX          (64u)
+
+/* Frame identifiers and limits of the slave with COBS framing */
+#define SPIM_FRAME_MAX_SIZE     (32u)   /* SPI_FRAME_MAX_SIZE */
+#define SPIM_CMD_ERROR          (0x7Eu) /* CMD_ERROR */
+#define SPIM_LOG_FRAME_ID       (0x7Fu) /* DEBUG_LOG_FRAME_ID */
+
+/* Frame encryption, as in SpiCrypt.h */
+#define SPIM_CMD_CRYPT_START    (0xB0u) /* CMD_CRYPT_START */
+#define SPIM_CRYPT_FRAME_ID     (0xE0u) /* SPI_CRYPT_FRAME_ID, plus the TX class */
+#define SPIM_CRYPT_SESSION_FLAG (0x04u) /* SPI_CRYPT_SESSION_FLAG */
+#define SPIM_CRYPT_OVERHEAD     (2u)    /* Identifier and counter byte */
+#define SPIM_CRYPT_NONCE_SIZE   (8u)
+#define SPIM_CRYPT_MAX_GAP      (127u)
+#define SPIM_CRYPT_TO_SLAVE     (0u)
+#define SPIM_CRYPT_TO_MASTER    (1u)    /* Plus the TX class */
+#define SPIM_CRYPT_CLASSES      (3u)    /* SPI_TX_CLASSES */
+#define SPIM_CRYPT_STREAMS      (SPIM_CRYPT_TO_MASTER + SPIM_CRYPT_CLASSES)
+
+/* Fragmented messages, as in Fragment.h */
+#define SPIM_CMD_FRAGMENT       (0xC0u) /* CMD_FRAGMENT */
+#define SPIM_FRAGMENT_HEADER_SIZE (5u)
+#define SPIM_FRAGMENT_DATA_SIZE (SPIM_FRAME_MAX_SIZE - SPIM_FRAGMENT_HEADER_SIZE)
+#define SPIM_FRAGMENT_MAX_COUNT (255u)
+#define SPIM_FRAGMENT_ACK_SIZE  (5u)
+#define SPIM_FRAGMENT_ACK_CRC_SIZE (9u)
+#define SPIM_FRAGMENT_COMPLETE  (1u)    /* FRAGMENT_STATE_COMPLETE */
+#define SPIM_FRAGMENT_REJECTED  (2u)    /* FRAGMENT_STATE_REJECTED */
+
+/* Sends of one fragment before a message is given up */
+#define SPIM_FRAGMENT_TRIES     (4u)
+
+/* Requests in flight. Matches SPI_TX_CONTROL_DEPTH so that the slave never
+ * has to drop a reply. */
+#define SPIM_WINDOW             (4u)
+
+/* Bytes clocked per transfer. Kept below half of SPI_RX_RING_SIZE so the
+ * slave drains its ring between transfers. */
+#ifndef SPIM_CHUNK_SIZE
+#define SPIM_CHUNK_SIZE         (48u)
+#endif
+
+/* Byte shifted out by the slave when its TX FIFO runs empty */
+#define SPIM_IDLE_BYTE          (0xFFu)
+
+/* Default idle time between fixed packets, for the slave to re-arm */
+#define SPIM_PACKET_GAP_US      (50u)
+
+/* Encoded bytes waiting to be clocked out */
+#define SPIM_TX_QUEUE_SIZE      (SPIM_WINDOW * (COBS_ENCODED_MAX(SPIM_FRAME_MAX_SIZE + SPIM_CRYPT_OVERHEAD) + 1u))
+
+/* Default reply timeout */
+#define SPIM_TIMEOUT_MS         (100u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Called once per submitted request with SPIM_OK and the reply, or with
+ * SPIM_REJECTED and the CMD_ERROR frame, or with SPIM_TIMEOUT and no data */
+typedef void (*spim_reply_cb_t)(void *, int, uint8_t const *, uint32_t);
+
+/* Called for frames that answer no request, such as debug log records,
+ * ADC blocks and GPIO events */
+typedef void (*spim_frame_cb_t)(void *, uint8_t const *, uint32_t);
+
+/* One request of a batch */
+typedef struct
+{
+    uint8_t const *data;    /* Request frame, opcode first */
+    uint32_t length;
+    spim_reply_cb_t callback;
+    void *context;
+} spim_request_t;
+
+/* Request waiting for its reply */
+typedef struct
+{
+    bool in_use;
+    uint8_t opcode;
+    uint32_t sequence;      /* Submission order, the oldest is matched first */
+    uint64_t deadline_ms;
+    spim_reply_cb_t callback;
+    void *context;
+} spim_pending_t;
+
+/* Link statistics */
+typedef struct
+{
+    uint32_t requests;      /* Requests submitted */
+    uint32_t replies;       /* Requests answered, including CMD_ERROR */
+    uint32_t timeouts;      /* Requests that expired */
+    uint32_t unsolicited;   /* Frames passed to the frame callback */
+    uint32_t frame_errors;  /* Malformed or oversized frames received */
+    uint32_t crypt_errors;  /* Frames received in clear or out of sequence */
+    uint64_t bytes_clocked; /* Bytes exchanged with the slave */
+    uint64_t bytes_useful;  /* Non-delimiter bytes sent */
+} spim_stats_t;
+
+/* Connection to one slave. Allocated by the caller, no dynamic memory. */
+typedef struct
+{
+    uint32_t backend;
+    int fd;
+    uint32_t speed_hz;
+    uint16_t gap_us;        /* Idle time between fixed packets */
+    uint32_t timeout_ms;
+
+    uint8_t tx_queue[SPIM_TX_QUEUE_SIZE];
+    uint32_t tx_length;
+
+    cobs_decoder_t decoder;
+    uint8_t frame[SPIM_FRAME_MAX_SIZE + SPIM_CRYPT_OVERHEAD];
+    bool rx_in_frame;       /* Non-delimiter byte seen since the last delimiter */
+
+    spim_pending_t pending[SPIM_WINDOW];
+    uint32_t pending_count;
+    uint32_t sequence;
+
+    spim_frame_cb_t frame_callback;
+    void *frame_context;
+
+    uint8_t message_id;     /* Identifier of the next fragmented message */
+
+    bool crypt;             /* Session started with spim_start_crypt() */
+    uint8_t crypt_session;  /* SPIM_CRYPT_SESSION_FLAG in every other session */
+    chacha_key_t crypt_keys[SPIM_CRYPT_STREAMS];    /* SPIM_CRYPT_TO_x */
+    uint32_t crypt_tx_next; /* Counter of the next frame sent */
+    uint32_t crypt_rx_next[SPIM_CRYPT_CLASSES];     /* Expected next, per class */
+
+    spim_stats_t stats;
+} spim_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+int spim_open_spidev(spim_t *, char const *, uint32_t, uint8_t);
+int spim_open_socket(spim_t *, char const *);
+int spim_open_pty(spim_t *, char const *);
+void spim_close(spim_t *);
+void spim_set_timeout(spim_t *, uint32_t);
+void spim_set_packet_gap(spim_t *, uint16_t);
+void spim_set_frame_callback(spim_t *, spim_frame_cb_t, void *);
+int spim_transfer(spim_t *, uint8_t const *, uint8_t *, uint32_t);
+
+int spim_packet(spim_t *, uint8_t, uint8_t *);
+int spim_packet_batch(spim_t *, uint8_t const *, uint8_t *, uint32_t);
+
+int spim_submit(spim_t *, uint8_t const *, uint32_t, spim_reply_cb_t, void *);
+int spim_poll(spim_t *);
+int spim_flush(spim_t *);
+int spim_batch(spim_t *, spim_request_t const *, uint32_t);
+int spim_call(spim_t *, uint8_t const *, uint32_t, uint8_t *, uint32_t, uint32_t *);
+int spim_start_crypt(spim_t *, uint8_t const *);
+bool spim_parse_key(char const *, uint8_t *);
+int spim_send_message(spim_t *, uint8_t, uint8_t const *, uint32_t);
+void spim_get_stats(spim_t const *, spim_stats_t *);
+
+#endif /* HOST_MASTER_SPIMASTER_H_ */
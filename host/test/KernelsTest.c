@@ -0,0 +1,325 @@
+/******************************************************************************
+* File Name: KernelsTest.c
+*
+* Description: This file contains the host equivalence tests of the copy, compare,
+*              checksum and CRC kernels against the C library and bitwise
+*              reference CRCs, for every alignment and the short lengths.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "Kernels.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Lengths tested: 0 up to four 16-byte copy blocks plus a 3-byte tail */
+#define TEST_MAX_LENGTH         (67u)
+
+/* Offsets from a word boundary */
+#define TEST_OFFSETS            (4u)
+
+/* Guard bytes on each side of a destination */
+#define TEST_GUARD              (8u)
+#define TEST_GUARD_BYTE         (0xA5u)
+
+#define TEST_BUFFER_SIZE        (TEST_GUARD + TEST_OFFSETS + TEST_MAX_LENGTH + TEST_GUARD)
+
+/* Check values of the CRCs over "123456789" */
+#define TEST_CRC16_CHECK        (0x29B1u)
+#define TEST_CRC32_CHECK        (0xCBF43926UL)
+
+/*******************************************************************************
+ * Global variables
+ ******************************************************************************/
+
+/* Word-aligned buffers, so the offsets select the alignment */
+static uint32_t source_words[TEST_BUFFER_SIZE / 4u + 1u];
+static uint32_t dest_words[TEST_BUFFER_SIZE / 4u + 1u];
+static uint32_t expect_words[TEST_BUFFER_SIZE / 4u + 1u];
+
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void fail(char const *, uint32_t, uint32_t, uint32_t);
+static void fill(uint8_t *, uint32_t, uint32_t);
+static uint16_t reference_crc16(uint16_t, uint8_t const *, uint32_t);
+static uint32_t reference_crc32(uint32_t, uint8_t const *, uint32_t);
+static void test_copy_xor(uint8_t const *, uint32_t, uint32_t, uint32_t);
+static void test_equal(uint8_t const *, uint32_t, uint32_t, uint32_t);
+static void test_checksums(uint8_t const *, uint32_t, uint32_t);
+
+/*******************************************************************************
+* Function Name: fail
+********************************************************************************
+* Summary:
+*  Reports a kernel whose result differs from the reference.
+*
+*******************************************************************************/
+static void fail(char const *kernel, uint32_t dest_offset, uint32_t source_offset, uint32_t length)
+{
+    if (failures < 20UL)
+    {
+        printf("FAIL %s: dest offset %u, source offset %u, length %u\n", kernel,
+               (unsigned) dest_offset, (unsigned) source_offset, (unsigned) length);
+    }
+    failures++;
+}
+
+/*******************************************************************************
+* Function Name: fill
+********************************************************************************
+* Summary:
+*  Fills a buffer with a pseudo-random pattern that depends on the seed.
+*
+*******************************************************************************/
+static void fill(uint8_t *buffer, uint32_t length, uint32_t seed)
+{
+    uint32_t state = (seed * 2654435761UL) | 1UL;
+    uint32_t index;
+
+    for (index = 0UL; index < length; index++)
+    {
+        state = (state * 1103515245UL) + 12345UL;
+        buffer[index] = (uint8_t)(state >> 16u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: reference_crc16
+********************************************************************************
+* Summary:
+*  CRC-16/CCITT computed one bit at a time.
+*
+*******************************************************************************/
+static uint16_t reference_crc16(uint16_t crc, uint8_t const *data, uint32_t length)
+{
+    uint32_t bit;
+
+    while (0UL != length)
+    {
+        crc ^= (uint16_t)(*data++ << 8u);
+        for (bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (0u != (crc & 0x8000u)) ? (uint16_t)((crc << 1u) ^ 0x1021u) : (uint16_t)(crc << 1u);
+        }
+        length--;
+    }
+
+    return crc;
+}
+
+/*******************************************************************************
+* Function Name: reference_crc32
+********************************************************************************
+* Summary:
+*  CRC-32 computed one bit at a time, with the same chaining as
+*  kernel_crc32().
+*
+*******************************************************************************/
+static uint32_t reference_crc32(uint32_t crc, uint8_t const *data, uint32_t length)
+{
+    uint32_t bit;
+
+    crc = ~crc;
+    while (0UL != length)
+    {
+        crc ^= *data++;
+        for (bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (0UL != (crc & 1UL)) ? ((crc >> 1u) ^ 0xEDB88320UL) : (crc >> 1u);
+        }
+        length--;
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+* Function Name: test_copy_xor
+********************************************************************************
+* Summary:
+*  Checks kernel_copy() against memcpy() and kernel_xor() against a byte
+*  loop, including the guard bytes around the destination.
+*
+*******************************************************************************/
+static void test_copy_xor(uint8_t const *source, uint32_t dest_offset, uint32_t source_offset, uint32_t length)
+{
+    uint8_t *dest = (uint8_t *)dest_words;
+    uint8_t *expect = (uint8_t *)expect_words;
+    uint32_t index;
+
+    memset(dest, TEST_GUARD_BYTE, TEST_BUFFER_SIZE);
+    memset(expect, TEST_GUARD_BYTE, TEST_BUFFER_SIZE);
+    memcpy(&expect[TEST_GUARD + dest_offset], &source[source_offset], length);
+    kernel_copy(&dest[TEST_GUARD + dest_offset], &source[source_offset], length);
+    if (0 != memcmp(dest, expect, TEST_BUFFER_SIZE))
+    {
+        fail("kernel_copy", dest_offset, source_offset, length);
+    }
+
+    fill(dest, TEST_BUFFER_SIZE, length + 1000UL);
+    memcpy(expect, dest, TEST_BUFFER_SIZE);
+    for (index = 0UL; index < length; index++)
+    {
+        expect[TEST_GUARD + dest_offset + index] ^= source[source_offset + index];
+    }
+    kernel_xor(&dest[TEST_GUARD + dest_offset], &source[source_offset], length);
+    if (0 != memcmp(dest, expect, TEST_BUFFER_SIZE))
+    {
+        fail("kernel_xor", dest_offset, source_offset, length);
+    }
+}
+
+/*******************************************************************************
+* Function Name: test_equal
+********************************************************************************
+* Summary:
+*  Checks kernel_equal() against memcmp() on equal buffers and on buffers
+*  that differ in any one byte.
+*
+*******************************************************************************/
+static void test_equal(uint8_t const *source, uint32_t dest_offset, uint32_t source_offset, uint32_t length)
+{
+    uint8_t *dest = (uint8_t *)dest_words + TEST_GUARD + dest_offset;
+    uint32_t index;
+
+    memcpy(dest, &source[source_offset], length);
+    if (!kernel_equal(dest, &source[source_offset], length))
+    {
+        fail("kernel_equal (equal)", dest_offset, source_offset, length);
+    }
+
+    for (index = 0UL; index < length; index++)
+    {
+        dest[index] ^= (uint8_t)(1u << (index & 7u));
+        if (kernel_equal(dest, &source[source_offset], length) !=
+            (0 == memcmp(dest, &source[source_offset], length)))
+        {
+            fail("kernel_equal (different)", dest_offset, source_offset, length);
+        }
+        dest[index] = source[source_offset + index];
+    }
+}
+
+/*******************************************************************************
+* Function Name: test_checksums
+********************************************************************************
+* Summary:
+*  Checks kernel_sum8() and the CRC kernels against the references, in
+*  one call and split into two chunks at every position.
+*
+*******************************************************************************/
+static void test_checksums(uint8_t const *source, uint32_t source_offset, uint32_t length)
+{
+    uint8_t const *data = &source[source_offset];
+    uint32_t sum = 0UL;
+    uint32_t index;
+    uint16_t crc16 = reference_crc16(KERNEL_CRC16_INIT, data, length);
+    uint32_t crc32 = reference_crc32(KERNEL_CRC32_INIT, data, length);
+
+    for (index = 0UL; index < length; index++)
+    {
+        sum += data[index];
+    }
+    if (kernel_sum8(data, length) != sum)
+    {
+        fail("kernel_sum8", 0UL, source_offset, length);
+    }
+
+    for (index = 0UL; index <= length; index++)
+    {
+        if (kernel_crc16(kernel_crc16(KERNEL_CRC16_INIT, data, index), &data[index], length - index) != crc16)
+        {
+            fail("kernel_crc16", index, source_offset, length);
+        }
+        if (kernel_crc32(kernel_crc32(KERNEL_CRC32_INIT, data, index), &data[index], length - index) != crc32)
+        {
+            fail("kernel_crc32", index, source_offset, length);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+*  Runs every kernel for each destination and source offset and each
+*  length up to TEST_MAX_LENGTH. Returns 1 if any result differs.
+*
+*******************************************************************************/
+int main(void)
+{
+    static uint8_t const check[] = "123456789";
+    uint8_t *source = (uint8_t *)source_words;
+    uint32_t dest_offset;
+    uint32_t source_offset;
+    uint32_t length;
+
+    if ((reference_crc16(KERNEL_CRC16_INIT, check, 9UL) != TEST_CRC16_CHECK) ||
+        (kernel_crc16(KERNEL_CRC16_INIT, check, 9UL) != TEST_CRC16_CHECK))
+    {
+        fail("kernel_crc16 check value", 0UL, 0UL, 9UL);
+    }
+    if ((reference_crc32(KERNEL_CRC32_INIT, check, 9UL) != TEST_CRC32_CHECK) ||
+        (kernel_crc32(KERNEL_CRC32_INIT, check, 9UL) != TEST_CRC32_CHECK))
+    {
+        fail("kernel_crc32 check value", 0UL, 0UL, 9UL);
+    }
+
+    fill(source, TEST_BUFFER_SIZE, 1UL);
+
+    for (length = 0UL; length <= TEST_MAX_LENGTH; length++)
+    {
+        for (source_offset = 0UL; source_offset < TEST_OFFSETS; source_offset++)
+        {
+            for (dest_offset = 0UL; dest_offset < TEST_OFFSETS; dest_offset++)
+            {
+                test_copy_xor(source, dest_offset, source_offset, length);
+                test_equal(source, dest_offset, source_offset, length);
+            }
+            test_checksums(source, source_offset, length);
+        }
+    }
+
+    printf("kernels (KERNELS_PORTABLE=%u): %s, %u failures\n", (unsigned) KERNELS_PORTABLE,
+           (0UL == failures) ? "PASS" : "FAIL", (unsigned) failures);
+
+    return (0UL == failures) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,123 @@
+#!/bin/sh
+################################################################################
+# \file benchmark.sh
+#
+# \brief
+# Builds the slave with BENCHMARK=1u under each toolchain and build
+# configuration, and reports the code size of the hot-path functions and,
+# when a spidev device is given, the cycles per frame measured on the
+# target. Each combination is programmed and queried in turn.
+#
+#   scripts/benchmark.sh                          Sizes only
+#   scripts/benchmark.sh -d /dev/spidev0.0        Sizes and cycles
+#   TOOLCHAINS="GCC_ARM ARM" CONFIGS=Release scripts/benchmark.sh
+#
+# Results are written to bench/sizes.csv and bench/cycles.csv, one line per
+# toolchain, configuration and function or path, and summarised on stdout.
+# Toolchains that are not installed are skipped.
+#
+################################################################################
+# \copyright
+# $ Copyright 2023 Cypress Semiconductor Apache2 $
+################################################################################
+
+set -u
+
+TOOLCHAINS="${TOOLCHAINS:-GCC_ARM ARM IAR}"
+CONFIGS="${CONFIGS:-Debug Release}"
+OUT="${OUT:-bench}"
+DEVICE=""
+
+# Functions on the path of every frame
+FUNCTIONS="SPI_Isr next_tx_byte read_frame write_class_frame ring_buffer_put ring_buffer_get \
+cobs_decode_byte cobs_encode command_dispatch echo_command kernel_crc32 kernel_copy \
+kernel_xor chacha_block spi_crypt_encrypt spi_crypt_decrypt"
+
+while getopts "d:" option; do
+    case "$option" in
+        d) DEVICE="$OPTARG" ;;
+        *) echo "usage: $0 [-d /dev/spidevB.C]" >&2; exit 2 ;;
+    esac
+done
+
+cd "$(dirname "$0")/.." || exit 1
+
+# Symbol sizes are read from the ELF file, which all three toolchains emit
+NM="${NM:-$(command -v arm-none-eabi-nm || ls "$HOME"/ModusToolbox/tools_*/gcc/bin/arm-none-eabi-nm 2>/dev/null | tail -n 1)}"
+if [ -z "$NM" ]; then
+    echo "arm-none-eabi-nm not found, set NM" >&2
+    exit 1
+fi
+
+if [ -n "$DEVICE" ]; then
+    make -C host master >/dev/null || exit 1
+fi
+
+mkdir -p "$OUT"
+echo "toolchain,config,function,bytes" > "$OUT/sizes.csv"
+echo "toolchain,config,path,cycles,us" > "$OUT/cycles.csv"
+
+for toolchain in $TOOLCHAINS; do
+    for config in $CONFIGS; do
+        name="$toolchain-$config"
+        log="$OUT/$name.log"
+        stamp="$OUT/.$name.stamp"
+        touch "$stamp"
+
+        # The footprint and stack checks are for production builds
+        if ! make build TOOLCHAIN="$toolchain" CONFIG="$config" FOOTPRINT_CHECK=0 STACK_CHECK=0 \
+                DEFINES="SPI_FRAMING=SPI_FRAMING_COBS BENCHMARK=1u" > "$log" 2>&1; then
+            echo "$name: build failed or toolchain not installed, see $log"
+            continue
+        fi
+
+        elf=$(find build -path "*/$config/*.elf" -newer "$stamp" | head -n 1)
+        if [ -z "$elf" ]; then
+            echo "$name: no ELF file produced"
+            continue
+        fi
+        cp "$elf" "$OUT/$name.elf"
+
+        "$NM" -S --size-sort --radix=d "$OUT/$name.elf" | awk -v tc="$toolchain" -v cfg="$config" \
+            -v list="$FUNCTIONS" '
+            BEGIN { n = split(list, names, " "); for (i = 1; i <= n; i++) wanted[names[i]] = 1 }
+            ($3 ~ /^[tT]$/) && ($4 in wanted) { printf "%s,%s,%s,%d\n", tc, cfg, $4, $2 + 0 }
+            ' >> "$OUT/sizes.csv"
+
+        if [ -n "$DEVICE" ]; then
+            if make qprogram TOOLCHAIN="$toolchain" CONFIG="$config" >> "$log" 2>&1; then
+                sleep 1
+                host/master/spim_bench "$DEVICE" | awk -v tc="$toolchain" -v cfg="$config" -F, '
+                    $1 != "clock_hz" { printf "%s,%s,%s,%s,%s\n", tc, cfg, $1, $2, $3 }
+                    ' >> "$OUT/cycles.csv"
+            else
+                echo "$name: programming failed, see $log"
+            fi
+        fi
+        echo "$name: done"
+    done
+done
+
+# Summary: one column per combination
+for table in sizes cycles; do
+    echo
+    awk -F, '
+        NR == 1 { next }
+        {
+            key = $1 "-" $2
+            if (!(key in seen)) { seen[key] = 1; cols[++ncols] = key }
+            if (!($3 in rowseen)) { rowseen[$3] = 1; rows[++nrows] = $3 }
+            value[$3, key] = $4
+        }
+        END {
+            if (nrows == 0) exit
+            printf "%-18s", FILENAME ~ /sizes/ ? "bytes" : "cycles/frame"
+            for (c = 1; c <= ncols; c++) printf " %15s", cols[c]
+            printf "\n"
+            for (r = 1; r <= nrows; r++) {
+                printf "%-18s", rows[r]
+                for (c = 1; c <= ncols; c++) printf " %15s", ((rows[r], cols[c]) in value) ? value[rows[r], cols[c]] : "-"
+                printf "\n"
+            }
+        }' "$OUT/$table.csv"
+done
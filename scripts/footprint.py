@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+################################################################################
+# \file footprint.py
+#
+# \brief
+# Reports the flash and RAM used by each source file and subsystem, from
+# the map file of the GCC_ARM linker, and checks them against the budgets
+# in footprint_budget.ini. The build fails when a budget is exceeded, or
+# when a subsystem grew by more than the allowed regression since the
+# baseline. There is one baseline per target, configuration and set of
+# DEFINES, written only on request. Run from the Makefile as a post-build
+# step.
+#
+#   footprint.py --target PMG1-CY7110 --config Debug <map>
+#   footprint.py --target PMG1-CY7110 --config Debug --update-baseline <map>
+#
+################################################################################
+# \copyright
+# $ Copyright 2023 Cypress Semiconductor Apache2 $
+################################################################################
+
+import argparse
+import configparser
+import csv
+import fnmatch
+import os
+import re
+import sys
+import zlib
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_BUDGET = os.path.join(SCRIPT_DIR, 'footprint_budget.ini')
+
+# Memory region: name, origin, length, attributes
+REGION_RE = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$')
+
+# Output section: name at column 0, address and size, optional load address
+OUTPUT_RE = re.compile(r'^(\.\S+|\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?')
+
+# Input section: indented name, address, size and object file. Long names
+# put the address on the next line.
+INPUT_RE = re.compile(r'^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+NAME_ONLY_RE = re.compile(r'^ (\S+)\s*$')
+
+
+class Region:
+    def __init__(self, name, origin, length, attributes):
+        self.name = name
+        self.origin = origin
+        self.length = length
+        # Regions that are not writable hold the image
+        self.is_flash = 'w' not in attributes.lower()
+
+    def contains(self, address):
+        return self.origin <= address < self.origin + self.length
+
+
+def find_region(regions, address):
+    for region in regions:
+        if region.contains(address):
+            return region
+    return None
+
+
+def module_of(path):
+    """Returns the source file an input section comes from: the object
+    name without extension, or archive(member) for library code."""
+    path = path.strip()
+    match = re.match(r'^(.*)\((.*)\)$', path)
+    if match:
+        return '%s(%s)' % (os.path.basename(match.group(1)), os.path.splitext(match.group(2))[0])
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def reserved_of(name):
+    """Returns <stack> or <heap> for the sections that reserve them, or None.
+    The PMG1 GCC_ARM linker scripts collect *(.stack*) in .stack_dummy and
+    *(.heap*) in .heap, so any .stack* or .heap* name matches."""
+    for reserved in ('stack', 'heap'):
+        if (name is not None) and name.startswith('.' + reserved):
+            return '<%s>' % reserved
+    return None
+
+
+def parse_map(path):
+    """Returns the memory regions and a dict of module -> [flash, ram]."""
+    regions = []
+    usage = {}
+    state = 'start'
+    output_name = None
+    output_load = None
+    pending_name = None
+
+    with open(path, errors='replace') as map_file:
+        for line in map_file:
+            line = line.rstrip('\n')
+
+            if line.startswith('Memory Configuration'):
+                state = 'regions'
+                continue
+            if line.startswith('Linker script and memory map'):
+                state = 'map'
+                continue
+
+            if state == 'regions':
+                match = REGION_RE.match(line)
+                if match and match.group(1) not in ('Name', '*default*'):
+                    regions.append(Region(match.group(1), int(match.group(2), 16),
+                                          int(match.group(3), 16), match.group(4) or ''))
+                continue
+
+            if state != 'map':
+                continue
+
+            if line and not line[0].isspace():
+                match = OUTPUT_RE.match(line)
+                output_name = match.group(1) if match else line.split()[0]
+                output_load = int(match.group(4), 16) if (match and match.group(4)) else None
+                pending_name = None
+                continue
+
+            match = INPUT_RE.match(line)
+            if not match:
+                name_match = NAME_ONLY_RE.match(line)
+                pending_name = name_match.group(1) if name_match else None
+                continue
+
+            section = match.group(1) or pending_name
+            pending_name = None
+            address = int(match.group(2), 16)
+            size = int(match.group(3), 16)
+            source = match.group(4)
+            if (size == 0) or (section is None) or source.startswith('load address'):
+                continue
+
+            region = find_region(regions, address)
+            if region is None:
+                continue
+
+            module = reserved_of(output_name) or reserved_of(section) or module_of(source)
+
+            entry = usage.setdefault(module, [0, 0])
+            if region.is_flash:
+                entry[0] += size
+            else:
+                entry[1] += size
+                # Initialised data is also stored in flash
+                load_region = find_region(regions, output_load) if output_load is not None else None
+                if (load_region is not None) and load_region.is_flash:
+                    entry[0] += size
+
+    return regions, usage
+
+
+def subsystem_of(module, patterns):
+    for name, globs in patterns:
+        for glob in globs:
+            if fnmatch.fnmatch(module, glob):
+                return name
+    return 'other'
+
+
+def baseline_key(target, config, defines):
+    """TARGET.CONFIG, followed by a hash of the DEFINES when there are any,
+    so that builds with other features are compared with their own
+    baseline."""
+    key = '%s.%s' % (target, config)
+    names = sorted(defines.split())
+    if names:
+        key += '.%08x' % zlib.crc32(' '.join(names).encode())
+    return key
+
+
+def read_baseline(path):
+    baseline = {}
+    if os.path.exists(path):
+        with open(path, newline='') as baseline_file:
+            for row in csv.DictReader(baseline_file):
+                baseline[row['subsystem']] = (int(row['flash']), int(row['ram']))
+    return baseline
+
+
+def write_baseline(path, totals):
+    with open(path, 'w', newline='') as baseline_file:
+        writer = csv.writer(baseline_file)
+        writer.writerow(['subsystem', 'flash', 'ram'])
+        for name in sorted(totals):
+            writer.writerow([name, totals[name][0], totals[name][1]])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Footprint report and budget check')
+    parser.add_argument('map', help='Linker map file (GCC_ARM)')
+    parser.add_argument('--budget', default=DEFAULT_BUDGET, help='Budget file')
+    parser.add_argument('--baseline', help='Baseline CSV, overrides the budget file')
+    parser.add_argument('--target', default='default', help='TARGET of the build')
+    parser.add_argument('--config', default='default', help='CONFIG of the build')
+    parser.add_argument('--defines', default='', help='DEFINES of the build')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='Write the current footprint as the new baseline')
+    parser.add_argument('--quiet', action='store_true', help='Print only the subsystem table')
+    args = parser.parse_args()
+
+    config = configparser.ConfigParser()
+    config.optionxform = str
+    config.read(args.budget)
+
+    patterns = [(name, value.split()) for name, value in config.items('subsystems')] \
+        if config.has_section('subsystems') else []
+    regression = config.getint('options', 'regression_bytes', fallback=0)
+    key = baseline_key(args.target, args.config, args.defines)
+    baseline_path = args.baseline or config.get('options', 'baseline', fallback='').format(key=key)
+    if baseline_path and not os.path.isabs(baseline_path) and not args.baseline:
+        baseline_path = os.path.join(os.path.dirname(os.path.abspath(args.budget)), baseline_path)
+
+    regions, usage = parse_map(args.map)
+    if not regions:
+        print('footprint: no memory regions in %s (not a GNU ld map?)' % args.map)
+        return 1
+
+    totals = {}
+    for module, (flash, ram) in usage.items():
+        entry = totals.setdefault(subsystem_of(module, patterns), [0, 0])
+        entry[0] += flash
+        entry[1] += ram
+    total_flash = sum(value[0] for value in usage.values())
+    total_ram = sum(value[1] for value in usage.values())
+
+    if not args.quiet:
+        print('%-40s %8s %8s  %s' % ('File', 'Flash', 'RAM', 'Subsystem'))
+        for module, (flash, ram) in sorted(usage.items(), key=lambda item: (-item[1][0], -item[1][1])):
+            print('%-40s %8d %8d  %s' % (module, flash, ram, subsystem_of(module, patterns)))
+        print()
+
+    failures = []
+    baseline = read_baseline(baseline_path) if baseline_path else {}
+
+    def check(name, flash, ram, budget_section):
+        flash_budget = config.getint(budget_section, 'flash', fallback=0) \
+            if config.has_section(budget_section) else 0
+        ram_budget = config.getint(budget_section, 'ram', fallback=0) \
+            if config.has_section(budget_section) else 0
+        if flash_budget and flash > flash_budget:
+            failures.append('%s: flash %d exceeds the budget of %d' % (name, flash, flash_budget))
+        if ram_budget and ram > ram_budget:
+            failures.append('%s: RAM %d exceeds the budget of %d' % (name, ram, ram_budget))
+        return flash_budget, ram_budget
+
+    print('%-14s %8s %8s %8s %8s %8s %8s' % ('Subsystem', 'Flash', 'Budget', 'Delta', 'RAM', 'Budget', 'Delta'))
+    for name in sorted(totals):
+        flash, ram = totals[name]
+        flash_budget, ram_budget = check(name, flash, ram, 'budget.' + name)
+        flash_delta = ram_delta = ''
+        if name in baseline:
+            flash_delta = flash - baseline[name][0]
+            ram_delta = ram - baseline[name][1]
+            if (not args.update_baseline) and \
+                    ((flash_delta > regression) or (ram_delta > regression)):
+                failures.append('%s: grew by %d bytes of flash and %d bytes of RAM since the baseline'
+                                % (name, flash_delta, ram_delta))
+        print('%-14s %8d %8s %8s %8d %8s %8s' % (name, flash, flash_budget or '-', flash_delta,
+                                                 ram, ram_budget or '-', ram_delta))
+
+    flash_budget, ram_budget = check('total', total_flash, total_ram, 'budget.total')
+    print('%-14s %8d %8s %8s %8d %8s %8s' % ('total', total_flash, flash_budget or '-', '',
+                                             total_ram, ram_budget or '-', ''))
+
+    for module, (flash, ram) in sorted(usage.items()):
+        check(module, flash, ram, 'budget.file.' + module)
+
+    if baseline_path and args.update_baseline:
+        write_baseline(baseline_path, totals)
+        print('footprint: baseline written to %s' % baseline_path)
+    elif baseline_path and not baseline:
+        print('footprint: no baseline %s, growth not checked (run with --update-baseline to record it)'
+              % os.path.basename(baseline_path))
+
+    if failures:
+        print()
+        for failure in failures:
+            print('footprint: error: ' + failure)
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+################################################################################
+# \file image_crc.py
+#
+# \brief
+# Writes the reference record of the background flash scan after the
+# image in the Intel HEX file: a magic word, the size of the scanned area
+# and its CRC-32, as computed by kernel_crc32(). The scanned area is found
+# as in FlashScan.c, from the __etext, __data_start__ and __data_end__
+# symbols of the GCC_ARM linker map. Run from the Makefile as a post-build
+# step when FLASH_SCAN is enabled.
+#
+#   image_crc.py build/PMG1-CY7110/Debug/mtb-example-pmg1-spi-slave.map \
+#                build/PMG1-CY7110/Debug/mtb-example-pmg1-spi-slave.hex
+#
+################################################################################
+# \copyright
+# $ Copyright 2023 Cypress Semiconductor Apache2 $
+################################################################################
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+# FLASH_SCAN_RECORD_MAGIC in FlashScan.h
+RECORD_MAGIC = 0x52435346
+
+# Linker script symbol assignment in the map: address, name
+SYMBOL_RE = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+(\w+)\s*=')
+
+HEX_DATA = 0x00
+HEX_EOF = 0x01
+HEX_EXTENDED_SEGMENT = 0x02
+HEX_EXTENDED_LINEAR = 0x04
+
+
+def read_symbols(path, names):
+    symbols = {}
+    with open(path, errors='replace') as map_file:
+        for line in map_file:
+            match = SYMBOL_RE.match(line)
+            if match and (match.group(2) in names):
+                symbols[match.group(2)] = int(match.group(1), 16)
+    return symbols
+
+
+def read_hex(path):
+    """Returns a dict of address -> byte and the records other than data,
+    extended address and end of file, such as the start address."""
+    data = {}
+    other = []
+    base = 0
+    with open(path) as hex_file:
+        for number, line in enumerate(hex_file, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(':'):
+                raise ValueError('line %d: not an Intel HEX record' % number)
+            record = bytes.fromhex(line[1:])
+            if (len(record) < 5) or (len(record) != record[0] + 5) or (sum(record) & 0xFF):
+                raise ValueError('line %d: bad length or checksum' % number)
+            length, address, kind = record[0], (record[1] << 8) | record[2], record[3]
+            payload = record[4:4 + length]
+            if kind == HEX_DATA:
+                for index, byte in enumerate(payload):
+                    data[base + address + index] = byte
+            elif kind == HEX_EXTENDED_LINEAR:
+                base = ((payload[0] << 8) | payload[1]) << 16
+            elif kind == HEX_EXTENDED_SEGMENT:
+                base = ((payload[0] << 8) | payload[1]) << 4
+            elif kind == HEX_EOF:
+                break
+            else:
+                other.append(line)
+    return data, other
+
+
+def hex_line(kind, address, payload):
+    record = bytes([len(payload), (address >> 8) & 0xFF, address & 0xFF, kind]) + bytes(payload)
+    return ':%s%02X' % (record.hex().upper(), (-sum(record)) & 0xFF)
+
+
+def write_hex(path, data, other):
+    lines = []
+    base = None
+    addresses = sorted(data)
+    index = 0
+    while index < len(addresses):
+        start = addresses[index]
+        if (start >> 16) != base:
+            base = start >> 16
+            lines.append(hex_line(HEX_EXTENDED_LINEAR, 0, [base >> 8, base & 0xFF]))
+        # Up to 16 contiguous bytes that do not cross a 64 KB boundary
+        payload = []
+        while (index < len(addresses)) and (len(payload) < 16) and \
+                (addresses[index] == start + len(payload)) and ((addresses[index] >> 16) == base):
+            payload.append(data[addresses[index]])
+            index += 1
+        lines.append(hex_line(HEX_DATA, start & 0xFFFF, payload))
+    lines.extend(other)
+    lines.append(hex_line(HEX_EOF, 0, []))
+    with open(path, 'w') as hex_file:
+        hex_file.write('\n'.join(lines) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Reference CRC of the background flash scan')
+    parser.add_argument('map', help='Linker map file (GCC_ARM)')
+    parser.add_argument('hex', help='Intel HEX image, updated in place')
+    parser.add_argument('--start', type=lambda value: int(value, 0), default=0,
+                        help='FLASH_SCAN_START (default CY_FLASH_BASE, 0)')
+    args = parser.parse_args()
+
+    names = ('__etext', '__data_start__', '__data_end__')
+    symbols = read_symbols(args.map, names)
+    missing = [name for name in names if name not in symbols]
+    if missing:
+        print('image_crc: %s not found in %s' % (', '.join(missing), args.map))
+        return 1
+
+    # FLASH_SCAN_SIZE in FlashScan.c
+    size = symbols['__etext'] + (symbols['__data_end__'] - symbols['__data_start__']) - args.start
+
+    try:
+        data, other = read_hex(args.hex)
+    except (OSError, ValueError) as error:
+        print('image_crc: %s: %s' % (args.hex, error))
+        return 1
+
+    gaps = [address for address in range(args.start, args.start + size) if address not in data]
+    if gaps:
+        print('image_crc: %s does not cover 0x%08X, the scanned area ends at 0x%08X'
+              % (args.hex, gaps[0], args.start + size))
+        return 1
+
+    crc = zlib.crc32(bytes(data[address] for address in range(args.start, args.start + size)))
+
+    # First word boundary after the scanned area, as read by FlashScan.c
+    record_address = (args.start + size + 3) & ~3
+    for offset in range(args.start + size, record_address):
+        data.setdefault(offset, 0)
+    for offset, byte in enumerate(struct.pack('<III', RECORD_MAGIC, size, crc)):
+        data[record_address + offset] = byte
+
+    write_hex(args.hex, data, other)
+    print('image_crc: %d bytes from 0x%08X, CRC %08X, record at 0x%08X'
+          % (size, args.start, crc, record_address))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+################################################################################
+# \file slot_linker.py
+#
+# \brief
+# Writes the GCC_ARM linker script of a dual-slot image: a copy of the
+# linker script of the BSP with the flash region moved to the boot stage,
+# slot A or slot B, laid out as in DualSlotBoot.h. Prints the start
+# address of the region. Run from the Makefile when DUAL_SLOT_IMAGE is
+# set.
+#
+#   slot_linker.py --image A --boot-size 0x1000 \
+#                  bsps/TARGET_APP_PMG1-CY7110/COMPONENT_CM0/TOOLCHAIN_GCC_ARM/cy8c4xxx.ld \
+#                  build/PMG1-CY7110/dual_slot_A.ld
+#
+################################################################################
+# \copyright
+# $ Copyright 2023 Cypress Semiconductor Apache2 $
+################################################################################
+
+import argparse
+import os
+import re
+import sys
+
+# DUAL_SLOT_ALIGN in DualSlotBoot.h
+SLOT_ALIGN = 0x200
+
+# Region of the MEMORY command: name (attributes) : ORIGIN = x, LENGTH = y
+REGION_RE = re.compile(r'^(\s*(\w+)\s*\([^)]*\)\s*:\s*ORIGIN\s*=\s*)(\w+)(\s*,\s*LENGTH\s*=\s*)(\w+)',
+                       re.MULTILINE)
+
+
+def slot_region(image, flash_base, flash_size, boot_size):
+    """Returns the origin and length of an image, as DUAL_SLOT_A_START,
+    DUAL_SLOT_B_START and DUAL_SLOT_SIZE in DualSlotBoot.h"""
+    slot_size = ((flash_size - boot_size - SLOT_ALIGN) // 2) & ~(SLOT_ALIGN - 1)
+    if image == 'BOOT':
+        return flash_base, boot_size
+    if image == 'A':
+        return flash_base + boot_size, slot_size
+    return flash_base + boot_size + slot_size, slot_size
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Linker script of a dual-slot image')
+    parser.add_argument('bsp', help='GCC_ARM linker script of the BSP')
+    parser.add_argument('output', help='Linker script to write')
+    parser.add_argument('--image', choices=('BOOT', 'A', 'B'), required=True,
+                        help='Boot stage, slot A or slot B')
+    parser.add_argument('--boot-size', type=lambda value: int(value, 0), default=0x1000,
+                        help='DUAL_SLOT_BOOT_SIZE (default 0x1000)')
+    parser.add_argument('--region', default='flash',
+                        help='Name of the flash region in the MEMORY command (default flash)')
+    args = parser.parse_args()
+
+    try:
+        with open(args.bsp) as bsp_file:
+            script = bsp_file.read()
+    except OSError as error:
+        print('slot_linker: %s' % error, file=sys.stderr)
+        return 1
+
+    regions = {match.group(2): match for match in REGION_RE.finditer(script)}
+    if args.region not in regions:
+        print('slot_linker: no %s region in %s, found %s'
+              % (args.region, args.bsp, ', '.join(sorted(regions)) or 'none'), file=sys.stderr)
+        return 1
+
+    match = regions[args.region]
+    flash_base = int(match.group(3), 0)
+    flash_size = int(match.group(5), 0)
+    if (args.boot_size % SLOT_ALIGN) or (args.boot_size + 2 * SLOT_ALIGN > flash_size):
+        print('slot_linker: boot size 0x%X does not fit a %d KB flash in %d-byte steps'
+              % (args.boot_size, flash_size // 1024, SLOT_ALIGN), file=sys.stderr)
+        return 1
+
+    origin, length = slot_region(args.image, flash_base, flash_size, args.boot_size)
+    script = '%s%s0x%08X%s0x%08X%s' % (script[:match.start()], match.group(1), origin, match.group(4), length,
+                                      script[match.end():])
+    header = ('/* Generated by scripts/slot_linker.py from %s:\n'
+              ' * image %s, flash region 0x%08X-0x%08X */\n' % (args.bsp, args.image, origin, origin + length))
+
+    output_dir = os.path.dirname(args.output)
+    if output_dir:
+        os.makedirs(output_dir, exist_ok=True)
+    with open(args.output, 'w') as output_file:
+        output_file.write(header + script)
+
+    print('0x%08X' % origin)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
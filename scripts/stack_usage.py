@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+################################################################################
+# \file stack_usage.py
+#
+# \brief
+# Worst-case stack depth of the slave, from the call graph and the stack
+# usage that GCC writes with -fcallgraph-info=su (one .ci file per object).
+# The deepest path is computed from main and from every interrupt handler;
+# calls through function pointers are resolved with the table in
+# stack_usage.ini. Interrupts are assumed to nest on top of the deepest
+# main path, each with its exception frame. The build fails when the
+# total exceeds the stack reserved by the linker, __StackTop - __StackLimit
+# in the linker map.
+#
+#   stack_usage.py --map build/PMG1-CY7110/Debug/mtb-example-pmg1-spi-slave.map build/PMG1-CY7110/Debug
+#   stack_usage.py --stack-size 0x400 --verbose build/PMG1-CY7110/Debug
+#
+################################################################################
+# \copyright
+# $ Copyright 2023 Cypress Semiconductor Apache2 $
+################################################################################
+
+import argparse
+import configparser
+import fnmatch
+import os
+import re
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_CONFIG = os.path.join(SCRIPT_DIR, 'stack_usage.ini')
+
+NODE_RE = re.compile(r'^node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'^edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+STACK_RE = re.compile(r'\\n(\d+) bytes \(([a-z,]+)\)')
+
+# Symbol assignment in the linker map: address, then the assignment
+SYMBOL_RE = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+(?:PROVIDE \()?(\w+) = ')
+
+INDIRECT = '__indirect_call'
+
+
+def short_name(title):
+    """Static functions are titled file:function."""
+    return title.rsplit(':', 1)[-1]
+
+
+class Graph:
+    def __init__(self):
+        self.frames = {}        # title -> bytes
+        self.dynamic = set()    # titles with an unbounded dynamic stack
+        self.edges = {}         # title -> set of titles
+        self.by_name = {}       # short name -> titles defined
+
+    def load(self, path):
+        with open(path, errors='replace') as ci_file:
+            for line in ci_file:
+                match = NODE_RE.match(line)
+                if match:
+                    title, label = match.groups()
+                    stack = STACK_RE.search(label)
+                    if stack:
+                        self.frames[title] = int(stack.group(1))
+                        if ('dynamic' in stack.group(2)) and ('bounded' not in stack.group(2)):
+                            self.dynamic.add(title)
+                        self.by_name.setdefault(short_name(title), set()).add(title)
+                    continue
+                match = EDGE_RE.match(line)
+                if match:
+                    source, target = match.groups()
+                    self.edges.setdefault(source, set()).add(target)
+
+    def resolve(self, title):
+        """Returns the defined node for a call target, or None."""
+        if title in self.frames:
+            return title
+        titles = self.by_name.get(short_name(title), set())
+        return next(iter(titles)) if len(titles) == 1 else None
+
+    def find(self, pattern):
+        return sorted(title for name, titles in self.by_name.items()
+                      if fnmatch.fnmatch(name, pattern) for title in titles)
+
+
+def worst_path(graph, root, indirect, warnings, unknown):
+    """Deepest stack path from root: (bytes, [titles])."""
+    memo = {}
+    active = set()
+
+    def visit(title):
+        if title in memo:
+            return memo[title]
+        if title in active:
+            warnings.add('recursion through %s, depth not bounded' % short_name(title))
+            return (0, [])
+        active.add(title)
+
+        if title in graph.dynamic:
+            warnings.add('%s uses a dynamic stack, depth not bounded' % short_name(title))
+
+        callees = set()
+        for target in graph.edges.get(title, ()):
+            if target == INDIRECT:
+                patterns = indirect.get(short_name(title))
+                if patterns is None:
+                    warnings.add('%s makes an indirect call not listed in [indirect]' % short_name(title))
+                    continue
+                for pattern in patterns:
+                    callees.update(graph.find(pattern))
+                continue
+            resolved = graph.resolve(target)
+            if resolved is None:
+                unknown.add(target)
+                continue
+            callees.add(resolved)
+
+        best = (0, [])
+        for callee in sorted(callees):
+            depth = visit(callee)
+            if depth[0] > best[0]:
+                best = depth
+
+        active.discard(title)
+        result = (graph.frames.get(title, 0) + best[0], [title] + best[1])
+        memo[title] = result
+        return result
+
+    return visit(root)
+
+
+def map_stack_size(path):
+    """Returns __StackTop - __StackLimit from a GCC_ARM linker map, or None
+    if the map or either symbol is missing."""
+    symbols = {}
+    try:
+        with open(path, errors='replace') as map_file:
+            for line in map_file:
+                match = SYMBOL_RE.match(line)
+                if match and match.group(2) in ('__StackTop', '__StackLimit'):
+                    symbols[match.group(2)] = int(match.group(1), 16)
+    except OSError:
+        return None
+    if ('__StackTop' not in symbols) or ('__StackLimit' not in symbols):
+        return None
+    return symbols['__StackTop'] - symbols['__StackLimit']
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Worst-case stack depth from -fcallgraph-info=su')
+    parser.add_argument('build_dir', help='Directory searched for .ci files')
+    parser.add_argument('--config', default=DEFAULT_CONFIG, help='Roots and indirect calls')
+    parser.add_argument('--map', help='Linker map giving the stack reserved by the linker')
+    parser.add_argument('--stack-size', type=lambda value: int(value, 0),
+                        help='Stack reserved by the linker, overrides the map and the configuration')
+    parser.add_argument('--verbose', action='store_true', help='Print the deepest call chains')
+    args = parser.parse_args()
+
+    config = configparser.ConfigParser()
+    config.optionxform = str
+    config.read(args.config)
+
+    graph = Graph()
+    if config.has_section('external'):
+        # Library functions built without -fcallgraph-info
+        for name, value in config.items('external'):
+            graph.frames[name] = int(value, 0)
+            graph.by_name.setdefault(name, set()).add(name)
+    count = 0
+    for directory, _, files in os.walk(args.build_dir):
+        for name in files:
+            if name.endswith('.ci'):
+                graph.load(os.path.join(directory, name))
+                count += 1
+    if count == 0:
+        print('stack_usage: no .ci files in %s (build with -fcallgraph-info=su)' % args.build_dir)
+        return 1
+
+    indirect = {name: value.split() for name, value in config.items('indirect')} \
+        if config.has_section('indirect') else {}
+    thread_roots = config.get('roots', 'thread', fallback='main').split()
+    isr_patterns = config.get('roots', 'interrupts', fallback='').split()
+    exception_frame = config.getint('options', 'exception_frame', fallback=32)
+    stack_size = args.stack_size
+    if (stack_size is None) and args.map:
+        stack_size = map_stack_size(args.map)
+        if stack_size is None:
+            print('stack_usage: warning: no __StackTop and __StackLimit in %s, stack_size of %s used'
+                  % (args.map, os.path.basename(args.config)))
+    if stack_size is None:
+        stack_size = int(config.get('options', 'stack_size', fallback='0'), 0)
+
+    warnings = set()
+    unknown = set()
+    print('%-32s %8s' % ('Root', 'Bytes'))
+
+    thread_depth = 0
+    for pattern in thread_roots:
+        for root in graph.find(pattern):
+            depth, path = worst_path(graph, root, indirect, warnings, unknown)
+            print('%-32s %8d' % (short_name(root), depth))
+            if args.verbose:
+                print('    ' + ' -> '.join(short_name(title) for title in path))
+            thread_depth = max(thread_depth, depth)
+
+    isr_total = 0
+    isr_roots = sorted(set(root for pattern in isr_patterns for root in graph.find(pattern)))
+    for root in isr_roots:
+        depth, path = worst_path(graph, root, indirect, warnings, unknown)
+        print('%-32s %8d  + %d exception frame' % (short_name(root), depth, exception_frame))
+        if args.verbose:
+            print('    ' + ' -> '.join(short_name(title) for title in path))
+        isr_total += depth + exception_frame
+
+    total = thread_depth + isr_total
+    print('%-32s %8d  (deepest thread path, all interrupts nested)' % ('worst case', total))
+
+    if unknown:
+        warnings.add('no stack usage for %s (library or assembly, see [external]), counted as 0'
+                     % ', '.join(sorted(unknown)))
+    for warning in sorted(warnings):
+        print('stack_usage: warning: ' + warning)
+
+    if stack_size:
+        print('%-32s %8d  (%d bytes spare)' % ('stack size', stack_size, stack_size - total))
+        if total > stack_size:
+            print('stack_usage: error: worst case of %d bytes exceeds the stack of %d bytes'
+                  % (total, stack_size))
+            return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
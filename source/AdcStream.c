@@ -0,0 +1,300 @@
+/******************************************************************************
+* File Name: AdcStream.c
+*
+* Description: This file contains function definitions for the ADC
+*              sample stream read over the SPI link.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "AdcStream.h"
+#include "Command.h"
+
+#if (ADC_STREAM != 0u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint16_t sequence;
+    uint8_t flags;
+    uint16_t samples[ADC_BLOCK_SAMPLES];
+} adc_block_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Double buffer: the ISR fills blocks[fill_index] while the other one, if
+ * block_ready is set, waits for the master */
+static adc_block_t blocks[2];
+static uint32_t fill_index;
+static uint32_t fill_count;
+static volatile bool block_ready;
+
+/* Sequence number of the block being filled, counting lost blocks too */
+static uint16_t next_sequence;
+
+/* Set when a block was lost, reported with the next block delivered */
+static bool overrun_pending;
+
+static bool sampling;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void ADC_Isr(void);
+static uint32_t adc_read_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t adc_control_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static void adc_start(void);
+static void adc_stop(void);
+
+/*******************************************************************************
+* Function Name: ADC_Isr
+********************************************************************************
+*
+* Summary:
+*  End-of-scan interrupt. Stores the sample and hands the block over once
+*  it is full. If the master has not read the previous block yet, the new
+*  block is dropped and the next one delivered is flagged as an overrun.
+*
+*******************************************************************************/
+static void ADC_Isr(void)
+{
+    uint32_t intr_status = Cy_SAR_GetInterruptStatus(ADC_HW);
+    adc_block_t *block = &blocks[fill_index];
+
+    Cy_SAR_ClearInterrupt(ADC_HW, intr_status);
+
+    if (0UL == (intr_status & CY_SAR_INTR_EOS))
+    {
+        return;
+    }
+
+    block->samples[fill_count] = (uint16_t)Cy_SAR_GetResult16(ADC_HW, ADC_STREAM_CHANNEL);
+    fill_count++;
+
+    if (fill_count < ADC_BLOCK_SAMPLES)
+    {
+        return;
+    }
+
+    fill_count = 0UL;
+    block->sequence = next_sequence;
+    next_sequence++;
+
+    if (block_ready)
+    {
+        /* Overwrite this block with the next one */
+        overrun_pending = true;
+    }
+    else
+    {
+        block->flags = overrun_pending ? ADC_FLAG_OVERRUN : 0u;
+        overrun_pending = false;
+        fill_index ^= 1UL;
+        block_ready = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: adc_start
+********************************************************************************
+*
+* Summary:
+*  Starts continuous conversion with an empty double buffer.
+*
+*******************************************************************************/
+static void adc_start(void)
+{
+    fill_count = 0UL;
+    block_ready = false;
+    overrun_pending = false;
+    sampling = true;
+
+    Cy_SAR_StartConvert(ADC_HW, CY_SAR_START_CONVERT_CONTINUOUS);
+}
+
+/*******************************************************************************
+* Function Name: adc_stop
+********************************************************************************
+*
+* Summary:
+*  Stops conversion. A block already complete can still be read.
+*
+*******************************************************************************/
+static void adc_stop(void)
+{
+    Cy_SAR_StopConvert(ADC_HW);
+    sampling = false;
+}
+
+/*******************************************************************************
+* Function Name: adc_read_command
+********************************************************************************
+*
+* Summary:
+*  Returns the complete block, or only the header with ADC_FLAG_NO_DATA if
+*  the block being filled is not complete yet.
+*
+*******************************************************************************/
+static uint32_t adc_read_command(uint8_t const *request, uint32_t length,
+                                 uint8_t *reply, uint32_t *reply_length)
+{
+    adc_block_t const *block;
+    uint8_t *dest = &reply[ADC_BLOCK_HEADER_SIZE];
+    uint32_t index;
+
+    (void) request;
+    (void) length;
+
+    reply[COMMAND_OPCODE_POS] = CMD_ADC_READ;
+
+    if (!block_ready)
+    {
+        reply[1] = (uint8_t)next_sequence;
+        reply[2] = (uint8_t)(next_sequence >> 8u);
+        reply[3] = ADC_FLAG_NO_DATA | (sampling ? 0u : ADC_FLAG_STOPPED);
+        *reply_length = ADC_BLOCK_HEADER_SIZE;
+
+        return COMMAND_SUCCESS;
+    }
+
+    /* The ISR does not touch the ready block until it is released */
+    block = &blocks[fill_index ^ 1UL];
+
+    reply[1] = (uint8_t)block->sequence;
+    reply[2] = (uint8_t)(block->sequence >> 8u);
+    reply[3] = block->flags | (sampling ? 0u : ADC_FLAG_STOPPED);
+
+    for (index = 0UL; index < ADC_BLOCK_SAMPLES; index++)
+    {
+        *dest++ = (uint8_t)block->samples[index];
+        *dest++ = (uint8_t)(block->samples[index] >> 8u);
+    }
+
+    block_ready = false;
+
+    *reply_length = ADC_BLOCK_HEADER_SIZE + (ADC_BLOCK_SAMPLES * 2UL);
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: adc_control_command
+********************************************************************************
+*
+* Summary:
+*  Starts or stops sampling and echoes the opcode.
+*
+*******************************************************************************/
+static uint32_t adc_control_command(uint8_t const *request, uint32_t length,
+                                    uint8_t *reply, uint32_t *reply_length)
+{
+    if (length < (COMMAND_PAYLOAD_POS + 1UL))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    if (0u != request[COMMAND_PAYLOAD_POS])
+    {
+        if (!sampling)
+        {
+            adc_start();
+        }
+    }
+    else
+    {
+        adc_stop();
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_ADC_CONTROL;
+    *reply_length = 1UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: adc_stream_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the SAR ADC from the Device Configurator settings, registers
+*  the stream commands and starts sampling.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t adc_stream_init(void)
+{
+    const cy_stc_sysint_t adc_intr_config =
+    {
+        .intrSrc      = ADC_IRQ,
+        .intrPriority = ADC_INTR_PRIORITY,
+    };
+
+    if (CY_SAR_SUCCESS != Cy_SAR_Init(ADC_HW, &ADC_config))
+    {
+        return INIT_FAILURE;
+    }
+
+    if (CY_SYSINT_SUCCESS != Cy_SysInt_Init(&adc_intr_config, &ADC_Isr))
+    {
+        return INIT_FAILURE;
+    }
+
+    if ((COMMAND_SUCCESS != command_register(CMD_ADC_READ, &adc_read_command, SPI_TX_BULK, ADC_READ_BUDGET_US)) ||
+        (COMMAND_SUCCESS != command_register(CMD_ADC_CONTROL, &adc_control_command, SPI_TX_CONTROL,
+                                               COMMAND_BUDGET_DEFAULT_US)))
+    {
+        return INIT_FAILURE;
+    }
+
+    fill_index = 0UL;
+    next_sequence = 0u;
+
+    Cy_SAR_SetInterruptMask(ADC_HW, CY_SAR_INTR_EOS);
+    NVIC_EnableIRQ(ADC_IRQ);
+    Cy_SAR_Enable(ADC_HW);
+    adc_start();
+
+    return INIT_SUCCESS;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name: AdcStream.h
+*
+* Description: This file contains the function prototypes for the ADC
+*              sample stream read over the SPI link.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_ADCSTREAM_H_
+#define SOURCE_ADCSTREAM_H_
+
+#include "cy_pdl.h"
+#include "cycfg.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Continuous SAR ADC sampling into a double buffer, read by the master in
+ * blocks. The SAR block must be enabled in the Device Configurator with the
+ * alias ADC, set for continuous conversion with the end-of-scan interrupt;
+ * its clock and sample time set the sample rate. */
+#ifndef ADC_STREAM
+#define ADC_STREAM              (0u)
+#endif
+
+#if (ADC_STREAM != 0u)
+#if (SPI_FRAMING != SPI_FRAMING_COBS)
+#error "The ADC stream requires SPI_FRAMING_COBS"
+#endif
+#if (!defined(CY_IP_M0S8PASS4A) || !defined(ADC_HW))
+#error "The ADC stream requires the SAR ADC enabled with the alias ADC"
+#endif
+#endif
+
+/* SAR channel streamed */
+#define ADC_STREAM_CHANNEL      (0u)
+
+/* Opcodes */
+#define CMD_ADC_READ            (0x20u) /* Read the oldest complete block */
+#define CMD_ADC_CONTROL         (0x21u) /* Payload 1 starts, 0 stops sampling */
+
+/* Execution budget of the block read handler */
+#define ADC_READ_BUDGET_US      (50u)
+
+/* Block read reply: opcode, 16-bit sequence number, flags, then the
+ * samples as 16-bit little-endian values */
+#define ADC_BLOCK_HEADER_SIZE   (4u)
+#define ADC_BLOCK_SAMPLES       ((SPI_FRAME_MAX_SIZE - ADC_BLOCK_HEADER_SIZE) / 2u)
+
+/* Block flags */
+#define ADC_FLAG_OVERRUN        (0x01u) /* Blocks were lost before this one */
+#define ADC_FLAG_NO_DATA        (0x02u) /* No complete block, no samples */
+#define ADC_FLAG_STOPPED        (0x04u) /* Sampling is stopped */
+
+/* SAR interrupt priority, same as the SPI so neither preempts the other */
+#define ADC_INTR_PRIORITY       (3u)
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (ADC_STREAM != 0u)
+uint32_t adc_stream_init(void);
+#endif
+
+#endif
@@ -0,0 +1,326 @@
+/******************************************************************************
+* File Name: Benchmark.c
+*
+* Description: This file contains the on-target benchmark of the SPI slave
+*              hot paths, reported in CPU cycles per frame.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Benchmark.h"
+#include "Cobs.h"
+#include "Command.h"
+#include "Kernels.h"
+#include "RingBuffer.h"
+#include "SysTimer.h"
+#include "ChaCha.h"
+
+#if (BENCHMARK != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Request frame measured: an echo request of the largest size */
+#define BENCHMARK_FRAME_SIZE    (SPI_FRAME_MAX_SIZE - ECHO_HEADER_SIZE + COMMAND_PAYLOAD_POS)
+
+/* Ring used for the RX paths, large enough for one encoded frame */
+#define BENCHMARK_RING_SIZE     (64u)
+
+#if ((COBS_ENCODED_MAX(BENCHMARK_FRAME_SIZE) + 1u) > BENCHMARK_RING_SIZE)
+#error "BENCHMARK_RING_SIZE is too small for one encoded frame"
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t bench_request[BENCHMARK_FRAME_SIZE];
+static uint8_t bench_encoded[COBS_ENCODED_MAX(SPI_FRAME_MAX_SIZE) + 1u];
+static uint32_t bench_encoded_size;
+static uint8_t bench_reply[SPI_FRAME_MAX_SIZE];
+static uint32_t bench_reply_size;
+static uint8_t bench_decoded[SPI_FRAME_MAX_SIZE];
+static uint8_t bench_ring_storage[BENCHMARK_RING_SIZE];
+static ring_buffer_t bench_ring;
+static cobs_decoder_t bench_decoder;
+
+/* Keeps the CRC from being optimised away */
+static volatile uint32_t bench_sink;
+
+#if (SPI_CRYPT != 0u)
+/* Keystream of the encryption paths, apart from the link session */
+static const uint8_t bench_zero_key[CHACHA_KEY_SIZE] = {0u};
+static chacha_key_t bench_key;
+static uint32_t bench_counter;
+static uint8_t bench_slice[SPI_FRAME_MAX_SIZE];
+static uint8_t bench_sealed[SPI_FRAME_MAX_SIZE + SPI_CRYPT_OVERHEAD];
+#endif
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void run_path(uint32_t);
+static uint32_t benchmark_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/*******************************************************************************
+* Function Name: run_path
+********************************************************************************
+*
+* Summary:
+*  Processes the benchmark frame once through one path.
+*
+*******************************************************************************/
+static void run_path(uint32_t path)
+{
+    uint32_t index;
+    uint8_t byte;
+
+    switch (path)
+    {
+        case BENCHMARK_RX_RING_PUT:
+            ring_buffer_clear(&bench_ring);
+            for (index = 0UL; index < bench_encoded_size; index++)
+            {
+                (void) ring_buffer_put(&bench_ring, bench_encoded[index]);
+            }
+            break;
+
+        case BENCHMARK_RX_PARSE:
+            while (ring_buffer_get(&bench_ring, &byte))
+            {
+                (void) cobs_decode_byte(&bench_decoder, byte);
+            }
+            break;
+
+        case BENCHMARK_DISPATCH:
+            (void) command_dispatch(bench_request, BENCHMARK_FRAME_SIZE, bench_reply, &bench_reply_size);
+            break;
+
+        case BENCHMARK_TX_ENCODE:
+            (void) cobs_encode(bench_reply, bench_reply_size, bench_encoded);
+            break;
+
+#if (SPI_CRYPT != 0u)
+        case BENCHMARK_CRYPT_XOR:
+            /* As spi_crypt_encrypt() once the slice is ready */
+            kernel_copy(&bench_sealed[SPI_CRYPT_DATA_POS], bench_reply, bench_reply_size);
+            kernel_xor(&bench_sealed[SPI_CRYPT_DATA_POS], bench_slice, bench_reply_size);
+            break;
+
+        case BENCHMARK_KEYSTREAM:
+            chacha_block(&bench_key, bench_counter++, bench_slice, SPI_FRAME_MAX_SIZE);
+            break;
+#endif
+
+        default:
+            bench_sink = kernel_crc32(KERNEL_CRC32_INIT, bench_request, BENCHMARK_FRAME_SIZE);
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: benchmark_command
+********************************************************************************
+*
+* Summary:
+*  Runs the benchmark and returns the clock and the cycles of the paths
+*  from the first one requested, as many as fit in the reply.
+*
+*******************************************************************************/
+static uint32_t benchmark_command(uint8_t const *request, uint32_t length,
+                                  uint8_t *reply, uint32_t *reply_length)
+{
+    uint32_t cycles[BENCHMARK_PATHS];
+    uint32_t runs = BENCHMARK_RUNS;
+    uint32_t pos = BENCHMARK_HEADER_SIZE;
+    uint32_t first = 0UL;
+    uint32_t last;
+    uint32_t path;
+
+    if (length > COMMAND_PAYLOAD_POS)
+    {
+        runs = request[COMMAND_PAYLOAD_POS];
+        if ((0UL == runs) || (runs > BENCHMARK_RUNS_MAX))
+        {
+            return COMMAND_FAILURE;
+        }
+    }
+
+    if (length > (COMMAND_PAYLOAD_POS + 1u))
+    {
+        first = request[COMMAND_PAYLOAD_POS + 1u];
+        if (first >= BENCHMARK_PATHS)
+        {
+            return COMMAND_FAILURE;
+        }
+    }
+
+    last = first + BENCHMARK_PATHS_PER_REPLY;
+    if (last > BENCHMARK_PATHS)
+    {
+        last = BENCHMARK_PATHS;
+    }
+
+    benchmark_run(runs, cycles);
+
+    reply[COMMAND_OPCODE_POS] = CMD_BENCHMARK;
+    reply[1] = (uint8_t)(last - first);
+    reply[2] = (uint8_t)SystemCoreClock;
+    reply[3] = (uint8_t)(SystemCoreClock >> 8u);
+    reply[4] = (uint8_t)(SystemCoreClock >> 16u);
+    reply[5] = (uint8_t)(SystemCoreClock >> 24u);
+    for (path = first; path < last; path++)
+    {
+        reply[pos++] = (uint8_t)cycles[path];
+        reply[pos++] = (uint8_t)(cycles[path] >> 8u);
+        reply[pos++] = (uint8_t)(cycles[path] >> 16u);
+        reply[pos++] = (uint8_t)(cycles[path] >> 24u);
+    }
+    *reply_length = pos;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: benchmark_init
+********************************************************************************
+*
+* Summary:
+*  Builds the benchmark frame and registers the benchmark command. The
+*  command runs well beyond the usual handler budgets, so it has none.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t benchmark_init(void)
+{
+    uint32_t index;
+
+    bench_request[COMMAND_OPCODE_POS] = CMD_ECHO;
+    for (index = COMMAND_PAYLOAD_POS; index < BENCHMARK_FRAME_SIZE; index++)
+    {
+        /* Includes zero bytes, so the encoder splits blocks */
+        bench_request[index] = (uint8_t)(index * 37u);
+    }
+
+    ring_buffer_init(&bench_ring, bench_ring_storage, BENCHMARK_RING_SIZE);
+    cobs_decoder_init(&bench_decoder, bench_decoded, SPI_FRAME_MAX_SIZE);
+#if (SPI_CRYPT != 0u)
+    chacha_init(&bench_key, bench_zero_key, bench_zero_key);
+#endif
+
+    if (COMMAND_SUCCESS != command_register(CMD_BENCHMARK, &benchmark_command, SPI_TX_CONTROL, 0UL))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: benchmark_run
+********************************************************************************
+*
+* Summary:
+*  Measures the cycles each path takes for one frame. The paths run in
+*  pipeline order, so each one works on the output of the previous one,
+*  and the fastest of the runs is kept: interrupts stay enabled, and a run
+*  that an interrupt lands in is slower. The cost of reading the timer is
+*  subtracted. The echo requests show up in the command profile. The
+*  fastest and slowest SPI interrupt entries since the previous call are
+*  taken from the link, which starts timing them again.
+*
+* Parameters:
+*  (uint32_t) runs - Runs of each path
+*  (uint32_t *) cycles - Cycles per frame or per interrupt entry of each
+*                        path, BENCHMARK_PATHS entries
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void benchmark_run(uint32_t runs, uint32_t *cycles)
+{
+    uint32_t overhead = UINT32_MAX;
+    uint32_t start;
+    uint32_t elapsed;
+    uint32_t path;
+    uint32_t run;
+
+    for (run = 0UL; run < runs; run++)
+    {
+        start = systimer_get_cycles();
+        elapsed = systimer_get_cycles() - start;
+        overhead = (elapsed < overhead) ? elapsed : overhead;
+    }
+
+    for (path = 0UL; path < BENCHMARK_PATHS; path++)
+    {
+        cycles[path] = UINT32_MAX;
+    }
+
+    for (run = 0UL; run < runs; run++)
+    {
+        /* Encoded request, as the RX paths receive it */
+        bench_encoded_size = cobs_encode(bench_request, BENCHMARK_FRAME_SIZE, bench_encoded);
+        bench_encoded[bench_encoded_size++] = COBS_DELIMITER;
+
+        for (path = 0UL; path < BENCHMARK_PATHS; path++)
+        {
+            if ((BENCHMARK_ISR_MIN == path) || (BENCHMARK_ISR_MAX == path))
+            {
+                continue;
+            }
+
+            start = systimer_get_cycles();
+            run_path(path);
+            elapsed = systimer_get_cycles() - start;
+            elapsed = (elapsed > overhead) ? (elapsed - overhead) : 0UL;
+            cycles[path] = (elapsed < cycles[path]) ? elapsed : cycles[path];
+        }
+    }
+
+    /* Each interrupt entry was timed with one pair of timer reads as well */
+    get_isr_cycles(&cycles[BENCHMARK_ISR_MIN], &cycles[BENCHMARK_ISR_MAX]);
+    for (path = BENCHMARK_ISR_MIN; path <= BENCHMARK_ISR_MAX; path++)
+    {
+        cycles[path] = (cycles[path] > overhead) ? (cycles[path] - overhead) : 0UL;
+    }
+}
+
+#endif
+
+/* [] END OF FILE */
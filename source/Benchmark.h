@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name: Benchmark.h
+*
+* Description: This file contains the function prototypes of the on-target
+*              benchmark of the SPI slave hot paths.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_BENCHMARK_H_
+#define SOURCE_BENCHMARK_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+#include "SpiCrypt.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Benchmark of the hot paths, run on request to compare toolchains and
+ * optimisation levels on the target */
+#ifndef BENCHMARK
+#define BENCHMARK               (0u)
+#endif
+
+#if ((BENCHMARK != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "The benchmark requires SPI_FRAMING_COBS"
+#endif
+
+/* Opcode running the benchmark. Optional request bytes set the number of
+ * runs of each path, of which the fastest is reported, and the first path
+ * to report. */
+#define CMD_BENCHMARK           (0x90u)
+#define BENCHMARK_RUNS          (16u)
+#define BENCHMARK_RUNS_MAX      (64u)
+
+/* Paths measured, each for one echo request frame of the largest size.
+ * The SPI interrupt itself is not run by the benchmark: it is timed on
+ * every entry while the link runs, and its fastest and slowest entries
+ * since the previous benchmark request are reported instead. */
+#define BENCHMARK_RX_RING_PUT   (0u)    /* Encoded bytes into an RX ring, without the FIFO reads */
+#define BENCHMARK_RX_PARSE      (1u)    /* RX ring to decoded frame, as in read_frame() */
+#define BENCHMARK_DISPATCH      (2u)    /* Command lookup and echo handler */
+#define BENCHMARK_TX_ENCODE     (3u)    /* COBS encoding of the reply */
+#define BENCHMARK_CRC           (4u)    /* CRC-32 of the request */
+#define BENCHMARK_ISR_MIN       (5u)    /* Fastest SPI interrupt entry, 0 if none */
+#define BENCHMARK_ISR_MAX       (6u)    /* Slowest SPI interrupt entry */
+#if (SPI_CRYPT != 0u)
+#define BENCHMARK_CRYPT_XOR     (7u)    /* Encryption of the reply with a ready keystream slice */
+#define BENCHMARK_KEYSTREAM     (8u)    /* Generation of one keystream slice */
+#define BENCHMARK_PATHS         (9u)
+#else
+#define BENCHMARK_PATHS         (7u)
+#endif
+
+/* Reply: opcode, number of paths in the reply, CPU clock in Hz, then the
+ * cycles per frame (per entry for the interrupt) of each path from the
+ * first one requested, 32-bit little-endian. Paths that do not fit are
+ * read with another request. */
+#define BENCHMARK_HEADER_SIZE   (6u)
+#define BENCHMARK_PATHS_PER_REPLY ((SPI_FRAME_MAX_SIZE - BENCHMARK_HEADER_SIZE) / 4u)
+#define BENCHMARK_REPLY_SIZE    (BENCHMARK_HEADER_SIZE + (BENCHMARK_PATHS_PER_REPLY * 4u))
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (BENCHMARK != 0u)
+uint32_t benchmark_init(void);
+void benchmark_run(uint32_t, uint32_t *);
+#endif
+
+#endif
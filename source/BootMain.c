@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name: BootMain.c
+*
+* Description: This file contains the main function of the boot stage of the
+*              dual-slot (A/B) firmware images, built with DUAL_SLOT_BOOT.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "cy_pdl.h"
+#include "DualSlotBoot.h"
+
+#if (DUAL_SLOT_BOOT != 0u)
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+*
+* Summary:
+*  Starts the image of the slot selected from the metadata. The stack
+*  pointer and the reset handler are taken from the vector table at the
+*  start of the slot; the startup code of the image then copies its own
+*  vector table to RAM, as on every boot. An erased or corrupted slot,
+*  whose reset handler is not inside the slot, is not started.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int main(void)
+{
+    uint32_t start = dual_slot_boot_select();
+    uint32_t const *vectors = (uint32_t const *)start;
+
+    if ((vectors[1] > start) && (vectors[1] < (start + DUAL_SLOT_SIZE)))
+    {
+        __set_MSP(vectors[0]);
+        ((void (*)(void))vectors[1])();
+    }
+
+    for (;;)
+    {
+    }
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,189 @@
+/******************************************************************************
+* File Name: ChaCha.c
+*
+* Description: This file contains the ChaCha block function, which generates
+*              the keystream of the SPI payload encryption.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "ChaCha.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* "expand 32-byte k" */
+#define CHACHA_CONST0           (0x61707865UL)
+#define CHACHA_CONST1           (0x3320646EUL)
+#define CHACHA_CONST2           (0x79622D32UL)
+#define CHACHA_CONST3           (0x6B206574UL)
+
+#define ROTL32(v, n)            (((v) << (n)) | ((v) >> (32u - (n))))
+
+#define QUARTER_ROUND(a, b, c, d)               \
+    do                                          \
+    {                                           \
+        (a) += (b); (d) ^= (a); (d) = ROTL32((d), 16u); \
+        (c) += (d); (b) ^= (c); (b) = ROTL32((b), 12u); \
+        (a) += (b); (d) ^= (a); (d) = ROTL32((d), 8u);  \
+        (c) += (d); (b) ^= (c); (b) = ROTL32((b), 7u);  \
+    } while (0)
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t get_le32(uint8_t const *);
+
+/*******************************************************************************
+* Function Name: get_le32
+********************************************************************************
+*
+* Summary:
+*  Reads a 32-bit little-endian value from any alignment.
+*
+*******************************************************************************/
+static uint32_t get_le32(uint8_t const *source)
+{
+    return (uint32_t)source[0] | ((uint32_t)source[1] << 8u) |
+           ((uint32_t)source[2] << 16u) | ((uint32_t)source[3] << 24u);
+}
+
+/*******************************************************************************
+* Function Name: chacha_init
+********************************************************************************
+*
+* Summary:
+*  Loads a key and a nonce.
+*
+* Parameters:
+*  (chacha_key_t *) ctx - Key state
+*  (uint8_t const *) key - CHACHA_KEY_SIZE bytes
+*  (uint8_t const *) nonce - CHACHA_NONCE_SIZE bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void chacha_init(chacha_key_t *ctx, uint8_t const *key, uint8_t const *nonce)
+{
+    uint32_t index;
+
+    for (index = 0UL; index < (CHACHA_KEY_SIZE / 4u); index++)
+    {
+        ctx->key[index] = get_le32(&key[4u * index]);
+    }
+    for (index = 0UL; index < (CHACHA_NONCE_SIZE / 4u); index++)
+    {
+        ctx->nonce[index] = get_le32(&nonce[4u * index]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: chacha_block
+********************************************************************************
+*
+* Summary:
+*  Generates the keystream block of a counter value. Only the first length
+*  bytes are stored, so a caller needing less than a block does not have
+*  to keep a 64-byte buffer.
+*
+* Parameters:
+*  (chacha_key_t const *) ctx - Key state
+*  (uint32_t) counter - Block counter
+*  (uint8_t *) out - Keystream
+*  (uint32_t) length - Bytes to store, at most CHACHA_BLOCK_SIZE
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void chacha_block(chacha_key_t const *ctx, uint32_t counter, uint8_t *out, uint32_t length)
+{
+    uint32_t x0 = CHACHA_CONST0, x1 = CHACHA_CONST1, x2 = CHACHA_CONST2, x3 = CHACHA_CONST3;
+    uint32_t x4 = ctx->key[0], x5 = ctx->key[1], x6 = ctx->key[2], x7 = ctx->key[3];
+    uint32_t x8 = ctx->key[4], x9 = ctx->key[5], x10 = ctx->key[6], x11 = ctx->key[7];
+    uint32_t x12 = counter, x13 = ctx->nonce[0], x14 = ctx->nonce[1], x15 = ctx->nonce[2];
+    uint32_t index;
+    uint32_t round;
+
+    for (round = 0UL; round < CHACHA_ROUNDS; round += 2UL)
+    {
+        /* Column round */
+        QUARTER_ROUND(x0, x4, x8, x12);
+        QUARTER_ROUND(x1, x5, x9, x13);
+        QUARTER_ROUND(x2, x6, x10, x14);
+        QUARTER_ROUND(x3, x7, x11, x15);
+        /* Diagonal round */
+        QUARTER_ROUND(x0, x5, x10, x15);
+        QUARTER_ROUND(x1, x6, x11, x12);
+        QUARTER_ROUND(x2, x7, x8, x13);
+        QUARTER_ROUND(x3, x4, x9, x14);
+    }
+
+    /* Feed-forward of the input */
+    x0 += CHACHA_CONST0;
+    x1 += CHACHA_CONST1;
+    x2 += CHACHA_CONST2;
+    x3 += CHACHA_CONST3;
+    x4 += ctx->key[0];
+    x5 += ctx->key[1];
+    x6 += ctx->key[2];
+    x7 += ctx->key[3];
+    x8 += ctx->key[4];
+    x9 += ctx->key[5];
+    x10 += ctx->key[6];
+    x11 += ctx->key[7];
+    x12 += counter;
+    x13 += ctx->nonce[0];
+    x14 += ctx->nonce[1];
+    x15 += ctx->nonce[2];
+
+    {
+        uint32_t const words[CHACHA_BLOCK_SIZE / 4u] =
+        {
+            x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15
+        };
+
+        if (length > CHACHA_BLOCK_SIZE)
+        {
+            length = CHACHA_BLOCK_SIZE;
+        }
+
+        for (index = 0UL; index < length; index++)
+        {
+            out[index] = (uint8_t)(words[index >> 2u] >> (8u * (index & 3u)));
+        }
+    }
+}
+
+/* [] END OF FILE */
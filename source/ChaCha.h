@@ -0,0 +1,79 @@
+/******************************************************************************
+* File Name: ChaCha.h
+*
+* Description: This file contains the function prototypes of the ChaCha
+*              stream cipher block function.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_CHACHA_H_
+#define SOURCE_CHACHA_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Rounds: 8 (ChaCha8), 12 or 20. Both ends of the link must agree. */
+#ifndef CHACHA_ROUNDS
+#define CHACHA_ROUNDS           (8u)
+#endif
+
+#if ((CHACHA_ROUNDS != 8u) && (CHACHA_ROUNDS != 12u) && (CHACHA_ROUNDS != 20u))
+#error "CHACHA_ROUNDS must be 8u, 12u or 20u"
+#endif
+
+#define CHACHA_KEY_SIZE         (32u)
+#define CHACHA_NONCE_SIZE       (12u)
+#define CHACHA_BLOCK_SIZE       (64u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Key and nonce, loaded once as words. Each block adds a 32-bit counter,
+ * as in RFC 8439. */
+typedef struct
+{
+    uint32_t key[CHACHA_KEY_SIZE / 4u];
+    uint32_t nonce[CHACHA_NONCE_SIZE / 4u];
+} chacha_key_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+void chacha_init(chacha_key_t *, uint8_t const *, uint8_t const *);
+void chacha_block(chacha_key_t const *, uint32_t, uint8_t *, uint32_t);
+
+#endif
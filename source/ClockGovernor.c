@@ -0,0 +1,296 @@
+/******************************************************************************
+* File Name: ClockGovernor.c
+*
+* Description: This file contains function definitions for the
+*              load-aware system clock governor.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "ClockGovernor.h"
+#include "SpiSlave.h"
+#include "SysTimer.h"
+#include "CritSection.h"
+#include "Command.h"
+
+#if (CLOCK_GOVERNOR != 0u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static volatile uint32_t clock_level;
+
+/* Time of the last SPI activity, or of the last step down */
+static volatile uint32_t last_activity_ms;
+
+/* Start of the current residency interval */
+static uint32_t level_since_ms;
+
+static clock_governor_stats_t governor_stats;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void set_clock_level(uint32_t);
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+static uint32_t clock_stats_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+#endif
+
+/*******************************************************************************
+* Function Name: set_clock_level
+********************************************************************************
+*
+* Summary:
+*  Changes the HFCLK divider and the SCB clock divider together. The order
+*  keeps the SCB clock at or above its nominal rate in between, which the
+*  slave tolerates: when raising, HFCLK goes up first; when lowering, the
+*  SCB divider goes down first. Flash wait states are left as configured
+*  for full speed. The system timer is rescaled to the new CPU clock.
+*
+*******************************************************************************/
+static void set_clock_level(uint32_t level)
+{
+    crit_state_t crit_state;
+    uint32_t start_us;
+    uint32_t now_ms;
+    uint32_t scb_divider = ((CLOCK_GOVERNOR_SCB_DIVIDER + 1UL) >> level) - 1UL;
+
+    CRIT_SECTION_ENTER(crit_state);
+
+    if (level != clock_level)
+    {
+        start_us = systimer_get_us();
+        now_ms = systimer_get_ms();
+
+        governor_stats.residency_ms[clock_level] += now_ms - level_since_ms;
+        level_since_ms = now_ms;
+
+        if (level < clock_level)
+        {
+            (void) Cy_SysClk_ClkHfSetDivider((cy_en_sysclk_dividers_t)level);
+            (void) Cy_SysClk_PeriphSetDivider(sSPI_CLK_DIV_HW, sSPI_CLK_DIV_NUM, scb_divider);
+        }
+        else
+        {
+            (void) Cy_SysClk_PeriphSetDivider(sSPI_CLK_DIV_HW, sSPI_CLK_DIV_NUM, scb_divider);
+            (void) Cy_SysClk_ClkHfSetDivider((cy_en_sysclk_dividers_t)level);
+        }
+
+        SystemCoreClockUpdate();
+        systimer_update_clock();
+
+        clock_level = level;
+        governor_stats.transitions++;
+        governor_stats.last_latency_us = systimer_get_us() - start_us;
+        if (governor_stats.last_latency_us > governor_stats.max_latency_us)
+        {
+            governor_stats.max_latency_us = governor_stats.last_latency_us;
+        }
+    }
+
+    CRIT_SECTION_EXIT(crit_state);
+}
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/*******************************************************************************
+* Function Name: clock_stats_command
+********************************************************************************
+*
+* Summary:
+*  Returns the level, the transition and boost counts, the longest
+*  transition in microseconds and the residency of each level in
+*  milliseconds, all 32-bit little-endian except the level byte.
+*
+*******************************************************************************/
+static uint32_t clock_stats_command(uint8_t const *request, uint32_t length,
+                                    uint8_t *reply, uint32_t *reply_length)
+{
+    clock_governor_stats_t stats;
+    uint32_t values[3u + CLOCK_LEVELS];
+    uint32_t pos = 2UL;
+    uint32_t index;
+
+    (void) request;
+    (void) length;
+
+    clock_governor_get_stats(&stats);
+
+    values[0] = stats.transitions;
+    values[1] = stats.boosts;
+    values[2] = stats.max_latency_us;
+    for (index = 0UL; index < CLOCK_LEVELS; index++)
+    {
+        values[3UL + index] = stats.residency_ms[index];
+    }
+
+    if ((pos + sizeof(values)) > SPI_FRAME_MAX_SIZE)
+    {
+        return COMMAND_FAILURE;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_CLOCK_STATS;
+    reply[1] = (uint8_t)stats.level;
+    for (index = 0UL; index < CY_ARRAY_SIZE(values); index++)
+    {
+        reply[pos++] = (uint8_t)values[index];
+        reply[pos++] = (uint8_t)(values[index] >> 8u);
+        reply[pos++] = (uint8_t)(values[index] >> 16u);
+        reply[pos++] = (uint8_t)(values[index] >> 24u);
+    }
+    *reply_length = pos;
+
+    return COMMAND_SUCCESS;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: clock_governor_init
+********************************************************************************
+*
+* Summary:
+*  Starts the governor at full speed. With COBS framing it also registers
+*  the statistics command, so it must be called after command_init().
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void clock_governor_init(void)
+{
+    clock_level = CLOCK_LEVEL_FULL;
+    last_activity_ms = systimer_get_ms();
+    level_since_ms = last_activity_ms;
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    (void) command_register(CMD_CLOCK_STATS, &clock_stats_command, SPI_TX_CONTROL,
+                            COMMAND_BUDGET_DEFAULT_US);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_activity
+********************************************************************************
+*
+* Summary:
+*  Called from the SPI interrupt when the link carries data. Restores full
+*  speed at once: the RX FIFO holds the first bytes of a burst while the
+*  clock is raised, so the burst is handled at full speed.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void clock_governor_activity(void)
+{
+    last_activity_ms = systimer_get_ms();
+
+    if (CLOCK_LEVEL_FULL != clock_level)
+    {
+        set_clock_level(CLOCK_LEVEL_FULL);
+        governor_stats.boosts++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_poll
+********************************************************************************
+*
+* Summary:
+*  Called while the application waits for the link. After
+*  CLOCK_GOVERNOR_IDLE_MS without SPI activity the clock is lowered by one
+*  level, down to CLOCK_LEVEL_MIN.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void clock_governor_poll(void)
+{
+    uint32_t now_ms = systimer_get_ms();
+    crit_state_t crit_state;
+
+    if (((now_ms - last_activity_ms) < CLOCK_GOVERNOR_IDLE_MS) || (CLOCK_LEVEL_MIN == clock_level))
+    {
+        return;
+    }
+
+    /* Checked again with the SPI interrupt masked, so a boost in between
+     * is not undone */
+    CRIT_SECTION_ENTER(crit_state);
+    if ((now_ms - last_activity_ms) >= CLOCK_GOVERNOR_IDLE_MS)
+    {
+        set_clock_level(clock_level + 1UL);
+        last_activity_ms = now_ms;
+    }
+    CRIT_SECTION_EXIT(crit_state);
+}
+
+/*******************************************************************************
+* Function Name: clock_governor_get_stats
+********************************************************************************
+*
+* Summary:
+*  Returns a copy of the governor statistics, with the residency of the
+*  current level counted up to now. The energy per frame can be estimated
+*  from the residency, the datasheet current at each clock and the frame
+*  count of the link statistics.
+*
+* Parameters:
+*  (clock_governor_stats_t *) stats - Location to store the statistics
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void clock_governor_get_stats(clock_governor_stats_t *stats)
+{
+    crit_state_t crit_state;
+
+    CRIT_SECTION_ENTER(crit_state);
+    *stats = governor_stats;
+    stats->level = clock_level;
+    stats->residency_ms[clock_level] += systimer_get_ms() - level_since_ms;
+    CRIT_SECTION_EXIT(crit_state);
+}
+
+#endif
+
+/* [] END OF FILE */
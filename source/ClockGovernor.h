@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name: ClockGovernor.h
+*
+* Description: This file contains the function prototypes for the
+*              load-aware system clock governor.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_CLOCKGOVERNOR_H_
+#define SOURCE_CLOCKGOVERNOR_H_
+
+#include "cy_pdl.h"
+#include "cycfg.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Lowers HFCLK while the SPI link is idle and restores it on the first SPI
+ * interrupt. The SCB clock divider is adjusted with HFCLK, so the SCB clock
+ * and the link rate do not change. */
+#ifndef CLOCK_GOVERNOR
+#define CLOCK_GOVERNOR          (0u)
+#endif
+
+/* Clock levels: HFCLK is the IMO divided by 2^level */
+#define CLOCK_LEVEL_FULL        (0u)
+#define CLOCK_LEVEL_MIN         (3u)    /* Lowest clock, IMO / 8 */
+#define CLOCK_LEVELS            (CLOCK_LEVEL_MIN + 1u)
+
+/* SCB clock divider value at full speed, the intDivider of sSPI_CLK_DIV in
+ * the Device Configurator (divide by 8) */
+#define CLOCK_GOVERNOR_SCB_DIVIDER (7u)
+
+#if (((CLOCK_GOVERNOR_SCB_DIVIDER + 1u) % (1u << CLOCK_LEVEL_MIN)) != 0u)
+#error "The SCB clock divider must be divisible by the lowest HFCLK divider"
+#endif
+
+/* Time without SPI activity before the clock is lowered by one level */
+#define CLOCK_GOVERNOR_IDLE_MS  (20u)
+
+/* Opcode returning the governor statistics, with COBS framing */
+#define CMD_CLOCK_STATS         (0x50u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t level;                     /* Current clock level */
+    uint32_t transitions;               /* Level changes */
+    uint32_t boosts;                    /* Returns to full speed on activity */
+    uint32_t last_latency_us;           /* Duration of the last change */
+    uint32_t max_latency_us;            /* Longest change */
+    uint32_t residency_ms[CLOCK_LEVELS]; /* Time spent at each level */
+} clock_governor_stats_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (CLOCK_GOVERNOR != 0u)
+void clock_governor_init(void);
+void clock_governor_activity(void);
+void clock_governor_poll(void);
+void clock_governor_get_stats(clock_governor_stats_t *);
+#endif
+
+#endif
@@ -0,0 +1,222 @@
+/******************************************************************************
+* File Name: Cobs.c
+*
+* Description: This file contains function definitions for COBS framing.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Cobs.h"
+
+
+/*******************************************************************************
+* Function Name: cobs_decoder_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the incremental decoder and attaches the frame storage.
+*
+* Parameters:
+*  - (cobs_decoder_t *) decoder - Decoder state
+*  - (uint8_t *) frame - Storage for the decoded frame
+*  - (uint32_t) size - Size of the frame storage
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void cobs_decoder_init(cobs_decoder_t *decoder, uint8_t *frame, uint32_t size)
+{
+    decoder->frame = frame;
+    decoder->size = size;
+    decoder->length = 0u;
+    decoder->remaining = 0u;
+    decoder->zero_pending = false;
+    decoder->started = false;
+    decoder->discard = false;
+}
+
+/*******************************************************************************
+* Function Name: cobs_decoder_resync
+********************************************************************************
+*
+* Summary:
+*  Drops the frame in progress. All bytes up to and including the next
+*  delimiter are ignored, after which decoding restarts on a frame boundary.
+*
+* Parameters:
+*  - (cobs_decoder_t *) decoder - Decoder state
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void cobs_decoder_resync(cobs_decoder_t *decoder)
+{
+    decoder->length = 0u;
+    decoder->remaining = 0u;
+    decoder->zero_pending = false;
+    decoder->started = false;
+    decoder->discard = true;
+}
+
+/*******************************************************************************
+* Function Name: cobs_decode_byte
+********************************************************************************
+*
+* Summary:
+*  Feeds one received byte to the decoder. Empty frames (back-to-back
+*  delimiters, as sent while the link is idle) are skipped silently.
+*
+* Parameters:
+*  - (cobs_decoder_t *) decoder - Decoder state
+*  - (uint8_t) byte - Received byte
+*
+* Return:
+*  (uint32_t) COBS_DECODE_COMPLETE when a delimiter closes a valid frame,
+*             COBS_DECODE_ERROR when the frame is malformed or too long,
+*             COBS_DECODE_PENDING otherwise
+*
+*******************************************************************************/
+uint32_t cobs_decode_byte(cobs_decoder_t *decoder, uint8_t byte)
+{
+    uint32_t status = COBS_DECODE_PENDING;
+
+    if (byte == COBS_DELIMITER)
+    {
+        if ((!decoder->discard) && decoder->started)
+        {
+            /* A block cut short by the delimiter means bytes were lost */
+            status = (decoder->remaining == 0u) ? COBS_DECODE_COMPLETE : COBS_DECODE_ERROR;
+        }
+
+        decoder->remaining = 0u;
+        decoder->zero_pending = false;
+        decoder->started = false;
+        decoder->discard = false;
+    }
+    else if (decoder->discard)
+    {
+        /* Waiting for the next frame boundary */
+    }
+    else if (decoder->remaining == 0u)
+    {
+        /* Code byte: the previous block, if any, ended with an implied zero */
+        if (!decoder->started)
+        {
+            decoder->length = 0u;
+            decoder->started = true;
+        }
+        else if (decoder->zero_pending)
+        {
+            if (decoder->length >= decoder->size)
+            {
+                cobs_decoder_resync(decoder);
+                return COBS_DECODE_ERROR;
+            }
+            decoder->frame[decoder->length++] = 0u;
+        }
+        else
+        {
+            /* Previous block was a full 254-byte run without a zero */
+        }
+
+        decoder->remaining = (uint8_t)(byte - 1u);
+        decoder->zero_pending = (byte != 0xFFu);
+    }
+    else
+    {
+        /* Data byte */
+        if (decoder->length >= decoder->size)
+        {
+            cobs_decoder_resync(decoder);
+            return COBS_DECODE_ERROR;
+        }
+        decoder->frame[decoder->length++] = byte;
+        decoder->remaining--;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: cobs_encode
+********************************************************************************
+*
+* Summary:
+*  Encodes a frame. The output contains no zero bytes; the caller appends
+*  the COBS_DELIMITER that terminates the frame.
+*
+* Parameters:
+*  - (uint8_t const *) source - Frame to encode
+*  - (uint32_t) length - Length of the frame
+*  - (uint8_t *) encoded - Output, at least COBS_ENCODED_MAX(length) bytes
+*
+* Return:
+*  (uint32_t) Number of encoded bytes written
+*
+*******************************************************************************/
+uint32_t cobs_encode(uint8_t const *source, uint32_t length, uint8_t *encoded)
+{
+    uint32_t code_pos = 0u;
+    uint32_t out = 1u;
+    uint8_t code = 1u;
+    uint32_t index;
+
+    for (index = 0u; index < length; index++)
+    {
+        if (source[index] == 0u)
+        {
+            encoded[code_pos] = code;
+            code_pos = out++;
+            code = 1u;
+        }
+        else
+        {
+            encoded[out++] = source[index];
+            code++;
+
+            if (code == 0xFFu)
+            {
+                encoded[code_pos] = code;
+                code_pos = out++;
+                code = 1u;
+            }
+        }
+    }
+
+    encoded[code_pos] = code;
+
+    return out;
+}
+
+/* [] END OF FILE */
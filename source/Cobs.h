@@ -0,0 +1,86 @@
+/******************************************************************************
+* File Name: Cobs.h
+*
+* Description: This file contains the function prototypes for Consistent
+*              Overhead Byte Stuffing (COBS) framing of the SPI byte stream.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_COBS_H_
+#define SOURCE_COBS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Byte that separates COBS frames. It never appears inside an encoded frame,
+ * so it is also used as the idle fill on the link. */
+#define COBS_DELIMITER          (0x00u)
+
+/* Worst-case encoded size of a frame of the given length (delimiter excluded) */
+#define COBS_ENCODED_MAX(len)   ((len) + ((len) / 254u) + 1u)
+
+/* Decoder status */
+#define COBS_DECODE_PENDING     (0UL)
+#define COBS_DECODE_COMPLETE    (1UL)
+#define COBS_DECODE_ERROR       (2UL)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Incremental decoder state. Bytes are fed one at a time as they arrive; the
+ * decoded frame is built in place in the attached buffer. */
+typedef struct
+{
+    uint8_t *frame;         /* Decoded frame storage */
+    uint32_t size;          /* Size of the frame storage */
+    uint32_t length;        /* Decoded length, valid on COBS_DECODE_COMPLETE */
+    uint8_t remaining;      /* Data bytes left in the current block */
+    bool zero_pending;      /* Previous block ended with an implied zero */
+    bool started;           /* At least one code byte received */
+    bool discard;           /* Drop bytes until the next delimiter */
+} cobs_decoder_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+void cobs_decoder_init(cobs_decoder_t *, uint8_t *, uint32_t);
+void cobs_decoder_resync(cobs_decoder_t *);
+uint32_t cobs_decode_byte(cobs_decoder_t *, uint8_t);
+uint32_t cobs_encode(uint8_t const *, uint32_t, uint8_t *);
+
+#endif
@@ -0,0 +1,486 @@
+/******************************************************************************
+* File Name: Command.c
+*
+* Description: This file contains function definitions for the command
+*              dispatcher and the built-in commands.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <string.h>
+#include "Command.h"
+#include "Kernels.h"
+#include "SysTimer.h"
+#include "DebugLog.h"
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Handlers are timed for the profile and for the budget check */
+#define COMMAND_TIMED           ((COMMAND_PROFILE != 0u) || (COMMAND_BUDGET != 0u))
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t opcode;
+    uint8_t tx_class;
+    command_handler_t handler;
+    uint32_t budget_us;                 /* Zero for no budget */
+} command_entry_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static command_entry_t command_table[COMMAND_TABLE_SIZE];
+static uint32_t command_count;
+
+#if (COMMAND_BUDGET != 0u)
+/* Invocations of any handler over budget */
+static uint32_t command_overruns;
+#endif
+
+#if (COMMAND_PROFILE != 0u)
+/* Profile of each table entry */
+static command_profile_t command_profiles[COMMAND_TABLE_SIZE];
+#endif
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t echo_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static void put_u32(uint8_t *, uint32_t);
+#if (COMMAND_PROFILE != 0u)
+static uint32_t profile_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static void profile_update(command_profile_t *, uint32_t, uint32_t, uint32_t, uint32_t);
+#endif
+#if (COMMAND_BUDGET != 0u)
+static void check_budget(uint32_t, uint32_t);
+#endif
+
+/*******************************************************************************
+* Function Name: put_u32
+********************************************************************************
+*
+* Summary:
+*  Stores a 32-bit value in little-endian order.
+*
+*******************************************************************************/
+static void put_u32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = (uint8_t)value;
+    dest[1] = (uint8_t)(value >> 8u);
+    dest[2] = (uint8_t)(value >> 16u);
+    dest[3] = (uint8_t)(value >> 24u);
+}
+
+/*******************************************************************************
+* Function Name: echo_command
+********************************************************************************
+*
+* Summary:
+*  Returns the request payload with the time the request was received and
+*  the time the reply is handed to the TX path. The master subtracts the
+*  slave turnaround from its round-trip time to get the time on the wire.
+*
+*******************************************************************************/
+static uint32_t echo_command(uint8_t const *request, uint32_t length,
+                             uint8_t *reply, uint32_t *reply_length)
+{
+    uint32_t payload_length = length - COMMAND_PAYLOAD_POS;
+
+    if ((ECHO_HEADER_SIZE + payload_length) > SPI_FRAME_MAX_SIZE)
+    {
+        return COMMAND_FAILURE;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_ECHO;
+    put_u32(&reply[1], get_frame_timestamp());
+    kernel_copy(&reply[ECHO_HEADER_SIZE], &request[COMMAND_PAYLOAD_POS], payload_length);
+
+    /* Taken last, so it includes the time spent building the reply */
+    put_u32(&reply[5], systimer_get_us());
+
+    *reply_length = ECHO_HEADER_SIZE + payload_length;
+
+    return COMMAND_SUCCESS;
+}
+
+#if (COMMAND_BUDGET != 0u)
+/*******************************************************************************
+* Function Name: check_budget
+********************************************************************************
+*
+* Summary:
+*  Compares the time spent in a handler with its budget. An overrun is
+*  counted, traced on the log channel, and stops a debug build with
+*  COMMAND_BUDGET_TRAP.
+*
+*******************************************************************************/
+static void check_budget(uint32_t index, uint32_t cycles)
+{
+    uint32_t elapsed_us;
+
+    if (0UL == command_table[index].budget_us)
+    {
+        return;
+    }
+
+    elapsed_us = systimer_cycles_to_us(cycles);
+    if (elapsed_us <= command_table[index].budget_us)
+    {
+        return;
+    }
+
+    command_overruns++;
+#if (COMMAND_PROFILE != 0u)
+    command_profiles[index].overruns++;
+#endif
+#if (DEBUG_LOG != 0u)
+    debug_log_overrun(command_table[index].opcode, elapsed_us, command_table[index].budget_us);
+#endif
+#if (COMMAND_BUDGET_TRAP != 0u)
+    CY_ASSERT(0u);
+#endif
+}
+#endif
+
+#if (COMMAND_PROFILE != 0u)
+/*******************************************************************************
+* Function Name: profile_update
+********************************************************************************
+*
+* Summary:
+*  Adds one invocation to the profile of an opcode.
+*
+*******************************************************************************/
+static void profile_update(command_profile_t *profile, uint32_t cycles, uint32_t status,
+                           uint32_t bytes_in, uint32_t bytes_out)
+{
+    if ((0UL == profile->count) || (cycles < profile->min_cycles))
+    {
+        profile->min_cycles = cycles;
+    }
+    if (cycles > profile->max_cycles)
+    {
+        profile->max_cycles = cycles;
+    }
+
+    profile->count++;
+    profile->total_cycles += cycles;
+    profile->bytes_in += bytes_in;
+    profile->bytes_out += bytes_out;
+
+    if (status != COMMAND_SUCCESS)
+    {
+        profile->errors++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: profile_command
+********************************************************************************
+*
+* Summary:
+*  Returns the profile of the table entry given in the request. The
+*  master walks the entries from index 0 until the request fails.
+*  PROFILE_RESET_INDEX clears all profiles instead.
+*
+*******************************************************************************/
+static uint32_t profile_command(uint8_t const *request, uint32_t length,
+                                uint8_t *reply, uint32_t *reply_length)
+{
+    command_profile_t profile;
+
+    if ((length > COMMAND_PAYLOAD_POS) && (PROFILE_RESET_INDEX == request[COMMAND_PAYLOAD_POS]))
+    {
+        command_reset_profile();
+        reply[COMMAND_OPCODE_POS] = CMD_PROFILE;
+        reply[1] = PROFILE_RESET_INDEX;
+        *reply_length = 2UL;
+
+        return COMMAND_SUCCESS;
+    }
+
+    if ((length < (COMMAND_PAYLOAD_POS + 1UL)) ||
+        (COMMAND_SUCCESS != command_get_profile(request[COMMAND_PAYLOAD_POS], &profile)))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_PROFILE;
+    reply[1] = request[COMMAND_PAYLOAD_POS];
+    reply[2] = profile.opcode;
+    put_u32(&reply[3], profile.count);
+    put_u32(&reply[7], (profile.total_cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t)profile.total_cycles);
+    put_u32(&reply[11], profile.min_cycles);
+    put_u32(&reply[15], profile.max_cycles);
+    put_u32(&reply[19], profile.errors);
+    put_u32(&reply[23], profile.bytes_in);
+    put_u32(&reply[27], profile.bytes_out);
+    put_u32(&reply[31], profile.overruns);
+    *reply_length = PROFILE_REPLY_SIZE;
+
+    return COMMAND_SUCCESS;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: command_init
+********************************************************************************
+*
+* Summary:
+*  Clears the command table and registers the built-in commands.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void command_init(void)
+{
+    command_count = 0UL;
+
+    (void) command_register(CMD_ECHO, &echo_command, SPI_TX_CONTROL, COMMAND_BUDGET_DEFAULT_US);
+#if (COMMAND_PROFILE != 0u)
+    (void) command_register(CMD_PROFILE, &profile_command, SPI_TX_CONTROL, COMMAND_BUDGET_DEFAULT_US);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: command_register
+********************************************************************************
+*
+* Summary:
+*  Registers the handler of an opcode and the class its replies are sent
+*  in: SPI_TX_CONTROL for replies the master waits on, SPI_TX_BULK for
+*  stream data. The budget is the longest time the handler may take; the
+*  main loop, and with it the RX path, is stalled while it runs.
+*
+* Parameters:
+*  (uint8_t) opcode - Opcode handled
+*  (command_handler_t) handler - Handler function
+*  (uint32_t) tx_class - Class of the replies
+*  (uint32_t) budget_us - Execution budget in microseconds, 0 for none
+*
+* Return:
+*  (uint32_t) COMMAND_SUCCESS, or COMMAND_FAILURE if the opcode is already
+*             registered or the table is full
+*
+*******************************************************************************/
+uint32_t command_register(uint8_t opcode, command_handler_t handler, uint32_t tx_class, uint32_t budget_us)
+{
+    uint32_t index;
+
+    for (index = 0UL; index < command_count; index++)
+    {
+        if (command_table[index].opcode == opcode)
+        {
+            return COMMAND_FAILURE;
+        }
+    }
+
+    if (command_count >= COMMAND_TABLE_SIZE)
+    {
+        return COMMAND_FAILURE;
+    }
+
+    command_table[command_count].opcode = opcode;
+    command_table[command_count].tx_class = (uint8_t)tx_class;
+    command_table[command_count].handler = handler;
+    command_table[command_count].budget_us = budget_us;
+#if (COMMAND_PROFILE != 0u)
+    command_profiles[command_count].opcode = opcode;
+#endif
+    command_count++;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: command_dispatch
+********************************************************************************
+*
+* Summary:
+*  Runs the handler registered for the opcode of a request frame. If there
+*  is none, or the handler fails, the reply is CMD_ERROR followed by the
+*  opcode of the request.
+*
+* Parameters:
+*  (uint8_t const *) request - Request frame
+*  (uint32_t) length - Length of the request, at least one byte
+*  (uint8_t *) reply - Reply frame, SPI_FRAME_MAX_SIZE bytes
+*  (uint32_t *) reply_length - Length of the reply, zero for no reply
+*
+* Return:
+*  (uint32_t) Class to send the reply in, SPI_TX_CONTROL for errors
+*
+*******************************************************************************/
+uint32_t command_dispatch(uint8_t const *request, uint32_t length, uint8_t *reply, uint32_t *reply_length)
+{
+    uint8_t opcode = request[COMMAND_OPCODE_POS];
+    uint32_t status = COMMAND_FAILURE;
+    uint32_t tx_class = SPI_TX_CONTROL;
+    uint32_t index;
+#if COMMAND_TIMED
+    uint32_t start_cycles = 0UL;
+    uint32_t cycles = 0UL;
+#endif
+
+    *reply_length = 0UL;
+
+    for (index = 0UL; index < command_count; index++)
+    {
+        if (command_table[index].opcode == opcode)
+        {
+#if COMMAND_TIMED
+            start_cycles = systimer_get_cycles();
+#endif
+            status = command_table[index].handler(request, length, reply, reply_length);
+#if COMMAND_TIMED
+            cycles = systimer_get_cycles() - start_cycles;
+#endif
+#if (COMMAND_BUDGET != 0u)
+            check_budget(index, cycles);
+#endif
+            tx_class = command_table[index].tx_class;
+            break;
+        }
+    }
+
+    if (status != COMMAND_SUCCESS)
+    {
+        reply[COMMAND_OPCODE_POS] = CMD_ERROR;
+        reply[COMMAND_PAYLOAD_POS] = opcode;
+        *reply_length = 2UL;
+        tx_class = SPI_TX_CONTROL;
+    }
+
+#if (COMMAND_PROFILE != 0u)
+    if (index < command_count)
+    {
+        profile_update(&command_profiles[index], cycles, status, length, *reply_length);
+    }
+#endif
+
+    return tx_class;
+}
+
+
+#if (COMMAND_BUDGET != 0u)
+/*******************************************************************************
+* Function Name: command_get_overruns
+********************************************************************************
+*
+* Summary:
+*  Returns the number of handler invocations that exceeded their budget.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) Overrun count
+*
+*******************************************************************************/
+uint32_t command_get_overruns(void)
+{
+    return command_overruns;
+}
+#endif
+
+#if (COMMAND_PROFILE != 0u)
+/*******************************************************************************
+* Function Name: command_get_profile
+********************************************************************************
+*
+* Summary:
+*  Returns a copy of the profile of a table entry. Entries are in the
+*  order the opcodes were registered.
+*
+* Parameters:
+*  (uint32_t) index - Table entry
+*  (command_profile_t *) profile - Location to store the profile
+*
+* Return:
+*  (uint32_t) COMMAND_SUCCESS, or COMMAND_FAILURE past the last entry
+*
+*******************************************************************************/
+uint32_t command_get_profile(uint32_t index, command_profile_t *profile)
+{
+    if (index >= command_count)
+    {
+        return COMMAND_FAILURE;
+    }
+
+    *profile = command_profiles[index];
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: command_reset_profile
+********************************************************************************
+*
+* Summary:
+*  Clears the profile of every opcode, for example before a measurement
+*  under a given command mix.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void command_reset_profile(void)
+{
+    uint32_t index;
+    uint8_t opcode;
+
+    for (index = 0UL; index < command_count; index++)
+    {
+        opcode = command_profiles[index].opcode;
+        (void) memset(&command_profiles[index], 0, sizeof(command_profile_t));
+        command_profiles[index].opcode = opcode;
+    }
+}
+#endif
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: Command.h
+*
+* Description: This file contains the function prototypes for the command
+*              dispatcher used with COBS framing.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_COMMAND_H_
+#define SOURCE_COMMAND_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Command status */
+#define COMMAND_SUCCESS         (0UL)
+#define COMMAND_FAILURE         (1UL)
+
+/* Opcodes, first byte of a request frame. The LED commands keep the values
+ * of the original packet format, CYBSP_LED_STATE_ON and CYBSP_LED_STATE_OFF
+ * (0x00 and 0x01). */
+#define CMD_ECHO                (0x10u) /* Loopback with slave timestamps */
+#define CMD_ERROR               (0x7Eu) /* Reply to a request that failed */
+
+/* Frame offsets */
+#define COMMAND_OPCODE_POS      (0u)
+#define COMMAND_PAYLOAD_POS     (1u)
+
+/* Echo reply: opcode, receive and transmit timestamps in microseconds,
+ * then the request payload */
+#define ECHO_HEADER_SIZE        (9u)
+
+/* Number of opcodes that can be registered */
+#define COMMAND_TABLE_SIZE      (16u)
+
+/* Execution profile of every registered opcode */
+#ifndef COMMAND_PROFILE
+#define COMMAND_PROFILE         (0u)
+#endif
+
+#if ((COMMAND_PROFILE != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "The command profile requires SPI_FRAMING_COBS"
+#endif
+
+/* Measure every handler invocation against the budget given when its
+ * opcode was registered. Overruns are counted and, with DEBUG_LOG, traced
+ * on the log channel. */
+#ifndef COMMAND_BUDGET
+#define COMMAND_BUDGET          (0u)
+#endif
+
+/* Debug builds: stop at the overrun with CY_ASSERT */
+#ifndef COMMAND_BUDGET_TRAP
+#define COMMAND_BUDGET_TRAP     (0u)
+#endif
+
+/* Budget of short control handlers */
+#define COMMAND_BUDGET_DEFAULT_US (50u)
+
+/* Opcode reading the profile of one table entry. Request: opcode, entry
+ * index, or PROFILE_RESET_INDEX to clear all profiles. Reply: opcode,
+ * entry index, opcode of the entry, then the count, total cycles
+ * (saturated), minimum and maximum cycles, errors, bytes in, bytes out and
+ * budget overruns, 32-bit little-endian. */
+#define CMD_PROFILE             (0x60u)
+#define PROFILE_REPLY_SIZE      (35u)
+#define PROFILE_RESET_INDEX     (0xFFu)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Handles one request frame and builds the reply frame. Returns
+ * COMMAND_SUCCESS, or COMMAND_FAILURE to send a CMD_ERROR reply instead. A
+ * reply length of zero sends no reply. */
+typedef uint32_t (*command_handler_t)(uint8_t const *request, uint32_t length,
+                                      uint8_t *reply, uint32_t *reply_length);
+
+/* Execution profile of one opcode. Cycles are CPU cycles spent in the
+ * handler, measured with the system timer. */
+typedef struct
+{
+    uint8_t opcode;
+    uint32_t count;                     /* Invocations */
+    uint64_t total_cycles;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t errors;                    /* Invocations returning COMMAND_FAILURE */
+    uint32_t bytes_in;                  /* Request bytes */
+    uint32_t bytes_out;                 /* Reply bytes */
+    uint32_t overruns;                  /* Invocations over budget, with COMMAND_BUDGET */
+} command_profile_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+void command_init(void);
+uint32_t command_register(uint8_t, command_handler_t, uint32_t, uint32_t);
+uint32_t command_dispatch(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+#endif
+#if (COMMAND_BUDGET != 0u)
+uint32_t command_get_overruns(void);
+#endif
+#if (COMMAND_PROFILE != 0u)
+uint32_t command_get_profile(uint32_t, command_profile_t *);
+void command_reset_profile(void);
+#endif
+
+#endif
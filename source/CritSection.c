@@ -0,0 +1,206 @@
+/******************************************************************************
+* File Name: CritSection.c
+*
+* Description: This file contains function definitions for the profiled
+*              interrupt-disable regions.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "CritSection.h"
+#include "SysTimer.h"
+
+#if (CRIT_PROFILE != 0u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Sites in order of first use */
+static crit_site_t *first_site;
+static crit_site_t *last_site;
+
+/* Site with the longest masked time seen so far */
+static crit_site_t *longest_site;
+
+/*******************************************************************************
+* Function Name: crit_section_enter
+********************************************************************************
+*
+* Summary:
+*  Masks interrupts and starts timing. Only the outermost section of a
+*  nested group is timed, since the inner ones do not extend the time
+*  interrupts stay masked.
+*
+* Parameters:
+*  - (crit_state_t *) state - Saved state, passed to crit_section_exit()
+*  - (crit_site_t *) site - Statistics of the calling site
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void crit_section_enter(crit_state_t *state, crit_site_t *site)
+{
+    state->intr_state = Cy_SysLib_EnterCriticalSection();
+    state->site = site;
+    state->start_cycles = systimer_get_cycles();
+}
+
+/*******************************************************************************
+* Function Name: crit_section_exit
+********************************************************************************
+*
+* Summary:
+*  Records the masked time against the call site and restores the
+*  interrupt state.
+*
+* Parameters:
+*  - (crit_state_t *) state - State saved by crit_section_enter()
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void crit_section_exit(crit_state_t *state)
+{
+    crit_site_t *site = state->site;
+    uint32_t cycles = systimer_get_cycles() - state->start_cycles;
+
+    if (!site->registered)
+    {
+        site->registered = true;
+
+        if (NULL == last_site)
+        {
+            first_site = site;
+        }
+        else
+        {
+            last_site->next = site;
+        }
+        last_site = site;
+    }
+
+    site->count++;
+
+    /* Interrupts were already masked by the caller: not our time */
+    if (0UL == state->intr_state)
+    {
+        site->total_cycles += cycles;
+
+        if (cycles > site->max_cycles)
+        {
+            site->max_cycles = cycles;
+        }
+
+        if ((NULL == longest_site) || (cycles > longest_site->max_cycles))
+        {
+            longest_site = site;
+        }
+    }
+
+    Cy_SysLib_ExitCriticalSection(state->intr_state);
+}
+
+/*******************************************************************************
+* Function Name: crit_section_first_site
+********************************************************************************
+*
+* Summary:
+*  Returns the first call site seen. The others follow through the next
+*  field.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (crit_site_t const *) First site, or NULL if none has run yet
+*
+*******************************************************************************/
+crit_site_t const *crit_section_first_site(void)
+{
+    return first_site;
+}
+
+/*******************************************************************************
+* Function Name: crit_section_longest_site
+********************************************************************************
+*
+* Summary:
+*  Returns the call site that kept interrupts masked the longest.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (crit_site_t const *) Longest site, or NULL if none has run yet
+*
+*******************************************************************************/
+crit_site_t const *crit_section_longest_site(void)
+{
+    return longest_site;
+}
+
+/*******************************************************************************
+* Function Name: crit_section_reset
+********************************************************************************
+*
+* Summary:
+*  Clears the statistics of all sites, keeping the list of sites.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void crit_section_reset(void)
+{
+    uint32_t intr_state = Cy_SysLib_EnterCriticalSection();
+    crit_site_t *site;
+
+    for (site = first_site; NULL != site; site = site->next)
+    {
+        site->count = 0UL;
+        site->max_cycles = 0UL;
+        site->total_cycles = 0ULL;
+    }
+    longest_site = NULL;
+
+    Cy_SysLib_ExitCriticalSection(intr_state);
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,105 @@
+/******************************************************************************
+* File Name: CritSection.h
+*
+* Description: This file contains the wrappers used for every interrupt-disable
+*              region, with optional profiling of the time spent with
+*              interrupts masked.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_CRITSECTION_H_
+#define SOURCE_CRITSECTION_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Record the longest and cumulative masked time of every call site */
+#ifndef CRIT_PROFILE
+#define CRIT_PROFILE            (0u)
+#endif
+
+#if (CRIT_PROFILE != 0u)
+
+/* Call site statistics, one static instance per CRIT_SECTION_ENTER() */
+typedef struct crit_site
+{
+    char const *file;
+    uint32_t line;
+    uint32_t count;             /* Times entered */
+    uint32_t max_cycles;        /* Longest masked time */
+    uint64_t total_cycles;      /* Cumulative masked time */
+    struct crit_site *next;     /* Next site seen, in order of first use */
+    bool registered;
+} crit_site_t;
+
+typedef struct
+{
+    uint32_t intr_state;
+    uint32_t start_cycles;
+    crit_site_t *site;
+} crit_state_t;
+
+#define CRIT_SECTION_ENTER(state)                                               \
+    do                                                                          \
+    {                                                                           \
+        static crit_site_t crit_site_ = {__FILE__, __LINE__, 0UL, 0UL, 0ULL,    \
+                                         NULL, false};                          \
+        crit_section_enter(&(state), &crit_site_);                              \
+    } while (0)
+
+#define CRIT_SECTION_EXIT(state)    crit_section_exit(&(state))
+
+#else
+
+typedef uint32_t crit_state_t;
+
+#define CRIT_SECTION_ENTER(state)   ((state) = Cy_SysLib_EnterCriticalSection())
+#define CRIT_SECTION_EXIT(state)    Cy_SysLib_ExitCriticalSection(state)
+
+#endif
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (CRIT_PROFILE != 0u)
+void crit_section_enter(crit_state_t *, crit_site_t *);
+void crit_section_exit(crit_state_t *);
+crit_site_t const *crit_section_first_site(void);
+crit_site_t const *crit_section_longest_site(void);
+void crit_section_reset(void);
+#endif
+
+#endif
@@ -0,0 +1,402 @@
+/******************************************************************************
+* File Name: DebugLog.c
+*
+* Description: This file contains function definitions for the debug log
+*              channel.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "DebugLog.h"
+#include "SysTimer.h"
+#include "CritSection.h"
+#include "Command.h"
+#include "StackMonitor.h"
+#include "Format.h"
+
+#if (DEBUG_LOG != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Counters in each snapshot */
+#define SNAPSHOT_COUNTERS       (5u + ((COMMAND_BUDGET != 0u) ? 1u : 0u) + ((STACK_MONITOR != 0u) ? 1u : 0u))
+
+/* Frames queued by each snapshot: the counter records, then the longest
+ * critical section and the profile of one opcode */
+#define SNAPSHOT_FRAMES         (((SNAPSHOT_COUNTERS + DEBUG_LOG_COUNTERS_PER_FRAME - 1u) / DEBUG_LOG_COUNTERS_PER_FRAME) +\
+                                 ((CRIT_PROFILE != 0u) ? 1u : 0u) + ((COMMAND_PROFILE != 0u) ? 1u : 0u))
+
+#if (SNAPSHOT_FRAMES > SPI_TX_LOG_DEPTH)
+#error "A counter snapshot must fit in SPI_TX_LOG_DEPTH log frames"
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Time of the last counter snapshot */
+static uint32_t last_snapshot_ms;
+
+#if (COMMAND_PROFILE != 0u)
+/* Command table entry sent with the next snapshot */
+static uint32_t profile_cursor;
+#endif
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t log_header(uint8_t *, uint8_t);
+static void log_put_u32(uint8_t *, uint32_t);
+static void log_send(uint8_t const *, uint32_t);
+static void log_counters(uint8_t const *, uint32_t const *, uint32_t);
+
+/*******************************************************************************
+* Function Name: log_put_u32
+********************************************************************************
+*
+* Summary:
+*  Stores a 32-bit value in little-endian order.
+*
+*******************************************************************************/
+static void log_put_u32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = (uint8_t)value;
+    dest[1] = (uint8_t)(value >> 8u);
+    dest[2] = (uint8_t)(value >> 16u);
+    dest[3] = (uint8_t)(value >> 24u);
+}
+
+/*******************************************************************************
+* Function Name: log_header
+********************************************************************************
+*
+* Summary:
+*  Fills in the frame identifier, record type and timestamp.
+*
+* Return:
+*  (uint32_t) Length of the header
+*
+*******************************************************************************/
+static uint32_t log_header(uint8_t *frame, uint8_t type)
+{
+    frame[0] = DEBUG_LOG_FRAME_ID;
+    frame[1] = type;
+    log_put_u32(&frame[2], systimer_get_ms());
+
+    return DEBUG_LOG_HEADER_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: log_send
+********************************************************************************
+*
+* Summary:
+*  Queues a record in the log class. If the master has not drained the
+*  channel, the record is dropped and counted in the link statistics.
+*
+*******************************************************************************/
+static void log_send(uint8_t const *frame, uint32_t length)
+{
+    (void) write_class_frame(SPI_TX_LOG, frame, length);
+}
+
+/*******************************************************************************
+* Function Name: log_counters
+********************************************************************************
+*
+* Summary:
+*  Queues counters as few records as possible, DEBUG_LOG_COUNTERS_PER_FRAME
+*  identifier and value pairs in each.
+*
+*******************************************************************************/
+static void log_counters(uint8_t const *ids, uint32_t const *values, uint32_t count)
+{
+    uint8_t frame[SPI_FRAME_MAX_SIZE];
+    uint32_t length = 0UL;
+    uint32_t index;
+
+    for (index = 0UL; index < count; index++)
+    {
+        if (0UL == length)
+        {
+            length = log_header(frame, DEBUG_LOG_COUNTER);
+        }
+
+        frame[length++] = ids[index];
+        log_put_u32(&frame[length], values[index]);
+        length += 4u;
+
+        if (((length + 5u) > SPI_FRAME_MAX_SIZE) || ((index + 1UL) == count))
+        {
+            log_send(frame, length);
+            length = 0UL;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: debug_log_text
+********************************************************************************
+*
+* Summary:
+*  Queues a text record. Text longer than DEBUG_LOG_TEXT_MAX is truncated.
+*  Like the other log functions, it must not be called from an interrupt.
+*
+* Parameters:
+*  (char const *) text - Message, NUL-terminated
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void debug_log_text(char const *text)
+{
+    uint8_t frame[SPI_FRAME_MAX_SIZE];
+    uint32_t length = log_header(frame, DEBUG_LOG_TEXT);
+
+    while ((*text != '\0') && (length < SPI_FRAME_MAX_SIZE))
+    {
+        frame[length++] = (uint8_t)*text++;
+    }
+
+    log_send(frame, length);
+}
+
+/*******************************************************************************
+* Function Name: debug_log_format
+********************************************************************************
+*
+* Summary:
+*  Queues a text record formatted with format(), for example
+*  debug_log_format("ADC overrun %u", count). The text is truncated to
+*  DEBUG_LOG_TEXT_MAX characters.
+*
+* Parameters:
+*  (char const *) fmt - Format string
+*  ... - Arguments
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void debug_log_format(char const *fmt, ...)
+{
+    char text[DEBUG_LOG_TEXT_MAX + 1u];
+    va_list args;
+
+    va_start(args, fmt);
+    (void) format_args(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    debug_log_text(text);
+}
+
+/*******************************************************************************
+* Function Name: debug_log_counter
+********************************************************************************
+*
+* Summary:
+*  Queues a record with a single counter.
+*
+* Parameters:
+*  (uint8_t) id - Counter identifier, one of DEBUG_COUNTER_*
+*  (uint32_t) value - Counter value
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void debug_log_counter(uint8_t id, uint32_t value)
+{
+    log_counters(&id, &value, 1UL);
+}
+
+/*******************************************************************************
+* Function Name: debug_log_overrun
+********************************************************************************
+*
+* Summary:
+*  Queues the trace of a command handler that exceeded its budget.
+*
+* Parameters:
+*  (uint8_t) opcode - Opcode of the handler
+*  (uint32_t) elapsed_us - Time the handler took
+*  (uint32_t) budget_us - Budget of the handler
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void debug_log_overrun(uint8_t opcode, uint32_t elapsed_us, uint32_t budget_us)
+{
+    uint8_t frame[DEBUG_LOG_HEADER_SIZE + 9u];
+    uint32_t length = log_header(frame, DEBUG_LOG_OVERRUN);
+
+    frame[length++] = opcode;
+    log_put_u32(&frame[length], elapsed_us);
+    log_put_u32(&frame[length + 4u], budget_us);
+    length += 8u;
+
+    log_send(frame, length);
+}
+
+/*******************************************************************************
+* Function Name: debug_log_poll
+********************************************************************************
+*
+* Summary:
+*  Periodic work of the log channel, called from the main loop. Once per
+*  DEBUG_LOG_COUNTER_PERIOD_MS, and only while the link is idle, it queues
+*  a snapshot of the link counters and of the longest critical section, in
+*  at most SPI_TX_LOG_DEPTH frames.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void debug_log_poll(void)
+{
+    spi_stream_stats_t stats;
+    uint8_t ids[SNAPSHOT_COUNTERS];
+    uint32_t values[SNAPSHOT_COUNTERS];
+    uint32_t count = 0UL;
+
+    if (((systimer_get_ms() - last_snapshot_ms) < DEBUG_LOG_COUNTER_PERIOD_MS) || (!is_link_idle()))
+    {
+        return;
+    }
+
+    last_snapshot_ms = systimer_get_ms();
+
+    get_stream_stats(&stats);
+    ids[count] = DEBUG_COUNTER_FRAMES;
+    values[count++] = stats.frames;
+    ids[count] = DEBUG_COUNTER_FRAME_ERRORS;
+    values[count++] = stats.frame_errors;
+    ids[count] = DEBUG_COUNTER_RX_OVERFLOWS;
+    values[count++] = stats.rx_overflows;
+    ids[count] = DEBUG_COUNTER_INTERRUPTS;
+    values[count++] = stats.interrupts;
+    ids[count] = DEBUG_COUNTER_LOG_DROPS;
+    values[count++] = stats.tx_drops[SPI_TX_LOG];
+#if (COMMAND_BUDGET != 0u)
+    ids[count] = DEBUG_COUNTER_OVERRUNS;
+    values[count++] = command_get_overruns();
+#endif
+#if (STACK_MONITOR != 0u)
+    {
+        stack_status_t stack;
+
+        stack_monitor_get_status(&stack);
+        ids[count] = DEBUG_COUNTER_STACK_USED;
+        values[count++] = stack.high_water;
+    }
+#endif
+    log_counters(ids, values, count);
+
+#if (CRIT_PROFILE != 0u)
+    {
+        crit_site_t const *site = crit_section_longest_site();
+        uint8_t frame[SPI_FRAME_MAX_SIZE];
+        uint32_t length;
+        char const *name;
+        char const *scan;
+
+        if (NULL != site)
+        {
+            /* Longest masked time and line, then as much of the file
+             * name as fits, without the directory */
+            length = log_header(frame, DEBUG_LOG_CRIT_SITE);
+            log_put_u32(&frame[length], site->max_cycles);
+            length += 4u;
+            frame[length++] = (uint8_t)site->line;
+            frame[length++] = (uint8_t)(site->line >> 8u);
+
+            name = site->file;
+            for (scan = site->file; *scan != '\0'; scan++)
+            {
+                if ((*scan == '/') || (*scan == '\\'))
+                {
+                    name = scan + 1;
+                }
+            }
+
+            while ((*name != '\0') && (length < SPI_FRAME_MAX_SIZE))
+            {
+                frame[length++] = (uint8_t)*name++;
+            }
+
+            log_send(frame, length);
+        }
+    }
+#endif
+
+#if (COMMAND_PROFILE != 0u)
+    {
+        /* One opcode per snapshot, so the log class depth is not exceeded:
+         * opcode, count, total cycles (saturated), maximum cycles, errors */
+        command_profile_t profile;
+        uint8_t frame[DEBUG_LOG_HEADER_SIZE + 17u];
+        uint32_t length;
+
+        if (COMMAND_SUCCESS != command_get_profile(profile_cursor, &profile))
+        {
+            profile_cursor = 0UL;
+        }
+
+        if (COMMAND_SUCCESS == command_get_profile(profile_cursor, &profile))
+        {
+            profile_cursor++;
+
+            length = log_header(frame, DEBUG_LOG_COMMAND);
+            frame[length++] = profile.opcode;
+            log_put_u32(&frame[length], profile.count);
+            log_put_u32(&frame[length + 4u],
+                        (profile.total_cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t)profile.total_cycles);
+            log_put_u32(&frame[length + 8u], profile.max_cycles);
+            log_put_u32(&frame[length + 12u], profile.errors);
+            length += 16u;
+
+            log_send(frame, length);
+        }
+    }
+#endif
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,105 @@
+/******************************************************************************
+* File Name: DebugLog.h
+*
+* Description: This file contains the function prototypes for the debug log
+*              channel multiplexed on the SPI link.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_DEBUGLOG_H_
+#define SOURCE_DEBUGLOG_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Log records and counters sent as log-class frames on the SPI link. This
+ * is the only diagnostic output on PMG1-S0, where the UART and the SPI share
+ * the same SCB. */
+#ifndef DEBUG_LOG
+#define DEBUG_LOG               (0u)
+#endif
+
+#if ((DEBUG_LOG != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "The debug log channel requires SPI_FRAMING_COBS"
+#endif
+
+/* First byte of every log frame, distinguishing the log channel from
+ * replies to commands */
+#define DEBUG_LOG_FRAME_ID      (0x7Fu)
+
+/* Record types, second byte of the frame */
+#define DEBUG_LOG_TEXT          (0x01u) /* Text message */
+#define DEBUG_LOG_COUNTER       (0x02u) /* Counter identifiers and values */
+#define DEBUG_LOG_CRIT_SITE     (0x03u) /* Longest critical section */
+#define DEBUG_LOG_COMMAND       (0x04u) /* Profile of one opcode */
+#define DEBUG_LOG_OVERRUN       (0x05u) /* Handler over its budget */
+
+/* Frame layout: identifier, record type, 32-bit millisecond timestamp */
+#define DEBUG_LOG_HEADER_SIZE   (6u)
+#define DEBUG_LOG_TEXT_MAX      (SPI_FRAME_MAX_SIZE - DEBUG_LOG_HEADER_SIZE)
+
+/* Identifier and value pairs that fit in one counter record */
+#define DEBUG_LOG_COUNTERS_PER_FRAME ((SPI_FRAME_MAX_SIZE - DEBUG_LOG_HEADER_SIZE) / 5u)
+
+#if ((DEBUG_LOG != 0u) && (SPI_FRAME_MAX_SIZE < (DEBUG_LOG_HEADER_SIZE + 5u)))
+#error "SPI_FRAME_MAX_SIZE must hold one counter record of the debug log"
+#endif
+
+/* Period of the counter snapshot */
+#define DEBUG_LOG_COUNTER_PERIOD_MS (1000u)
+
+/* Counter identifiers */
+#define DEBUG_COUNTER_FRAMES        (0x01u)
+#define DEBUG_COUNTER_FRAME_ERRORS  (0x02u)
+#define DEBUG_COUNTER_RX_OVERFLOWS  (0x03u)
+#define DEBUG_COUNTER_INTERRUPTS    (0x04u)
+#define DEBUG_COUNTER_LOG_DROPS     (0x05u)
+#define DEBUG_COUNTER_OVERRUNS      (0x06u)
+#define DEBUG_COUNTER_STACK_USED    (0x07u)
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (DEBUG_LOG != 0u)
+void debug_log_text(char const *);
+void debug_log_format(char const *, ...);
+void debug_log_counter(uint8_t, uint32_t);
+void debug_log_overrun(uint8_t, uint32_t, uint32_t);
+void debug_log_poll(void);
+#endif
+
+#endif
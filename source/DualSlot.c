@@ -0,0 +1,568 @@
+/******************************************************************************
+* File Name: DualSlot.c
+*
+* Description: This file contains the update commands of the dual-slot
+*              (A/B) firmware images. The metadata and the selection of
+*              the slot to boot are in DualSlotBoot.c.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "DualSlot.h"
+#include "Kernels.h"
+#include "Command.h"
+#include "SysTimer.h"
+#include "CritSection.h"
+#include "FlashScan.h"
+
+#if (DUAL_SLOT != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define ROW_WORDS               (CY_FLASH_SIZEOF_ROW / sizeof(uint32_t))
+#define SLOT_ROWS               (DUAL_SLOT_SIZE / CY_FLASH_SIZEOF_ROW)
+
+/* Address the running image is linked at: its vector table */
+#ifndef DUAL_SLOT_IMAGE_START
+#if defined(__ICCARM__)
+extern uint32_t const __vector_table[];
+#define DUAL_SLOT_IMAGE_START   ((uint32_t)__vector_table)
+#else
+extern uint32_t const __Vectors[];
+#define DUAL_SLOT_IMAGE_START   ((uint32_t)__Vectors)
+#endif
+#endif
+
+/* Size of the running image, recorded as the image to roll back to: the
+ * code and the initial values of the data with GCC, as in FlashScan.c,
+ * otherwise the whole slot, which is never written while it runs */
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+extern uint8_t const __etext[];
+extern uint8_t const __data_start__[];
+extern uint8_t const __data_end__[];
+#define RUNNING_IMAGE_SIZE      (((uint32_t)__etext - DUAL_SLOT_IMAGE_START) +\
+                                 ((uint32_t)__data_end__ - (uint32_t)__data_start__))
+#else
+#define RUNNING_IMAGE_SIZE      (DUAL_SLOT_SIZE)
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Current metadata */
+static dual_slot_meta_t meta;
+
+/* Slot this image runs from */
+static uint32_t running_slot;
+
+/* The image is linked at the start of its slot, so a boot stage selects
+ * it. Updates are refused otherwise. */
+static bool slot_linked;
+
+/* Row being assembled from write requests */
+static uint32_t row_buffer[ROW_WORDS];
+static uint32_t row_number;
+static uint32_t row_fill;
+
+/* Reset requested by an activation or a rollback, made once the reply has
+ * gone out */
+static bool reset_pending;
+static uint32_t reset_ms;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t get_u32(uint8_t const *);
+static cy_en_flashdrv_status_t write_row(uint32_t, uint32_t const *);
+static void schedule_reset(void);
+static uint32_t slot_info_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t slot_write_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t slot_activate_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t slot_confirm_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t slot_rollback_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/*******************************************************************************
+* Function Name: get_u32
+********************************************************************************
+*
+* Summary:
+*  Reads a 32-bit little-endian value from a request.
+*
+*******************************************************************************/
+static uint32_t get_u32(uint8_t const *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8u) |
+           ((uint32_t)src[2] << 16u) | ((uint32_t)src[3] << 24u);
+}
+
+/*******************************************************************************
+* Function Name: write_row
+********************************************************************************
+*
+* Summary:
+*  Programs one flash row. Interrupts stay masked for the whole row write,
+*  so the master must not clock the link until the reply of the request is
+*  available. The background scan restarts if the row is in its area.
+*
+*******************************************************************************/
+static cy_en_flashdrv_status_t write_row(uint32_t address, uint32_t const *data)
+{
+    cy_en_flashdrv_status_t flash_status;
+    crit_state_t crit_state;
+#if (FLASH_SCAN != 0u)
+    flash_scan_status_t scan;
+#endif
+
+    CRIT_SECTION_ENTER(crit_state);
+    flash_status = Cy_Flash_WriteRow(address, data);
+    CRIT_SECTION_EXIT(crit_state);
+
+#if (FLASH_SCAN != 0u)
+    flash_scan_get_status(&scan);
+    if (((address + CY_FLASH_SIZEOF_ROW) > FLASH_SCAN_START) && (address < (FLASH_SCAN_START + scan.size)))
+    {
+        flash_scan_restart();
+    }
+#endif
+
+    return flash_status;
+}
+
+/*******************************************************************************
+* Function Name: schedule_reset
+********************************************************************************
+*
+* Summary:
+*  Requests a reset from dual_slot_poll(), once the reply has been sent.
+*
+*******************************************************************************/
+static void schedule_reset(void)
+{
+    reset_pending = true;
+    reset_ms = systimer_get_ms();
+}
+
+/*******************************************************************************
+* Function Name: slot_info_command
+********************************************************************************
+*
+* Summary:
+*  Returns the running and the active slot, the state, the boot attempts,
+*  the metadata sequence number and the slot size.
+*
+*******************************************************************************/
+static uint32_t slot_info_command(uint8_t const *request, uint32_t length,
+                                  uint8_t *reply, uint32_t *reply_length)
+{
+    uint32_t values[2];
+    uint32_t pos = 5UL;
+    uint32_t index;
+
+    (void) request;
+    (void) length;
+
+    values[0] = meta.sequence;
+    values[1] = DUAL_SLOT_SIZE;
+
+    reply[COMMAND_OPCODE_POS] = CMD_SLOT_INFO;
+    reply[1] = slot_linked ? (uint8_t)running_slot : DUAL_SLOT_UNLINKED;
+    reply[2] = meta.active;
+    reply[3] = meta.state;
+    reply[4] = meta.attempts;
+    for (index = 0UL; index < CY_ARRAY_SIZE(values); index++)
+    {
+        reply[pos++] = (uint8_t)values[index];
+        reply[pos++] = (uint8_t)(values[index] >> 8u);
+        reply[pos++] = (uint8_t)(values[index] >> 16u);
+        reply[pos++] = (uint8_t)(values[index] >> 24u);
+    }
+    *reply_length = pos;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: slot_write_command
+********************************************************************************
+*
+* Summary:
+*  Adds data to a row of the inactive slot. The data of a row is sent in
+*  order, starting at offset 0, and the row is programmed when complete.
+*  The first row programmed marks the inactive slot as not valid. Writes
+*  are refused unless the running image is confirmed, because the inactive
+*  slot holds the image to roll back to while it is on trial, and when the
+*  image is not linked at the start of its slot.
+*
+*******************************************************************************/
+static uint32_t slot_write_command(uint8_t const *request, uint32_t length,
+                                   uint8_t *reply, uint32_t *reply_length)
+{
+    dual_slot_meta_t update;
+    uint32_t inactive = running_slot ^ 1UL;
+    uint32_t row;
+    uint32_t offset;
+    uint32_t data_length;
+    uint32_t index;
+
+    if ((length <= SLOT_WRITE_HEADER_SIZE) || reset_pending || (!slot_linked) ||
+        (DUAL_SLOT_CONFIRMED != meta.state) || (meta.active != running_slot))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    row = (uint32_t)request[1] | ((uint32_t)request[2] << 8u);
+    offset = request[3];
+    data_length = length - SLOT_WRITE_HEADER_SIZE;
+
+    if ((row >= SLOT_ROWS) || ((offset + data_length) > CY_FLASH_SIZEOF_ROW))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    if (0UL == offset)
+    {
+        row_number = row;
+        row_fill = 0UL;
+        for (index = 0UL; index < ROW_WORDS; index++)
+        {
+            row_buffer[index] = 0xFFFFFFFFUL;
+        }
+    }
+    else if ((row != row_number) || (offset != row_fill))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    kernel_copy(&((uint8_t *)row_buffer)[offset], &request[SLOT_WRITE_HEADER_SIZE], data_length);
+    row_fill += data_length;
+
+    if (CY_FLASH_SIZEOF_ROW == row_fill)
+    {
+        row_fill = 0UL;
+
+        if (0UL != meta.size[inactive])
+        {
+            update = meta;
+            update.size[inactive] = 0UL;
+            update.crc[inactive] = 0UL;
+            if (CY_FLASH_DRV_SUCCESS != dual_slot_write_meta(&meta, &update))
+            {
+                return COMMAND_FAILURE;
+            }
+        }
+
+        if (CY_FLASH_DRV_SUCCESS != write_row(dual_slot_start(inactive) + (row * CY_FLASH_SIZEOF_ROW), row_buffer))
+        {
+            return COMMAND_FAILURE;
+        }
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_SLOT_WRITE;
+    reply[1] = request[1];
+    reply[2] = request[2];
+    *reply_length = 3UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: slot_activate_command
+********************************************************************************
+*
+* Summary:
+*  Checks the CRC-32 of the image in the inactive slot, makes it the active
+*  slot on trial and schedules a reset. The boot stage then starts the new
+*  image, which must be confirmed before DUAL_SLOT_MAX_ATTEMPTS boots. The
+*  running image is recorded first if it is not yet, as for the image of
+*  the factory, so the boot stage has a valid slot to return to.
+*
+*******************************************************************************/
+static uint32_t slot_activate_command(uint8_t const *request, uint32_t length,
+                                      uint8_t *reply, uint32_t *reply_length)
+{
+    dual_slot_meta_t update;
+    uint32_t inactive = running_slot ^ 1UL;
+    uint32_t size;
+    uint32_t crc;
+
+    if ((length < SLOT_ACTIVATE_SIZE) || reset_pending || (0UL != row_fill) || (!slot_linked) ||
+        (DUAL_SLOT_CONFIRMED != meta.state) || (meta.active != running_slot))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    size = get_u32(&request[1]);
+    crc = get_u32(&request[5]);
+
+    if ((0UL == size) || (size > DUAL_SLOT_SIZE) ||
+        (crc != kernel_crc32(KERNEL_CRC32_INIT, (void const *)dual_slot_start(inactive), size)))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    update = meta;
+    if (0UL == update.size[running_slot])
+    {
+        update.size[running_slot] = RUNNING_IMAGE_SIZE;
+        update.crc[running_slot] = kernel_crc32(KERNEL_CRC32_INIT, (void const *)dual_slot_start(running_slot),
+                                                RUNNING_IMAGE_SIZE);
+    }
+    update.size[inactive] = size;
+    update.crc[inactive] = crc;
+    update.active = (uint8_t)inactive;
+    update.state = DUAL_SLOT_TRIAL;
+    update.attempts = 0u;
+    if (CY_FLASH_DRV_SUCCESS != dual_slot_write_meta(&meta, &update))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    schedule_reset();
+
+    reply[COMMAND_OPCODE_POS] = CMD_SLOT_ACTIVATE;
+    reply[1] = (uint8_t)inactive;
+    *reply_length = 2UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: slot_confirm_command
+********************************************************************************
+*
+* Summary:
+*  Confirms the running image, once the master has checked that it works.
+*  Fails if the running image is not the active one on trial or failed.
+*
+*******************************************************************************/
+static uint32_t slot_confirm_command(uint8_t const *request, uint32_t length,
+                                     uint8_t *reply, uint32_t *reply_length)
+{
+    (void) request;
+    (void) length;
+
+    if ((DUAL_SLOT_CONFIRMED == meta.state) || (meta.active != running_slot) ||
+        (CY_FLASH_DRV_SUCCESS != dual_slot_confirm()))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_SLOT_CONFIRM;
+    reply[1] = (uint8_t)running_slot;
+    *reply_length = 2UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: slot_rollback_command
+********************************************************************************
+*
+* Summary:
+*  Makes the image in the other slot active again, if it is still intact,
+*  and schedules a reset. Refused unless the running image is the active
+*  one and is linked at the start of its slot.
+*
+*******************************************************************************/
+static uint32_t slot_rollback_command(uint8_t const *request, uint32_t length,
+                                      uint8_t *reply, uint32_t *reply_length)
+{
+    dual_slot_meta_t update;
+    uint32_t other = running_slot ^ 1UL;
+
+    (void) request;
+    (void) length;
+
+    if (reset_pending || (!slot_linked) || (meta.active != running_slot) || (!dual_slot_valid(&meta, other)))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    update = meta;
+    update.active = (uint8_t)other;
+    update.state = DUAL_SLOT_CONFIRMED;
+    update.attempts = 0u;
+    if (CY_FLASH_DRV_SUCCESS != dual_slot_write_meta(&meta, &update))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    schedule_reset();
+
+    reply[COMMAND_OPCODE_POS] = CMD_SLOT_ROLLBACK;
+    reply[1] = (uint8_t)other;
+    *reply_length = 2UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_init
+********************************************************************************
+*
+* Summary:
+*  Finds the running slot from the address the image is linked at, loads
+*  the metadata and registers the slot commands. Without metadata, the
+*  running slot is taken as active and confirmed. An image that is not
+*  linked at the start of slot A or B, such as one linked at the flash
+*  base without a boot stage, only answers the info command successfully.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t dual_slot_init(void)
+{
+    running_slot = (DUAL_SLOT_B_START == DUAL_SLOT_IMAGE_START) ? DUAL_SLOT_B : DUAL_SLOT_A;
+    slot_linked = (dual_slot_start(running_slot) == DUAL_SLOT_IMAGE_START);
+    row_fill = 0UL;
+    reset_pending = false;
+
+    if (!dual_slot_read_meta(&meta))
+    {
+        meta.magic = DUAL_SLOT_MAGIC;
+        meta.sequence = 0UL;
+        meta.active = (uint8_t)running_slot;
+        meta.state = DUAL_SLOT_CONFIRMED;
+        meta.attempts = 0u;
+        meta.size[DUAL_SLOT_A] = 0UL;
+        meta.size[DUAL_SLOT_B] = 0UL;
+        meta.crc[DUAL_SLOT_A] = 0UL;
+        meta.crc[DUAL_SLOT_B] = 0UL;
+    }
+
+    if ((COMMAND_SUCCESS != command_register(CMD_SLOT_INFO, &slot_info_command, SPI_TX_CONTROL,
+                                              DUAL_SLOT_BUDGET_US)) ||
+        (COMMAND_SUCCESS != command_register(CMD_SLOT_WRITE, &slot_write_command, SPI_TX_CONTROL, 0UL)) ||
+        (COMMAND_SUCCESS != command_register(CMD_SLOT_ACTIVATE, &slot_activate_command, SPI_TX_CONTROL, 0UL)) ||
+        (COMMAND_SUCCESS != command_register(CMD_SLOT_CONFIRM, &slot_confirm_command, SPI_TX_CONTROL, 0UL)) ||
+        (COMMAND_SUCCESS != command_register(CMD_SLOT_ROLLBACK, &slot_rollback_command, SPI_TX_CONTROL, 0UL)))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_poll
+********************************************************************************
+*
+* Summary:
+*  Resets the device after an activation or a rollback, once the link has
+*  been idle for DUAL_SLOT_RESET_DELAY_MS so the reply has been clocked
+*  out by the master.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void dual_slot_poll(void)
+{
+    if (!reset_pending)
+    {
+        return;
+    }
+
+    if (!is_link_idle())
+    {
+        reset_ms = systimer_get_ms();
+    }
+    else if ((systimer_get_ms() - reset_ms) >= DUAL_SLOT_RESET_DELAY_MS)
+    {
+        NVIC_SystemReset();
+    }
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_running
+********************************************************************************
+*
+* Summary:
+*  Returns the slot this image runs from.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) DUAL_SLOT_A or DUAL_SLOT_B
+*
+*******************************************************************************/
+uint32_t dual_slot_running(void)
+{
+    return running_slot;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_confirm
+********************************************************************************
+*
+* Summary:
+*  Confirms the running image if it is on trial, or failed its trial with
+*  no image to return to, so the boot stage keeps starting it. Does
+*  nothing otherwise.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (cy_en_flashdrv_status_t) CY_FLASH_DRV_SUCCESS, or the flash driver
+*  error
+*
+*******************************************************************************/
+cy_en_flashdrv_status_t dual_slot_confirm(void)
+{
+    dual_slot_meta_t update;
+
+    if ((DUAL_SLOT_CONFIRMED == meta.state) || (meta.active != running_slot))
+    {
+        return CY_FLASH_DRV_SUCCESS;
+    }
+
+    update = meta;
+    update.state = DUAL_SLOT_CONFIRMED;
+    update.attempts = 0u;
+
+    return dual_slot_write_meta(&meta, &update);
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name: DualSlot.h
+*
+* Description: This file contains the macros, data types and function
+*              prototypes for the dual-slot (A/B) firmware images.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_DUALSLOT_H_
+#define SOURCE_DUALSLOT_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+#include "DualSlotBoot.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+#if ((DUAL_SLOT != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "Dual-slot images require SPI_FRAMING_COBS"
+#endif
+
+/* Running slot reported when the image is not linked at a slot start */
+#define DUAL_SLOT_UNLINKED      (0xFFu)
+
+/* Delay between the last reply of an activation and the reset */
+#define DUAL_SLOT_RESET_DELAY_MS (10u)
+
+/* Opcodes, with their requests and replies:
+ *  0x80 info: running slot (DUAL_SLOT_UNLINKED if the image is not linked
+ *       at a slot start), active slot, state, attempts, 32-bit sequence
+ *       number and slot size
+ *  0x81 write: 16-bit row, offset in the row, data; reply opcode and row
+ *  0x82 activate: 32-bit image size and CRC-32; reply opcode and slot
+ *  0x83 confirm: reply opcode and slot
+ *  0x84 rollback: reply opcode and slot */
+#define CMD_SLOT_INFO           (0x80u)
+#define CMD_SLOT_WRITE          (0x81u)
+#define CMD_SLOT_ACTIVATE       (0x82u)
+#define CMD_SLOT_CONFIRM        (0x83u)
+#define CMD_SLOT_ROLLBACK       (0x84u)
+
+#define SLOT_WRITE_HEADER_SIZE  (4u)
+#define SLOT_ACTIVATE_SIZE      (9u)
+
+/* Execution budget of the info handler. The other handlers program flash
+ * or check a whole slot and have no budget. */
+#define DUAL_SLOT_BUDGET_US     (50u)
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (DUAL_SLOT != 0u)
+uint32_t dual_slot_init(void);
+void dual_slot_poll(void);
+uint32_t dual_slot_running(void);
+cy_en_flashdrv_status_t dual_slot_confirm(void);
+#endif
+
+#endif
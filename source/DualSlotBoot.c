@@ -0,0 +1,228 @@
+/******************************************************************************
+* File Name: DualSlotBoot.c
+*
+* Description: This file contains the metadata of the dual-slot (A/B) firmware
+*              images and the selection of the slot to boot. It depends only
+*              on the PDL and the kernels, so the boot stage links it alone.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "DualSlotBoot.h"
+#include "Kernels.h"
+#include "CritSection.h"
+
+#if ((DUAL_SLOT != 0u) || (DUAL_SLOT_BOOT != 0u))
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define ROW_WORDS               (CY_FLASH_SIZEOF_ROW / sizeof(uint32_t))
+
+/* Bytes covered by the check field */
+#define META_CHECK_SIZE         (sizeof(dual_slot_meta_t) - sizeof(uint32_t))
+
+/*******************************************************************************
+* Function Name: dual_slot_start
+********************************************************************************
+*
+* Summary:
+*  Returns the flash address of a slot.
+*
+* Parameters:
+*  (uint32_t) slot - DUAL_SLOT_A or DUAL_SLOT_B
+*
+* Return:
+*  (uint32_t) Start address of the slot
+*
+*******************************************************************************/
+uint32_t dual_slot_start(uint32_t slot)
+{
+    return (DUAL_SLOT_B == slot) ? DUAL_SLOT_B_START : DUAL_SLOT_A_START;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_valid
+********************************************************************************
+*
+* Summary:
+*  Checks that the metadata records an image in a slot and that the slot
+*  still matches its CRC-32.
+*
+* Parameters:
+*  (dual_slot_meta_t const *) meta - Current metadata
+*  (uint32_t) slot - DUAL_SLOT_A or DUAL_SLOT_B
+*
+* Return:
+*  (bool) true if the slot holds a valid image
+*
+*******************************************************************************/
+bool dual_slot_valid(dual_slot_meta_t const *meta, uint32_t slot)
+{
+    return (0UL != meta->size[slot]) &&
+           (meta->crc[slot] == kernel_crc32(KERNEL_CRC32_INIT, (void const *)dual_slot_start(slot),
+                                            meta->size[slot]));
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_read_meta
+********************************************************************************
+*
+* Summary:
+*  Finds the valid metadata copy with the highest sequence number.
+*
+* Parameters:
+*  (dual_slot_meta_t *) current - Destination
+*
+* Return:
+*  (bool) false if neither row holds valid metadata
+*
+*******************************************************************************/
+bool dual_slot_read_meta(dual_slot_meta_t *current)
+{
+    dual_slot_meta_t const *copy;
+    bool found = false;
+    uint32_t index;
+
+    for (index = 0UL; index < 2UL; index++)
+    {
+        copy = (dual_slot_meta_t const *)(DUAL_SLOT_META_START + (index * CY_FLASH_SIZEOF_ROW));
+
+        if ((DUAL_SLOT_MAGIC == copy->magic) &&
+            (copy->check == kernel_crc32(KERNEL_CRC32_INIT, copy, META_CHECK_SIZE)) &&
+            ((!found) || ((int32_t)(copy->sequence - current->sequence) > 0)))
+        {
+            kernel_copy(current, copy, sizeof(dual_slot_meta_t));
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_write_meta
+********************************************************************************
+*
+* Summary:
+*  Writes updated metadata to the row not holding the current copy, and
+*  makes it current once programmed. Interrupts stay masked for the row
+*  write. The metadata rows follow slot B, so they are never in the area
+*  of the background flash scan.
+*
+* Parameters:
+*  (dual_slot_meta_t *) current - Current metadata, replaced on success
+*  (dual_slot_meta_t *) update - Metadata to write; the magic, sequence
+*                                number and check are filled in
+*
+* Return:
+*  (cy_en_flashdrv_status_t) CY_FLASH_DRV_SUCCESS, or the flash driver
+*  error
+*
+*******************************************************************************/
+cy_en_flashdrv_status_t dual_slot_write_meta(dual_slot_meta_t *current, dual_slot_meta_t *update)
+{
+    uint32_t row[ROW_WORDS] = {0UL};
+    cy_en_flashdrv_status_t flash_status;
+    crit_state_t crit_state;
+
+    update->magic = DUAL_SLOT_MAGIC;
+    update->sequence = current->sequence + 1UL;
+    update->check = kernel_crc32(KERNEL_CRC32_INIT, update, META_CHECK_SIZE);
+    kernel_copy(row, update, sizeof(dual_slot_meta_t));
+
+    CRIT_SECTION_ENTER(crit_state);
+    flash_status = Cy_Flash_WriteRow(DUAL_SLOT_META_START + ((update->sequence & 1UL) * CY_FLASH_SIZEOF_ROW), row);
+    CRIT_SECTION_EXIT(crit_state);
+
+    if (flash_status == CY_FLASH_DRV_SUCCESS)
+    {
+        *current = *update;
+    }
+
+    return flash_status;
+}
+
+/*******************************************************************************
+* Function Name: dual_slot_boot_select
+********************************************************************************
+*
+* Summary:
+*  Selects the slot to start, for the boot stage. Each boot of a trial
+*  image is counted; after DUAL_SLOT_MAX_ATTEMPTS boots without
+*  confirmation, the other slot becomes active again if it holds a valid
+*  image. Otherwise the trial image is marked failed, not confirmed, and
+*  is still started, as there is nothing else to run.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) Start address of the slot to boot
+*
+*******************************************************************************/
+uint32_t dual_slot_boot_select(void)
+{
+    dual_slot_meta_t meta;
+    dual_slot_meta_t update;
+
+    if (!dual_slot_read_meta(&meta))
+    {
+        return DUAL_SLOT_A_START;
+    }
+
+    if (DUAL_SLOT_TRIAL == meta.state)
+    {
+        update = meta;
+        if (meta.attempts < DUAL_SLOT_MAX_ATTEMPTS)
+        {
+            update.attempts++;
+        }
+        else if (dual_slot_valid(&meta, meta.active ^ 1UL))
+        {
+            update.active = (uint8_t)(meta.active ^ 1u);
+            update.state = DUAL_SLOT_CONFIRMED;
+            update.attempts = 0u;
+        }
+        else
+        {
+            update.state = DUAL_SLOT_FAILED;
+        }
+        (void) dual_slot_write_meta(&meta, &update);
+    }
+
+    return dual_slot_start(meta.active);
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: DualSlotBoot.h
+*
+* Description: This file contains the flash layout, the metadata and the
+*              boot-time slot selection of the dual-slot (A/B) firmware
+*              images, shared by the application and the boot stage.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_DUALSLOTBOOT_H_
+#define SOURCE_DUALSLOTBOOT_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Two application slots: a new image is written to the inactive slot over
+ * the SPI link while the running one keeps serving the master, then made
+ * active by a metadata update and a reset */
+#ifndef DUAL_SLOT
+#define DUAL_SLOT               (0u)
+#endif
+
+/* Build of the boot stage instead of the application: BootMain.c then
+ * provides main(), and nothing else runs */
+#ifndef DUAL_SLOT_BOOT
+#define DUAL_SLOT_BOOT          (0u)
+#endif
+
+/* Flash layout: the boot stage, slot A, slot B, then two metadata rows.
+ * The slots are aligned on DUAL_SLOT_ALIGN bytes, which holds the two
+ * metadata rows, so the layout does not depend on the row size and
+ * scripts/slot_linker.py computes it from the flash size alone. */
+#ifndef DUAL_SLOT_BOOT_SIZE
+#define DUAL_SLOT_BOOT_SIZE     (0x1000UL)
+#endif
+#define DUAL_SLOT_ALIGN         (0x200UL)
+#define DUAL_SLOT_META_START    ((CY_FLASH_BASE + CY_FLASH_SIZE) - (2UL * CY_FLASH_SIZEOF_ROW))
+#define DUAL_SLOT_SIZE          ((((CY_FLASH_SIZE - DUAL_SLOT_BOOT_SIZE) - DUAL_SLOT_ALIGN) / 2UL) &\
+                                 ~(DUAL_SLOT_ALIGN - 1UL))
+#define DUAL_SLOT_A_START       (CY_FLASH_BASE + DUAL_SLOT_BOOT_SIZE)
+#define DUAL_SLOT_B_START       (DUAL_SLOT_A_START + DUAL_SLOT_SIZE)
+
+/* Slots */
+#define DUAL_SLOT_A             (0u)
+#define DUAL_SLOT_B             (1u)
+#define DUAL_SLOTS              (2u)
+
+/* States of the active slot */
+#define DUAL_SLOT_CONFIRMED     (0u)    /* Known to boot */
+#define DUAL_SLOT_TRIAL         (1u)    /* Activated, not yet confirmed */
+#define DUAL_SLOT_FAILED        (2u)    /* Trial over, no valid image to return to */
+
+/* Boots of a trial image without confirmation before the boot stage
+ * returns to the other slot, or marks the image failed if the other slot
+ * holds no valid image */
+#define DUAL_SLOT_MAX_ATTEMPTS  (3u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Metadata, stored alternately in the two metadata rows. The valid copy
+ * with the highest sequence number is current, so a write interrupted by a
+ * reset leaves the previous copy in force. */
+typedef struct
+{
+    uint32_t magic;                     /* DUAL_SLOT_MAGIC */
+    uint32_t sequence;                  /* Incremented on each write */
+    uint8_t active;                     /* Slot to boot */
+    uint8_t state;                      /* DUAL_SLOT_CONFIRMED, DUAL_SLOT_TRIAL or DUAL_SLOT_FAILED */
+    uint8_t attempts;                   /* Boots of a trial image */
+    uint8_t reserved;
+    uint32_t size[DUAL_SLOTS];          /* Image size, 0 if the slot is not valid */
+    uint32_t crc[DUAL_SLOTS];           /* CRC-32 of the image */
+    uint32_t check;                     /* CRC-32 of the fields above */
+} dual_slot_meta_t;
+
+#define DUAL_SLOT_MAGIC         (0x544F4C53UL)  /* "SLOT" */
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if ((DUAL_SLOT != 0u) || (DUAL_SLOT_BOOT != 0u))
+uint32_t dual_slot_start(uint32_t);
+bool dual_slot_valid(dual_slot_meta_t const *, uint32_t);
+bool dual_slot_read_meta(dual_slot_meta_t *);
+cy_en_flashdrv_status_t dual_slot_write_meta(dual_slot_meta_t *, dual_slot_meta_t *);
+uint32_t dual_slot_boot_select(void);
+#endif
+
+#endif
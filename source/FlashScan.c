@@ -0,0 +1,327 @@
+/******************************************************************************
+* File Name: FlashScan.c
+*
+* Description: This file contains function definitions for the
+*              background flash image integrity scan.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "FlashScan.h"
+#include "Kernels.h"
+#include "Command.h"
+#include "SysTimer.h"
+#include "DebugLog.h"
+
+#if (FLASH_SCAN != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#if !defined(FLASH_SCAN_SIZE) && defined(__GNUC__) && !defined(__ARMCC_VERSION)
+/* End of the load image in the GCC linker script */
+extern uint8_t const __etext[];
+extern uint8_t const __data_start__[];
+extern uint8_t const __data_end__[];
+#define FLASH_SCAN_SIZE         ((uint32_t)__etext + ((uint32_t)__data_end__ - (uint32_t)__data_start__) -\
+                                 FLASH_SCAN_START)
+#elif !defined(FLASH_SCAN_SIZE)
+#define FLASH_SCAN_SIZE         ((CY_FLASH_BASE + CY_FLASH_SIZE) - FLASH_SCAN_START)
+#endif
+
+/* Reference record, at the first word boundary after the scanned area */
+#define FLASH_SCAN_RECORD_ADDRESS ((FLASH_SCAN_START + FLASH_SCAN_SIZE + 3UL) & ~3UL)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static flash_scan_status_t scan_status;
+
+/* CRC of the pass in progress */
+static uint32_t scan_crc;
+
+/* End of the last pass */
+static uint32_t pass_end_ms;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void read_record(void);
+static void end_pass(void);
+static uint32_t flash_scan_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/*******************************************************************************
+* Function Name: read_record
+********************************************************************************
+*
+* Summary:
+*  Takes the reference CRC from the record written after the image at
+*  build time, if there is one for the area scanned.
+*
+*******************************************************************************/
+static void read_record(void)
+{
+    flash_scan_record_t const *record;
+
+    if ((FLASH_SCAN_RECORD_ADDRESS + sizeof(flash_scan_record_t)) > (CY_FLASH_BASE + CY_FLASH_SIZE))
+    {
+        return;
+    }
+
+    record = (flash_scan_record_t const *)(uintptr_t)FLASH_SCAN_RECORD_ADDRESS;
+    if ((FLASH_SCAN_RECORD_MAGIC == record->magic) && (FLASH_SCAN_SIZE == record->size))
+    {
+        scan_status.reference_crc = record->crc;
+        scan_status.flags |= FLASH_SCAN_FLAG_REFERENCE | FLASH_SCAN_FLAG_STORED;
+    }
+}
+
+/*******************************************************************************
+* Function Name: end_pass
+********************************************************************************
+*
+* Summary:
+*  Records the CRC of a completed pass, and counts the passes that differ
+*  from the reference. Without a reference record, the first pass after a
+*  restart gives the reference.
+*
+*******************************************************************************/
+static void end_pass(void)
+{
+    scan_status.last_crc = scan_crc;
+    scan_status.passes++;
+
+    if (0UL == (scan_status.flags & FLASH_SCAN_FLAG_REFERENCE))
+    {
+        scan_status.reference_crc = scan_crc;
+        scan_status.flags |= FLASH_SCAN_FLAG_REFERENCE;
+    }
+    else if (scan_crc != scan_status.reference_crc)
+    {
+        scan_status.flags |= FLASH_SCAN_FLAG_MISMATCH;
+        scan_status.mismatches++;
+#if (DEBUG_LOG != 0u)
+        debug_log_format("CRC %08X != %08X", scan_crc, scan_status.reference_crc);
+#endif
+    }
+    else
+    {
+        scan_status.flags &= ~FLASH_SCAN_FLAG_MISMATCH;
+    }
+
+    scan_crc = KERNEL_CRC32_INIT;
+    scan_status.offset = 0UL;
+    pass_end_ms = systimer_get_ms();
+}
+
+/*******************************************************************************
+* Function Name: flash_scan_command
+********************************************************************************
+*
+* Summary:
+*  Returns the flags byte, then the offset in the current pass, the pass
+*  size, the number of passes, the last and the reference CRC and the
+*  number of mismatches, 32-bit little-endian. A restart request is
+*  applied before the status is read.
+*
+*******************************************************************************/
+static uint32_t flash_scan_command(uint8_t const *request, uint32_t length,
+                                   uint8_t *reply, uint32_t *reply_length)
+{
+    flash_scan_status_t status;
+    uint32_t values[6];
+    uint32_t pos = 2UL;
+    uint32_t index;
+
+    if ((length > COMMAND_PAYLOAD_POS) && (FLASH_SCAN_REQ_RESTART == request[COMMAND_PAYLOAD_POS]))
+    {
+        flash_scan_restart();
+    }
+
+    flash_scan_get_status(&status);
+
+    values[0] = status.offset;
+    values[1] = status.size;
+    values[2] = status.passes;
+    values[3] = status.last_crc;
+    values[4] = status.reference_crc;
+    values[5] = status.mismatches;
+
+    reply[COMMAND_OPCODE_POS] = CMD_FLASH_SCAN;
+    reply[1] = (uint8_t)status.flags;
+    for (index = 0UL; index < CY_ARRAY_SIZE(values); index++)
+    {
+        reply[pos++] = (uint8_t)values[index];
+        reply[pos++] = (uint8_t)(values[index] >> 8u);
+        reply[pos++] = (uint8_t)(values[index] >> 16u);
+        reply[pos++] = (uint8_t)(values[index] >> 24u);
+    }
+    *reply_length = pos;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: flash_scan_init
+********************************************************************************
+*
+* Summary:
+*  Registers the status command and starts the first pass, checked
+*  against the reference record if the build wrote one.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t flash_scan_init(void)
+{
+    flash_scan_restart();
+
+    if (COMMAND_SUCCESS != command_register(CMD_FLASH_SCAN, &flash_scan_command, SPI_TX_CONTROL,
+                                             FLASH_SCAN_BUDGET_US))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: flash_scan_poll
+********************************************************************************
+*
+* Summary:
+*  Advances the scan from the main loop. Chunks of FLASH_SCAN_CHUNK_SIZE
+*  bytes are processed while the link is idle, for at most
+*  FLASH_SCAN_SLICE_US. The scan stops at the next chunk as soon as a byte
+*  is received or a reply is queued, and resumes from the same offset on a
+*  later call.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void flash_scan_poll(void)
+{
+    uint32_t start_cycles;
+    uint32_t chunk;
+
+    if ((0UL == scan_status.offset) && (0UL != scan_status.passes) &&
+        ((systimer_get_ms() - pass_end_ms) < FLASH_SCAN_PERIOD_MS))
+    {
+        return;
+    }
+
+    start_cycles = systimer_get_cycles();
+
+    while (is_link_idle())
+    {
+        chunk = scan_status.size - scan_status.offset;
+        if (chunk > FLASH_SCAN_CHUNK_SIZE)
+        {
+            chunk = FLASH_SCAN_CHUNK_SIZE;
+        }
+
+        scan_crc = kernel_crc32(scan_crc, (void const *)(FLASH_SCAN_START + scan_status.offset), chunk);
+        scan_status.offset += chunk;
+
+        if (scan_status.offset >= scan_status.size)
+        {
+            end_pass();
+            break;
+        }
+
+        if (systimer_cycles_to_us(systimer_get_cycles() - start_cycles) >= FLASH_SCAN_SLICE_US)
+        {
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_scan_restart
+********************************************************************************
+*
+* Summary:
+*  Restarts the scan from the beginning and reads the reference record
+*  again; without one, the next pass gives the reference. Call it after
+*  writing to the scanned area.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void flash_scan_restart(void)
+{
+    scan_status.flags = 0UL;
+    scan_status.offset = 0UL;
+    scan_status.size = FLASH_SCAN_SIZE;
+    scan_status.passes = 0UL;
+    scan_status.last_crc = 0UL;
+    scan_status.reference_crc = 0UL;
+    scan_status.mismatches = 0UL;
+
+    scan_crc = KERNEL_CRC32_INIT;
+
+    read_record();
+}
+
+/*******************************************************************************
+* Function Name: flash_scan_get_status
+********************************************************************************
+*
+* Summary:
+*  Returns the scan progress and results.
+*
+* Parameters:
+*  (flash_scan_status_t *) status - Location to store the status
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void flash_scan_get_status(flash_scan_status_t *status)
+{
+    *status = scan_status;
+}
+#endif
+
+/* [] END OF FILE */
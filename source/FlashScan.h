@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name: FlashScan.h
+*
+* Description: This file contains the macros and function prototypes
+*              for the background flash image integrity scan.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_FLASHSCAN_H_
+#define SOURCE_FLASHSCAN_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* CRC of the application image computed in small chunks while the SPI link
+ * is idle */
+#ifndef FLASH_SCAN
+#define FLASH_SCAN              (0u)
+#endif
+
+#if ((FLASH_SCAN != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "The flash scan requires SPI_FRAMING_COBS"
+#endif
+
+/* Area scanned. By default, the image placed by the GCC linker script:
+ * code and read-only data, followed by the initial values of .data. With
+ * other toolchains, the whole flash is scanned unless FLASH_SCAN_SIZE is
+ * defined. */
+#ifndef FLASH_SCAN_START
+#define FLASH_SCAN_START        (CY_FLASH_BASE)
+#endif
+
+/* Bytes processed between two checks of the link */
+#define FLASH_SCAN_CHUNK_SIZE   (64u)
+
+/* Longest time spent scanning in one call to flash_scan_poll() */
+#define FLASH_SCAN_SLICE_US     (200u)
+
+/* Pause between the end of a pass and the start of the next one */
+#ifndef FLASH_SCAN_PERIOD_MS
+#define FLASH_SCAN_PERIOD_MS    (1000u)
+#endif
+
+/* Reference record written after the scanned area by scripts/image_crc.py:
+ * magic word, size of the area and its CRC-32. Without a valid record, the
+ * first pass gives the reference. */
+#define FLASH_SCAN_RECORD_MAGIC (0x52435346UL)  /* "FSCR" */
+
+/* Opcode returning the scan status. An optional request byte of 0x01
+ * restarts the scan, reading the reference record again. */
+#define CMD_FLASH_SCAN          (0x70u)
+#define FLASH_SCAN_REQ_RESTART  (0x01u)
+
+/* Status flags */
+#define FLASH_SCAN_FLAG_REFERENCE (0x01u) /* A reference CRC is known */
+#define FLASH_SCAN_FLAG_MISMATCH  (0x02u) /* The last pass differed from it */
+#define FLASH_SCAN_FLAG_STORED    (0x04u) /* The reference comes from the record */
+
+/* Execution budget of the status handler */
+#define FLASH_SCAN_BUDGET_US    (50u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t magic;                     /* FLASH_SCAN_RECORD_MAGIC */
+    uint32_t size;                      /* Bytes scanned */
+    uint32_t crc;                       /* CRC-32 of the image as built */
+} flash_scan_record_t;
+
+typedef struct
+{
+    uint32_t flags;                     /* FLASH_SCAN_FLAG_x */
+    uint32_t offset;                    /* Bytes scanned in the current pass */
+    uint32_t size;                      /* Bytes in a pass */
+    uint32_t passes;                    /* Completed passes */
+    uint32_t last_crc;                  /* CRC-32 of the last completed pass */
+    uint32_t reference_crc;             /* CRC-32 of the record or of the first pass */
+    uint32_t mismatches;                /* Passes that differed from the reference */
+} flash_scan_status_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (FLASH_SCAN != 0u)
+uint32_t flash_scan_init(void);
+void flash_scan_poll(void);
+void flash_scan_restart(void);
+void flash_scan_get_status(flash_scan_status_t *);
+#endif
+
+#endif
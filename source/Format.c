@@ -0,0 +1,279 @@
+/******************************************************************************
+* File Name: Format.c
+*
+* Description: This file contains a lightweight, reentrant formatter for
+*              diagnostic output: integers, hexadecimal and strings, without
+*              the C library printf code.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include <stdbool.h>
+#include "Format.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Digits of the largest 32-bit value in decimal */
+#define FORMAT_DIGITS_MAX       (10u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Output buffer, with room kept for the terminating NUL */
+typedef struct
+{
+    char *buffer;
+    uint32_t size;
+    uint32_t length;
+} format_out_t;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void put_char(format_out_t *, char);
+static void put_number(format_out_t *, uint32_t, uint32_t, bool, char, uint32_t, bool);
+
+/*******************************************************************************
+* Function Name: put_char
+********************************************************************************
+*
+* Summary:
+*  Appends one character; characters beyond the buffer are dropped.
+*
+*******************************************************************************/
+static void put_char(format_out_t *out, char c)
+{
+    if ((out->length + 1UL) < out->size)
+    {
+        out->buffer[out->length++] = c;
+    }
+}
+
+/*******************************************************************************
+* Function Name: put_number
+********************************************************************************
+*
+* Summary:
+*  Appends an unsigned value in base 10 or 16, with an optional minus sign,
+*  right-aligned in a field padded with spaces or zeros.
+*
+*******************************************************************************/
+static void put_number(format_out_t *out, uint32_t value, uint32_t base, bool upper,
+                       char pad, uint32_t width, bool negative)
+{
+    char digits[FORMAT_DIGITS_MAX];
+    char const *set = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    uint32_t count = 0UL;
+    uint32_t used;
+
+    do
+    {
+        digits[count++] = set[value % base];
+        value /= base;
+    } while (0UL != value);
+
+    used = count + (negative ? 1UL : 0UL);
+
+    /* A minus sign goes before zero padding and after space padding */
+    if (negative && (pad == '0'))
+    {
+        put_char(out, '-');
+    }
+    while (width > used)
+    {
+        put_char(out, pad);
+        width--;
+    }
+    if (negative && (pad != '0'))
+    {
+        put_char(out, '-');
+    }
+
+    while (count > 0UL)
+    {
+        put_char(out, digits[--count]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: format_args
+********************************************************************************
+*
+* Summary:
+*  Formats text into a buffer, like vsnprintf() with a subset of the
+*  conversions: %d, %u, %x, %X, %c, %s and %%, with an optional 0 flag and
+*  field width (for example %08X). An l length modifier is accepted and
+*  ignored, as integer arguments are taken as 32-bit values. The output is
+*  always NUL-terminated and truncated to the buffer. It uses no static
+*  data and a fixed amount of stack, so it may be called from interrupts.
+*
+* Parameters:
+*  (char *) buffer - Output
+*  (uint32_t) size - Size of the output, including the NUL
+*  (char const *) fmt - Format string
+*  (va_list) args - Arguments
+*
+* Return:
+*  (uint32_t) Characters written, without the NUL
+*
+*******************************************************************************/
+uint32_t format_args(char *buffer, uint32_t size, char const *fmt, va_list args)
+{
+    format_out_t out = { buffer, size, 0UL };
+    char const *text;
+    uint32_t width;
+    uint32_t value;
+    int32_t signed_value;
+    char pad;
+
+    if (0UL == size)
+    {
+        return 0UL;
+    }
+
+    while ('\0' != *fmt)
+    {
+        if ('%' != *fmt)
+        {
+            put_char(&out, *fmt++);
+            continue;
+        }
+        fmt++;
+
+        pad = ' ';
+        if ('0' == *fmt)
+        {
+            pad = '0';
+            fmt++;
+        }
+        width = 0UL;
+        while ((*fmt >= '0') && (*fmt <= '9'))
+        {
+            width = (width * 10UL) + (uint32_t)(*fmt - '0');
+            fmt++;
+        }
+        if (width > FORMAT_WIDTH_MAX)
+        {
+            width = FORMAT_WIDTH_MAX;
+        }
+        if ('l' == *fmt)
+        {
+            fmt++;
+        }
+
+        switch (*fmt)
+        {
+            case 'd':
+                signed_value = va_arg(args, int32_t);
+                value = (signed_value < 0) ? (0UL - (uint32_t)signed_value) : (uint32_t)signed_value;
+                put_number(&out, value, 10UL, false, pad, width, signed_value < 0);
+                break;
+
+            case 'u':
+                put_number(&out, va_arg(args, uint32_t), 10UL, false, pad, width, false);
+                break;
+
+            case 'x':
+            case 'X':
+                put_number(&out, va_arg(args, uint32_t), 16UL, ('X' == *fmt), pad, width, false);
+                break;
+
+            case 'c':
+                put_char(&out, (char)va_arg(args, int));
+                break;
+
+            case 's':
+                text = va_arg(args, char const *);
+                for (value = 0UL; '\0' != text[value]; value++)
+                {
+                }
+                while (width > value)
+                {
+                    put_char(&out, ' ');
+                    width--;
+                }
+                while ('\0' != *text)
+                {
+                    put_char(&out, *text++);
+                }
+                break;
+
+            case '%':
+                put_char(&out, '%');
+                break;
+
+            default:
+                /* Unknown conversion, or a '%' at the end of the string */
+                out.buffer[out.length] = '\0';
+                return out.length;
+        }
+        fmt++;
+    }
+
+    out.buffer[out.length] = '\0';
+    return out.length;
+}
+
+/*******************************************************************************
+* Function Name: format
+********************************************************************************
+*
+* Summary:
+*  Formats text into a buffer, like snprintf() with the conversions of
+*  format_args().
+*
+* Parameters:
+*  (char *) buffer - Output
+*  (uint32_t) size - Size of the output, including the NUL
+*  (char const *) fmt - Format string
+*  ... - Arguments
+*
+* Return:
+*  (uint32_t) Characters written, without the NUL
+*
+*******************************************************************************/
+uint32_t format(char *buffer, uint32_t size, char const *fmt, ...)
+{
+    va_list args;
+    uint32_t length;
+
+    va_start(args, fmt);
+    length = format_args(buffer, size, fmt, args);
+    va_end(args);
+
+    return length;
+}
+
+/* [] END OF FILE */
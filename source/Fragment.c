@@ -0,0 +1,379 @@
+/******************************************************************************
+* File Name: Fragment.c
+*
+* Description: This file contains the reassembly of messages sent as numbered
+*              fragments, tolerant of fragments arriving out of order or twice.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Fragment.h"
+#include "Command.h"
+#include "Kernels.h"
+#include "SysTimer.h"
+
+#if (FRAGMENT != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FRAGMENT_BITMAP_WORDS   ((FRAGMENT_MAX_COUNT + 31u) / 32u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Reassembly state of one message type */
+typedef struct
+{
+    uint8_t *buffer;                    /* Given by the application */
+    uint32_t size;
+    fragment_handler_t handler;         /* NULL if the type is not registered */
+
+    bool active;                        /* Message being reassembled */
+    uint8_t id;
+    uint8_t count;
+    uint8_t received;
+    uint32_t length;                    /* Known once the last fragment is in */
+    uint32_t last_ms;                   /* Arrival of the latest fragment */
+    uint32_t bitmap[FRAGMENT_BITMAP_WORDS];
+
+    /* Message delivered last, to acknowledge its fragments again */
+    bool done;
+    uint8_t done_id;
+    uint8_t done_count;
+    uint8_t done_state;
+    uint32_t done_crc;
+    uint32_t done_ms;
+} fragment_slot_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static fragment_slot_t fragment_slots[FRAGMENT_TYPES];
+static fragment_stats_t fragment_stats;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t fragment_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t build_ack(uint8_t const *, uint8_t, uint32_t, uint8_t *);
+static void deliver(fragment_slot_t *, uint32_t);
+
+/*******************************************************************************
+* Function Name: build_ack
+********************************************************************************
+*
+* Summary:
+*  Builds the reply to a fragment; the CRC follows the state once the
+*  message is reassembled.
+*
+*******************************************************************************/
+static uint32_t build_ack(uint8_t const *request, uint8_t state, uint32_t crc, uint8_t *reply)
+{
+    reply[COMMAND_OPCODE_POS] = CMD_FRAGMENT;
+    reply[FRAGMENT_TYPE_POS] = request[FRAGMENT_TYPE_POS];
+    reply[FRAGMENT_ID_POS] = request[FRAGMENT_ID_POS];
+    reply[FRAGMENT_INDEX_POS] = request[FRAGMENT_INDEX_POS];
+    reply[FRAGMENT_STATE_POS] = state;
+
+    if (FRAGMENT_STATE_PARTIAL == state)
+    {
+        return FRAGMENT_ACK_SIZE;
+    }
+
+    reply[5] = (uint8_t)crc;
+    reply[6] = (uint8_t)(crc >> 8u);
+    reply[7] = (uint8_t)(crc >> 16u);
+    reply[8] = (uint8_t)(crc >> 24u);
+
+    return FRAGMENT_ACK_CRC_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: deliver
+********************************************************************************
+*
+* Summary:
+*  Passes a reassembled message to its handler and keeps the outcome, to
+*  answer fragments the master sends again because an ack was lost.
+*
+*******************************************************************************/
+static void deliver(fragment_slot_t *slot, uint32_t now_ms)
+{
+    slot->done_crc = kernel_crc32(KERNEL_CRC32_INIT, slot->buffer, slot->length);
+    slot->done_state = (COMMAND_SUCCESS == slot->handler(slot->buffer, slot->length)) ?
+                       FRAGMENT_STATE_COMPLETE : FRAGMENT_STATE_REJECTED;
+    slot->done_id = slot->id;
+    slot->done_count = slot->count;
+    slot->done_ms = now_ms;
+    slot->done = true;
+    slot->active = false;
+    fragment_stats.messages++;
+}
+
+/*******************************************************************************
+* Function Name: fragment_command
+********************************************************************************
+*
+* Summary:
+*  Stores a fragment at its place in the buffer of its message type, in
+*  whatever order fragments arrive. A fragment of another message
+*  identifier replaces the message being reassembled. The fragment that
+*  completes the message delivers it to the handler. Malformed fragments,
+*  and fragments of unregistered types or beyond the buffer, are rejected.
+*
+*******************************************************************************/
+static uint32_t fragment_command(uint8_t const *request, uint32_t length,
+                                 uint8_t *reply, uint32_t *reply_length)
+{
+    fragment_slot_t *slot;
+    uint32_t now_ms = systimer_get_ms();
+    uint32_t index;
+    uint32_t count;
+    uint32_t offset;
+    uint32_t data_length;
+    uint32_t bit;
+
+    if (length < FRAGMENT_HEADER_SIZE)
+    {
+        return COMMAND_FAILURE;
+    }
+
+    index = request[FRAGMENT_INDEX_POS];
+    count = request[FRAGMENT_COUNT_POS];
+    offset = index * FRAGMENT_DATA_SIZE;
+    data_length = length - FRAGMENT_HEADER_SIZE;
+
+    if ((request[FRAGMENT_TYPE_POS] >= FRAGMENT_TYPES) || (0UL == count) ||
+        (count > FRAGMENT_MAX_COUNT) || (index >= count) ||
+        (((index + 1UL) < count) && (data_length != FRAGMENT_DATA_SIZE)))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    slot = &fragment_slots[request[FRAGMENT_TYPE_POS]];
+    if ((NULL == slot->handler) || ((offset + data_length) > slot->size) ||
+        (((count - 1UL) * FRAGMENT_DATA_SIZE) > slot->size))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    /* Again a fragment of the message just delivered: its ack was lost */
+    if ((!slot->active) && slot->done && (slot->done_id == request[FRAGMENT_ID_POS]) &&
+        (slot->done_count == count) && ((now_ms - slot->done_ms) < FRAGMENT_TIMEOUT_MS))
+    {
+        fragment_stats.duplicates++;
+        *reply_length = build_ack(request, slot->done_state, slot->done_crc, reply);
+        return COMMAND_SUCCESS;
+    }
+
+    if ((!slot->active) || (slot->id != request[FRAGMENT_ID_POS]) || (slot->count != count) ||
+        ((now_ms - slot->last_ms) >= FRAGMENT_TIMEOUT_MS))
+    {
+        if (slot->active && ((now_ms - slot->last_ms) >= FRAGMENT_TIMEOUT_MS))
+        {
+            fragment_stats.timeouts++;
+        }
+        else if (slot->active)
+        {
+            fragment_stats.restarts++;
+        }
+        else
+        {
+            /* First fragment after an idle period */
+        }
+        slot->active = true;
+        slot->id = request[FRAGMENT_ID_POS];
+        slot->count = (uint8_t)count;
+        slot->received = 0u;
+        slot->length = 0UL;
+        for (bit = 0UL; bit < FRAGMENT_BITMAP_WORDS; bit++)
+        {
+            slot->bitmap[bit] = 0UL;
+        }
+        slot->done = false;
+    }
+    slot->last_ms = now_ms;
+
+    bit = 1UL << (index % 32u);
+    if (0UL != (slot->bitmap[index / 32u] & bit))
+    {
+        fragment_stats.duplicates++;
+    }
+    else
+    {
+        kernel_copy(&slot->buffer[offset], &request[FRAGMENT_HEADER_SIZE], data_length);
+        slot->bitmap[index / 32u] |= bit;
+        slot->received++;
+        fragment_stats.fragments++;
+
+        if ((index + 1UL) == count)
+        {
+            slot->length = offset + data_length;
+        }
+    }
+
+    if (slot->received == slot->count)
+    {
+        deliver(slot, now_ms);
+        *reply_length = build_ack(request, slot->done_state, slot->done_crc, reply);
+    }
+    else
+    {
+        *reply_length = build_ack(request, FRAGMENT_STATE_PARTIAL, 0UL, reply);
+    }
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: fragment_init
+********************************************************************************
+*
+* Summary:
+*  Clears the message types and registers the fragment command. It has no
+*  budget, as the fragment completing a message runs the handler.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t fragment_init(void)
+{
+    uint32_t type;
+
+    for (type = 0UL; type < FRAGMENT_TYPES; type++)
+    {
+        fragment_slots[type].handler = NULL;
+        fragment_slots[type].active = false;
+        fragment_slots[type].done = false;
+    }
+
+    if (COMMAND_SUCCESS != command_register(CMD_FRAGMENT, &fragment_command, SPI_TX_CONTROL, 0UL))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: fragment_register
+********************************************************************************
+*
+* Summary:
+*  Gives the buffer and the handler of a message type. Messages of the type
+*  can be up to the size of the buffer, and at most FRAGMENT_MAX_COUNT
+*  fragments.
+*
+* Parameters:
+*  (uint8_t) type - Message type, below FRAGMENT_TYPES
+*  (uint8_t *) buffer - Reassembly buffer
+*  (uint32_t) size - Size of the buffer
+*  (fragment_handler_t) handler - Called with each reassembled message
+*
+* Return:
+*  (uint32_t) COMMAND_SUCCESS, or COMMAND_FAILURE for an invalid argument
+*
+*******************************************************************************/
+uint32_t fragment_register(uint8_t type, uint8_t *buffer, uint32_t size, fragment_handler_t handler)
+{
+    if ((type >= FRAGMENT_TYPES) || (NULL == buffer) || (0UL == size) || (NULL == handler))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    fragment_slots[type].buffer = buffer;
+    fragment_slots[type].size = size;
+    fragment_slots[type].handler = handler;
+    fragment_slots[type].active = false;
+    fragment_slots[type].done = false;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: fragment_poll
+********************************************************************************
+*
+* Summary:
+*  Abandons the messages that received no fragment for FRAGMENT_TIMEOUT_MS,
+*  for instance because the master was reset while sending one.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void fragment_poll(void)
+{
+    uint32_t now_ms = systimer_get_ms();
+    uint32_t type;
+
+    for (type = 0UL; type < FRAGMENT_TYPES; type++)
+    {
+        if (fragment_slots[type].active && ((now_ms - fragment_slots[type].last_ms) >= FRAGMENT_TIMEOUT_MS))
+        {
+            fragment_slots[type].active = false;
+            fragment_stats.timeouts++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: fragment_get_stats
+********************************************************************************
+*
+* Summary:
+*  Copies the reassembly statistics.
+*
+* Parameters:
+*  (fragment_stats_t *) stats - Destination
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void fragment_get_stats(fragment_stats_t *stats)
+{
+    *stats = fragment_stats;
+}
+
+#endif
+
+/* [] END OF FILE */
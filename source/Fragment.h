@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: Fragment.h
+*
+* Description: This file contains the macros and function prototypes of the
+*              fragmentation layer, which carries messages larger than a frame.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_FRAGMENT_H_
+#define SOURCE_FRAGMENT_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Messages larger than a frame, sent as numbered fragments and reassembled
+ * into a buffer given by the application */
+#ifndef FRAGMENT
+#define FRAGMENT                (0u)
+#endif
+
+#if ((FRAGMENT != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "The fragmentation layer requires SPI_FRAMING_COBS"
+#endif
+
+/* Opcode of a fragment. Request: opcode, message type, message identifier,
+ * fragment index, fragment count, then the data. Every fragment but the
+ * last carries FRAGMENT_DATA_SIZE bytes. */
+#define CMD_FRAGMENT            (0xC0u)
+#define FRAGMENT_TYPE_POS       (1u)
+#define FRAGMENT_ID_POS         (2u)
+#define FRAGMENT_INDEX_POS      (3u)
+#define FRAGMENT_COUNT_POS      (4u)
+#define FRAGMENT_HEADER_SIZE    (5u)
+#define FRAGMENT_DATA_SIZE      (SPI_FRAME_MAX_SIZE - FRAGMENT_HEADER_SIZE)
+
+/* Reply to each fragment: opcode, type, identifier, index, state, and for
+ * FRAGMENT_STATE_COMPLETE the CRC-32 of the message, 32-bit little-endian */
+#define FRAGMENT_STATE_POS      (4u)
+#define FRAGMENT_ACK_SIZE       (5u)
+#define FRAGMENT_ACK_CRC_SIZE   (9u)
+
+#define FRAGMENT_STATE_PARTIAL  (0u)    /* Stored, fragments still missing */
+#define FRAGMENT_STATE_COMPLETE (1u)    /* Message reassembled and delivered */
+#define FRAGMENT_STATE_REJECTED (2u)    /* Reassembled, refused by the handler */
+
+/* Message types with a handler */
+#define FRAGMENT_TYPES          (4u)
+
+/* Fragments of one message, at most 255 */
+#ifndef FRAGMENT_MAX_COUNT
+#define FRAGMENT_MAX_COUNT      (64u)
+#endif
+
+#if ((FRAGMENT_MAX_COUNT == 0u) || (FRAGMENT_MAX_COUNT > 255u))
+#error "FRAGMENT_MAX_COUNT must be 1u to 255u"
+#endif
+
+/* A message with no new fragment for this long is abandoned */
+#define FRAGMENT_TIMEOUT_MS     (500u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Called with a reassembled message, which stays in the buffer given to
+ * fragment_register() until the first fragment of the next message of the
+ * type arrives. Returns COMMAND_SUCCESS, or COMMAND_FAILURE to reject it.
+ * Name handlers *_message, which scripts/stack_usage.ini follows. */
+typedef uint32_t (*fragment_handler_t)(uint8_t const *message, uint32_t length);
+
+typedef struct
+{
+    uint32_t messages;                  /* Delivered to a handler */
+    uint32_t fragments;                 /* Stored */
+    uint32_t duplicates;                /* Received again, acknowledged only */
+    uint32_t restarts;                  /* Partial messages replaced by a new one */
+    uint32_t timeouts;                  /* Partial messages abandoned */
+} fragment_stats_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (FRAGMENT != 0u)
+uint32_t fragment_init(void);
+uint32_t fragment_register(uint8_t, uint8_t *, uint32_t, fragment_handler_t);
+void fragment_poll(void);
+void fragment_get_stats(fragment_stats_t *);
+#endif
+
+#endif
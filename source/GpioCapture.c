@@ -0,0 +1,236 @@
+/******************************************************************************
+* File Name: GpioCapture.c
+*
+* Description: This file contains function definitions for the GPIO
+*              input-capture event stream.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "GpioCapture.h"
+#include "Command.h"
+#include "SysTimer.h"
+
+#if (GPIO_CAPTURE != 0u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    GPIO_PRT_Type *port;
+    uint32_t pin;
+    IRQn_Type irq;
+} capture_pin_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Pins with a CAPTURE alias; the index is reported in the events */
+static const capture_pin_t capture_pins[] =
+{
+    {CAPTURE0_PORT, CAPTURE0_NUM, CAPTURE0_IRQ},
+#ifdef CAPTURE1_PORT
+    {CAPTURE1_PORT, CAPTURE1_NUM, CAPTURE1_IRQ},
+#endif
+#ifdef CAPTURE2_PORT
+    {CAPTURE2_PORT, CAPTURE2_NUM, CAPTURE2_IRQ},
+#endif
+#ifdef CAPTURE3_PORT
+    {CAPTURE3_PORT, CAPTURE3_NUM, CAPTURE3_IRQ},
+#endif
+};
+
+/* Event ring written by the ISR and read by the command handler */
+static uint8_t event_pin[GPIO_CAPTURE_EVENTS];
+static uint32_t event_time[GPIO_CAPTURE_EVENTS];
+static volatile uint8_t event_head;
+static volatile uint8_t event_tail;
+static volatile bool event_overflow;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void GPIO_CaptureIsr(void);
+static uint32_t gpio_events_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/*******************************************************************************
+* Function Name: GPIO_CaptureIsr
+********************************************************************************
+*
+* Summary:
+*  Shared by the ports of all capture pins. Records an event for every pin
+*  with a pending edge. Edges of the same entry share one timestamp. The
+*  edge is given by the pin level when it is read; if a pulse is shorter
+*  than the interrupt latency, both of its edges set the same flag and a
+*  single event is recorded.
+*
+*******************************************************************************/
+static void GPIO_CaptureIsr(void)
+{
+    uint32_t timestamp = systimer_get_us();
+    uint32_t index;
+    uint8_t head;
+
+    for (index = 0UL; index < CY_ARRAY_SIZE(capture_pins); index++)
+    {
+        if (0UL == Cy_GPIO_GetInterruptStatus(capture_pins[index].port, capture_pins[index].pin))
+        {
+            continue;
+        }
+
+        Cy_GPIO_ClearInterrupt(capture_pins[index].port, capture_pins[index].pin);
+
+        head = event_head;
+        if ((uint8_t)(head - event_tail) >= GPIO_CAPTURE_EVENTS)
+        {
+            event_overflow = true;
+            continue;
+        }
+
+        event_pin[head % GPIO_CAPTURE_EVENTS] = (uint8_t)((index << 1u) |
+            (Cy_GPIO_Read(capture_pins[index].port, capture_pins[index].pin) & 1UL));
+        event_time[head % GPIO_CAPTURE_EVENTS] = timestamp;
+        event_head = (uint8_t)(head + 1u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: gpio_events_command
+********************************************************************************
+*
+* Summary:
+*  Returns as many of the oldest events as fit in one frame.
+*
+*******************************************************************************/
+static uint32_t gpio_events_command(uint8_t const *request, uint32_t length,
+                                    uint8_t *reply, uint32_t *reply_length)
+{
+    uint8_t tail = event_tail;
+    uint8_t *dest = &reply[GPIO_EVENTS_HEADER_SIZE];
+    uint32_t count = 0UL;
+    uint32_t timestamp;
+    uint8_t flags = 0u;
+
+    (void) request;
+    (void) length;
+
+    if (event_overflow)
+    {
+        /* Cleared before reading, so a loss after this point is reported
+         * by the next read */
+        event_overflow = false;
+        flags |= GPIO_FLAG_OVERFLOW;
+    }
+
+    while ((tail != event_head) && (count < GPIO_EVENTS_PER_FRAME))
+    {
+        timestamp = event_time[tail % GPIO_CAPTURE_EVENTS];
+
+        *dest++ = event_pin[tail % GPIO_CAPTURE_EVENTS];
+        *dest++ = (uint8_t)timestamp;
+        *dest++ = (uint8_t)(timestamp >> 8u);
+        *dest++ = (uint8_t)(timestamp >> 16u);
+        *dest++ = (uint8_t)(timestamp >> 24u);
+
+        tail = (uint8_t)(tail + 1u);
+        count++;
+    }
+
+    event_tail = tail;
+
+    if (tail != event_head)
+    {
+        flags |= GPIO_FLAG_MORE;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_GPIO_EVENTS;
+    reply[1] = (uint8_t)count;
+    reply[2] = flags;
+    *reply_length = GPIO_EVENTS_HEADER_SIZE + (count * GPIO_EVENT_SIZE);
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: gpio_capture_init
+********************************************************************************
+*
+* Summary:
+*  Enables edge interrupts on both edges of every capture pin and registers
+*  the event read command.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t gpio_capture_init(void)
+{
+    cy_stc_sysint_t intr_config;
+    uint32_t index;
+
+    event_head = 0u;
+    event_tail = 0u;
+    event_overflow = false;
+
+    if (COMMAND_SUCCESS != command_register(CMD_GPIO_EVENTS, &gpio_events_command, SPI_TX_BULK,
+                                             GPIO_EVENTS_BUDGET_US))
+    {
+        return INIT_FAILURE;
+    }
+
+    intr_config.intrPriority = GPIO_CAPTURE_INTR_PRIORITY;
+
+    for (index = 0UL; index < CY_ARRAY_SIZE(capture_pins); index++)
+    {
+        Cy_GPIO_ClearInterrupt(capture_pins[index].port, capture_pins[index].pin);
+        Cy_GPIO_SetInterruptEdge(capture_pins[index].port, capture_pins[index].pin, CY_GPIO_INTR_BOTH);
+
+        /* Pins on the same port share the interrupt */
+        intr_config.intrSrc = capture_pins[index].irq;
+        if (CY_SYSINT_SUCCESS != Cy_SysInt_Init(&intr_config, &GPIO_CaptureIsr))
+        {
+            return INIT_FAILURE;
+        }
+        NVIC_EnableIRQ(capture_pins[index].irq);
+    }
+
+    return INIT_SUCCESS;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/******************************************************************************
+* File Name: GpioCapture.h
+*
+* Description: This file contains the function prototypes for the GPIO
+*              input-capture event stream.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_GPIOCAPTURE_H_
+#define SOURCE_GPIOCAPTURE_H_
+
+#include "cy_pdl.h"
+#include "cycfg.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Timestamped edge events on input pins, drained by the master in batches.
+ * The pins are those given the aliases CAPTURE0 to CAPTURE3 in the Device
+ * Configurator, configured as inputs. */
+#ifndef GPIO_CAPTURE
+#define GPIO_CAPTURE            (0u)
+#endif
+
+#if (GPIO_CAPTURE != 0u)
+#if (SPI_FRAMING != SPI_FRAMING_COBS)
+#error "GPIO capture requires SPI_FRAMING_COBS"
+#endif
+#if (!defined(CAPTURE0_PORT))
+#error "GPIO capture requires an input pin with the alias CAPTURE0"
+#endif
+#endif
+
+/* Events buffered until the master reads them (power of two) */
+#define GPIO_CAPTURE_EVENTS     (32u)
+
+/* Opcode reading the oldest events */
+#define CMD_GPIO_EVENTS         (0x30u)
+
+/* Execution budget of the event read handler */
+#define GPIO_EVENTS_BUDGET_US   (50u)
+
+/* Reply: opcode, event count, flags, then per event one byte with the pin
+ * index in bits 7:1 and the level after the edge in bit 0, and a 32-bit
+ * little-endian timestamp in microseconds */
+#define GPIO_EVENTS_HEADER_SIZE (3u)
+#define GPIO_EVENT_SIZE         (5u)
+#define GPIO_EVENTS_PER_FRAME   ((SPI_FRAME_MAX_SIZE - GPIO_EVENTS_HEADER_SIZE) / GPIO_EVENT_SIZE)
+
+/* Reply flags */
+#define GPIO_FLAG_OVERFLOW      (0x01u) /* Events were lost since the last read */
+#define GPIO_FLAG_MORE          (0x02u) /* More events are waiting */
+
+/* GPIO interrupt priority, same as the SPI so neither preempts the other */
+#define GPIO_CAPTURE_INTR_PRIORITY (3u)
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (GPIO_CAPTURE != 0u)
+uint32_t gpio_capture_init(void);
+#endif
+
+#endif
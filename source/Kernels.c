@@ -0,0 +1,431 @@
+/******************************************************************************
+* File Name: Kernels.c
+*
+* Description: This file contains function definitions for the copy,
+*              compare, checksum and CRC kernels used on the frame path.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Kernels.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#if (KERNELS_PORTABLE == 0u)
+/* Word access to byte buffers. The Cortex-M0 faults on unaligned word
+ * access, so words are only used when both pointers are aligned. */
+typedef uint32_t __attribute__((__may_alias__)) kernel_word_t;
+
+#define WORD_SIZE               (4u)
+#define WORD_MASK               (WORD_SIZE - 1u)
+#define IS_ALIGNED(p, q)        (0u == ((((uintptr_t)(p)) | ((uintptr_t)(q))) & WORD_MASK))
+#endif
+
+/* Reflected CRC-32 polynomial and CRC-16/CCITT polynomial */
+#define CRC32_POLY              (0xEDB88320UL)
+#define CRC16_POLY              (0x1021u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+#if (KERNELS_PORTABLE == 0u)
+/* Four-bit tables: 96 bytes of flash instead of 1.5 KB for byte tables,
+ * at two lookups per byte */
+static const uint32_t crc32_nibble[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+static const uint16_t crc16_nibble[16] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+#endif
+
+/*******************************************************************************
+* Function Name: kernel_copy
+********************************************************************************
+*
+* Summary:
+*  Copies a buffer, like memcpy(). When both pointers are word aligned, 16
+*  bytes are moved per iteration with word loads and stores, which the
+*  compiler turns into LDM/STM pairs.
+*
+* Parameters:
+*  (void *) dest - Destination, not overlapping the source
+*  (void const *) src - Source
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void kernel_copy(void *dest, void const *src, uint32_t length)
+{
+    uint8_t *d = (uint8_t *)dest;
+    uint8_t const *s = (uint8_t const *)src;
+
+#if (KERNELS_PORTABLE == 0u)
+    kernel_word_t *dw;
+    kernel_word_t const *sw;
+    kernel_word_t w0, w1, w2, w3;
+
+    /* Pointers with the same misalignment are aligned by a byte head */
+    while ((0u != ((uintptr_t)d & WORD_MASK)) && (((uintptr_t)d & WORD_MASK) == ((uintptr_t)s & WORD_MASK)) &&
+           (0UL != length))
+    {
+        *d++ = *s++;
+        length--;
+    }
+
+    if (IS_ALIGNED(d, s))
+    {
+        dw = (kernel_word_t *)(void *)d;
+        sw = (kernel_word_t const *)(void const *)s;
+
+        while (length >= (4UL * WORD_SIZE))
+        {
+            w0 = sw[0];
+            w1 = sw[1];
+            w2 = sw[2];
+            w3 = sw[3];
+            dw[0] = w0;
+            dw[1] = w1;
+            dw[2] = w2;
+            dw[3] = w3;
+            sw += 4;
+            dw += 4;
+            length -= 4UL * WORD_SIZE;
+        }
+
+        while (length >= WORD_SIZE)
+        {
+            *dw++ = *sw++;
+            length -= WORD_SIZE;
+        }
+
+        d = (uint8_t *)dw;
+        s = (uint8_t const *)sw;
+    }
+    else
+    {
+        /* Different misalignment: bytes, four per iteration */
+        while (length >= 4UL)
+        {
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
+            d[3] = s[3];
+            d += 4;
+            s += 4;
+            length -= 4UL;
+        }
+    }
+#endif
+
+    while (0UL != length)
+    {
+        *d++ = *s++;
+        length--;
+    }
+}
+
+/*******************************************************************************
+* Function Name: kernel_equal
+********************************************************************************
+*
+* Summary:
+*  Compares two buffers, a word at a time when both are word aligned.
+*
+* Parameters:
+*  (void const *) a - First buffer
+*  (void const *) b - Second buffer
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  (bool) true if the buffers are equal
+*
+*******************************************************************************/
+bool kernel_equal(void const *a, void const *b, uint32_t length)
+{
+    uint8_t const *pa = (uint8_t const *)a;
+    uint8_t const *pb = (uint8_t const *)b;
+
+#if (KERNELS_PORTABLE == 0u)
+    kernel_word_t const *wa;
+    kernel_word_t const *wb;
+
+    if (IS_ALIGNED(pa, pb))
+    {
+        wa = (kernel_word_t const *)(void const *)pa;
+        wb = (kernel_word_t const *)(void const *)pb;
+
+        while (length >= (2UL * WORD_SIZE))
+        {
+            if ((wa[0] != wb[0]) || (wa[1] != wb[1]))
+            {
+                return false;
+            }
+            wa += 2;
+            wb += 2;
+            length -= 2UL * WORD_SIZE;
+        }
+
+        pa = (uint8_t const *)wa;
+        pb = (uint8_t const *)wb;
+    }
+#endif
+
+    while (0UL != length)
+    {
+        if (*pa++ != *pb++)
+        {
+            return false;
+        }
+        length--;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: kernel_xor
+********************************************************************************
+*
+* Summary:
+*  XORs a buffer into another, such as a keystream into a frame, a word at
+*  a time when both are word aligned.
+*
+* Parameters:
+*  (void *) dest - Buffer updated in place
+*  (void const *) src - Buffer XORed into it
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void kernel_xor(void *dest, void const *src, uint32_t length)
+{
+    uint8_t *d = (uint8_t *)dest;
+    uint8_t const *s = (uint8_t const *)src;
+
+#if (KERNELS_PORTABLE == 0u)
+    kernel_word_t *dw;
+    kernel_word_t const *sw;
+
+    if (IS_ALIGNED(d, s))
+    {
+        dw = (kernel_word_t *)(void *)d;
+        sw = (kernel_word_t const *)(void const *)s;
+
+        while (length >= (2UL * WORD_SIZE))
+        {
+            dw[0] ^= sw[0];
+            dw[1] ^= sw[1];
+            sw += 2;
+            dw += 2;
+            length -= 2UL * WORD_SIZE;
+        }
+
+        d = (uint8_t *)dw;
+        s = (uint8_t const *)sw;
+    }
+#endif
+
+    while (0UL != length)
+    {
+        *d++ ^= *s++;
+        length--;
+    }
+}
+
+/*******************************************************************************
+* Function Name: kernel_sum8
+********************************************************************************
+*
+* Summary:
+*  Returns the sum of the bytes of a buffer. Aligned words are summed two
+*  bytes at a time in 16-bit lanes (bytes 0 and 2, bytes 1 and 3), which
+*  are folded before they can overflow.
+*
+* Parameters:
+*  (void const *) data - Buffer
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  (uint32_t) Sum of the bytes
+*
+*******************************************************************************/
+uint32_t kernel_sum8(void const *data, uint32_t length)
+{
+    uint8_t const *p = (uint8_t const *)data;
+    uint32_t sum = 0UL;
+
+#if (KERNELS_PORTABLE == 0u)
+    kernel_word_t const *w;
+    uint32_t lanes;
+    uint32_t word;
+    uint32_t count;
+
+    while ((0u != ((uintptr_t)p & WORD_MASK)) && (0UL != length))
+    {
+        sum += *p++;
+        length--;
+    }
+
+    w = (kernel_word_t const *)(void const *)p;
+    while (length >= WORD_SIZE)
+    {
+        /* A lane gains at most 2 * 255 per word: 128 words fit in 16 bits */
+        count = length / WORD_SIZE;
+        if (count > 128UL)
+        {
+            count = 128UL;
+        }
+        length -= count * WORD_SIZE;
+
+        lanes = 0UL;
+        while (0UL != count)
+        {
+            word = *w++;
+            lanes += (word & 0x00FF00FFUL) + ((word >> 8u) & 0x00FF00FFUL);
+            count--;
+        }
+        sum += (lanes & 0xFFFFUL) + (lanes >> 16u);
+    }
+    p = (uint8_t const *)w;
+#endif
+
+    while (0UL != length)
+    {
+        sum += *p++;
+        length--;
+    }
+
+    return sum;
+}
+
+/*******************************************************************************
+* Function Name: kernel_crc16
+********************************************************************************
+*
+* Summary:
+*  Updates a CRC-16/CCITT (polynomial 0x1021, not reflected). Start with
+*  KERNEL_CRC16_INIT; the data may be processed in several calls.
+*
+* Parameters:
+*  (uint16_t) crc - CRC so far
+*  (void const *) data - Buffer
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  (uint16_t) Updated CRC
+*
+*******************************************************************************/
+uint16_t kernel_crc16(uint16_t crc, void const *data, uint32_t length)
+{
+    uint8_t const *p = (uint8_t const *)data;
+
+    while (0UL != length)
+    {
+#if (KERNELS_PORTABLE == 0u)
+        crc = (uint16_t)((crc << 4u) ^ crc16_nibble[(crc >> 12u) ^ (*p >> 4u)]);
+        crc = (uint16_t)((crc << 4u) ^ crc16_nibble[(crc >> 12u) ^ (*p & 0x0Fu)]);
+#else
+        uint32_t bit;
+
+        crc ^= (uint16_t)(*p << 8u);
+        for (bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (0u != (crc & 0x8000u)) ? (uint16_t)((crc << 1u) ^ CRC16_POLY) : (uint16_t)(crc << 1u);
+        }
+#endif
+        p++;
+        length--;
+    }
+
+    return crc;
+}
+
+/*******************************************************************************
+* Function Name: kernel_crc32
+********************************************************************************
+*
+* Summary:
+*  Updates a CRC-32 as used by Ethernet and zlib. Start with
+*  KERNEL_CRC32_INIT and pass the result of each call to the next one, so
+*  large areas can be processed in chunks.
+*
+* Parameters:
+*  (uint32_t) crc - CRC so far
+*  (void const *) data - Buffer
+*  (uint32_t) length - Number of bytes
+*
+* Return:
+*  (uint32_t) Updated CRC
+*
+*******************************************************************************/
+uint32_t kernel_crc32(uint32_t crc, void const *data, uint32_t length)
+{
+    uint8_t const *p = (uint8_t const *)data;
+
+    crc = ~crc;
+
+    while (0UL != length)
+    {
+#if (KERNELS_PORTABLE == 0u)
+        crc ^= *p;
+        crc = (crc >> 4u) ^ crc32_nibble[crc & 0x0FUL];
+        crc = (crc >> 4u) ^ crc32_nibble[crc & 0x0FUL];
+#else
+        uint32_t bit;
+
+        crc ^= *p;
+        for (bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (0UL != (crc & 1UL)) ? ((crc >> 1u) ^ CRC32_POLY) : (crc >> 1u);
+        }
+#endif
+        p++;
+        length--;
+    }
+
+    return ~crc;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name: Kernels.h
+*
+* Description: This file contains the function prototypes for the copy,
+*              compare, checksum and CRC kernels used on the frame path.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_KERNELS_H_
+#define SOURCE_KERNELS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Set to 1u to build the plain byte-loop versions, to compare results and
+ * timing. They are the default for compilers without the may_alias
+ * attribute used for word access. */
+#ifndef KERNELS_PORTABLE
+#if (defined(__GNUC__) || defined(__ARMCC_VERSION))
+#define KERNELS_PORTABLE        (0u)
+#else
+#define KERNELS_PORTABLE        (1u)
+#endif
+#endif
+
+/* Initial values */
+#define KERNEL_CRC16_INIT       (0xFFFFu)       /* CRC-16/CCITT-FALSE */
+#define KERNEL_CRC32_INIT       (0x00000000UL)  /* CRC-32 (IEEE 802.3) */
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+void kernel_copy(void *, void const *, uint32_t);
+bool kernel_equal(void const *, void const *, uint32_t);
+void kernel_xor(void *, void const *, uint32_t);
+uint32_t kernel_sum8(void const *, uint32_t);
+uint16_t kernel_crc16(uint16_t, void const *, uint32_t);
+uint32_t kernel_crc32(uint32_t, void const *, uint32_t);
+
+#endif
@@ -0,0 +1,269 @@
+/******************************************************************************
+* File Name: RingBuffer.c
+*
+* Description: This file contains function definitions for the byte ring
+*              buffer.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "RingBuffer.h"
+#include "Kernels.h"
+
+
+/*******************************************************************************
+* Function Name: ring_buffer_init
+********************************************************************************
+*
+* Summary:
+*  Attaches the storage to the ring and empties it.
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to initialize
+*  - (uint8_t *) storage - Backing storage
+*  - (uint16_t) size - Size of the storage, must be a power of two
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void ring_buffer_init(ring_buffer_t *ring, uint8_t *storage, uint16_t size)
+{
+    ring->storage = storage;
+    ring->mask = (uint16_t)(size - 1u);
+    ring->head = 0u;
+    ring->tail = 0u;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_clear
+********************************************************************************
+*
+* Summary:
+*  Discards all data in the ring. Must only be called while neither the
+*  producer nor the consumer is active.
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to clear
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void ring_buffer_clear(ring_buffer_t *ring)
+{
+    ring->tail = ring->head;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_count
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes stored in the ring.
+*
+* Parameters:
+*  - (ring_buffer_t const *) ring - Ring to query
+*
+* Return:
+*  (uint16_t) Number of bytes available to read
+*
+*******************************************************************************/
+uint16_t ring_buffer_count(ring_buffer_t const *ring)
+{
+    return (uint16_t)(ring->head - ring->tail);
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_space
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes that can still be written to the ring.
+*
+* Parameters:
+*  - (ring_buffer_t const *) ring - Ring to query
+*
+* Return:
+*  (uint16_t) Number of free bytes
+*
+*******************************************************************************/
+uint16_t ring_buffer_space(ring_buffer_t const *ring)
+{
+    return (uint16_t)((ring->mask + 1u) - ring_buffer_count(ring));
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_put
+********************************************************************************
+*
+* Summary:
+*  Writes one byte to the ring (producer side).
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to write to
+*  - (uint8_t) byte - Byte to store
+*
+* Return:
+*  (bool) true if stored, false if the ring is full
+*
+*******************************************************************************/
+bool ring_buffer_put(ring_buffer_t *ring, uint8_t byte)
+{
+    uint16_t head = ring->head;
+
+    if ((uint16_t)(head - ring->tail) > ring->mask)
+    {
+        return false;
+    }
+
+    ring->storage[head & ring->mask] = byte;
+    ring->head = (uint16_t)(head + 1u);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_get
+********************************************************************************
+*
+* Summary:
+*  Reads one byte from the ring (consumer side).
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to read from
+*  - (uint8_t *) byte - Location to store the byte read
+*
+* Return:
+*  (bool) true if a byte was read, false if the ring is empty
+*
+*******************************************************************************/
+bool ring_buffer_get(ring_buffer_t *ring, uint8_t *byte)
+{
+    uint16_t tail = ring->tail;
+
+    if (tail == ring->head)
+    {
+        return false;
+    }
+
+    *byte = ring->storage[tail & ring->mask];
+    ring->tail = (uint16_t)(tail + 1u);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_write
+********************************************************************************
+*
+* Summary:
+*  Writes a block of bytes to the ring. The block is either stored
+*  completely or not at all, and becomes visible to the consumer in one
+*  step, so the consumer never sees a partial block.
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to write to
+*  - (uint8_t const *) data - Bytes to store
+*  - (uint16_t) length - Number of bytes to store
+*
+* Return:
+*  (bool) true if stored, false if there is not enough space
+*
+*******************************************************************************/
+bool ring_buffer_write(ring_buffer_t *ring, uint8_t const *data, uint16_t length)
+{
+    uint16_t head = ring->head;
+    uint16_t offset = head & ring->mask;
+    uint16_t first;
+
+    if (length > ring_buffer_space(ring))
+    {
+        return false;
+    }
+
+    /* Up to the end of the storage, then the rest from the start */
+    first = (uint16_t)((ring->mask + 1u) - offset);
+    if (first > length)
+    {
+        first = length;
+    }
+    kernel_copy(&ring->storage[offset], data, first);
+    kernel_copy(ring->storage, &data[first], (uint32_t)length - first);
+
+    ring->head = (uint16_t)(head + length);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: ring_buffer_read
+********************************************************************************
+*
+* Summary:
+*  Reads up to the requested number of bytes from the ring.
+*
+* Parameters:
+*  - (ring_buffer_t *) ring - Ring to read from
+*  - (uint8_t *) data - Destination buffer
+*  - (uint16_t) length - Maximum number of bytes to read
+*
+* Return:
+*  (uint16_t) Number of bytes read
+*
+*******************************************************************************/
+uint16_t ring_buffer_read(ring_buffer_t *ring, uint8_t *data, uint16_t length)
+{
+    uint16_t tail = ring->tail;
+    uint16_t count = ring_buffer_count(ring);
+    uint16_t offset = tail & ring->mask;
+    uint16_t first;
+
+    if (length > count)
+    {
+        length = count;
+    }
+
+    first = (uint16_t)((ring->mask + 1u) - offset);
+    if (first > length)
+    {
+        first = length;
+    }
+    kernel_copy(data, &ring->storage[offset], first);
+    kernel_copy(&data[first], ring->storage, (uint32_t)length - first);
+
+    ring->tail = (uint16_t)(tail + length);
+
+    return length;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/******************************************************************************
+* File Name: RingBuffer.h
+*
+* Description: This file contains the byte ring buffer used to pass data
+*              between the SPI interrupt and the application.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_RINGBUFFER_H_
+#define SOURCE_RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Single-producer, single-consumer byte ring. The producer only updates
+ * head and the consumer only updates tail, so one side may run in an
+ * interrupt without any locking. The storage size must be a power of two. */
+typedef struct
+{
+    uint8_t *storage;
+    uint16_t mask;
+    volatile uint16_t head;
+    volatile uint16_t tail;
+} ring_buffer_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+void ring_buffer_init(ring_buffer_t *, uint8_t *, uint16_t);
+void ring_buffer_clear(ring_buffer_t *);
+uint16_t ring_buffer_count(ring_buffer_t const *);
+uint16_t ring_buffer_space(ring_buffer_t const *);
+bool ring_buffer_put(ring_buffer_t *, uint8_t);
+bool ring_buffer_get(ring_buffer_t *, uint8_t *);
+bool ring_buffer_write(ring_buffer_t *, uint8_t const *, uint16_t);
+uint16_t ring_buffer_read(ring_buffer_t *, uint8_t *, uint16_t);
+
+#endif
@@ -0,0 +1,379 @@
+/******************************************************************************
+* File Name: SpiCrypt.c
+*
+* Description: This file contains the encryption of the SPI frames with a
+*              ChaCha keystream generated ahead of the traffic.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "SpiCrypt.h"
+#include "Command.h"
+#include "Kernels.h"
+
+#if (SPI_CRYPT != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#if ((SPI_CRYPT_WINDOW == 0u) || (SPI_CRYPT_WINDOW > 8u))
+#error "SPI_CRYPT_WINDOW must be 1u to 8u"
+#endif
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Keystream of one stream. Frame n uses the first bytes of block n;
+ * slice n % SPI_CRYPT_WINDOW holds it once generated. */
+typedef struct
+{
+    chacha_key_t key;
+    uint32_t next;                      /* Counter of the next frame */
+    uint32_t tag[SPI_CRYPT_WINDOW];     /* Counter each slice belongs to */
+    uint8_t slice[SPI_CRYPT_WINDOW][SPI_FRAME_MAX_SIZE];
+    uint8_t ready;                      /* Bit per slice, cleared once used */
+} crypt_stream_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const uint8_t crypt_key[CHACHA_KEY_SIZE] = SPI_CRYPT_KEY;
+
+static crypt_stream_t crypt_streams[SPI_CRYPT_STREAMS];
+static bool crypt_active;
+static uint8_t crypt_session_flag;
+static spi_crypt_stats_t crypt_stats;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint8_t const *take_slice(crypt_stream_t *, uint32_t);
+static bool refill(crypt_stream_t *);
+static uint32_t crypt_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/*******************************************************************************
+* Function Name: take_slice
+********************************************************************************
+*
+* Summary:
+*  Returns the keystream of a frame counter, generating it now if it was
+*  not ready. The slice is marked used, so it is never applied twice.
+*
+*******************************************************************************/
+static uint8_t const *take_slice(crypt_stream_t *stream, uint32_t counter)
+{
+    uint32_t slot = counter % SPI_CRYPT_WINDOW;
+    uint8_t bit = (uint8_t)(1u << slot);
+
+    if ((0u == (stream->ready & bit)) || (stream->tag[slot] != counter))
+    {
+        chacha_block(&stream->key, counter, stream->slice[slot], SPI_FRAME_MAX_SIZE);
+        stream->tag[slot] = counter;
+        crypt_stats.misses++;
+    }
+    stream->ready &= (uint8_t)~bit;
+
+    return stream->slice[slot];
+}
+
+/*******************************************************************************
+* Function Name: refill
+********************************************************************************
+*
+* Summary:
+*  Generates the first missing slice of the next SPI_CRYPT_WINDOW frames.
+*  Returns false if they are all ready.
+*
+*******************************************************************************/
+static bool refill(crypt_stream_t *stream)
+{
+    uint32_t counter;
+    uint32_t slot;
+
+    for (counter = stream->next; counter != (stream->next + SPI_CRYPT_WINDOW); counter++)
+    {
+        slot = counter % SPI_CRYPT_WINDOW;
+        if ((0u == (stream->ready & (1u << slot))) || (stream->tag[slot] != counter))
+        {
+            chacha_block(&stream->key, counter, stream->slice[slot], SPI_FRAME_MAX_SIZE);
+            stream->tag[slot] = counter;
+            stream->ready |= (uint8_t)(1u << slot);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: crypt_command
+********************************************************************************
+*
+* Summary:
+*  Starts a session with the nonce of the request. The reply already goes
+*  out encrypted, which tells the master that both ends hold the same key.
+*  While a session is active, only an encrypted request gets here.
+*
+*******************************************************************************/
+static uint32_t crypt_command(uint8_t const *request, uint32_t length,
+                              uint8_t *reply, uint32_t *reply_length)
+{
+    if (length != (COMMAND_PAYLOAD_POS + SPI_CRYPT_NONCE_SIZE))
+    {
+        return COMMAND_FAILURE;
+    }
+
+    spi_crypt_start(&request[COMMAND_PAYLOAD_POS]);
+
+    reply[COMMAND_OPCODE_POS] = CMD_CRYPT_START;
+    *reply_length = 1UL;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_init
+********************************************************************************
+*
+* Summary:
+*  Registers the session command. Until the master starts a session, every
+*  frame to send is dropped and only the session request is accepted.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t spi_crypt_init(void)
+{
+    crypt_active = false;
+
+    if (COMMAND_SUCCESS != command_register(CMD_CRYPT_START, &crypt_command, SPI_TX_CONTROL,
+                                            COMMAND_BUDGET_DEFAULT_US))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_start
+********************************************************************************
+*
+* Summary:
+*  Starts a session: the frame counters of every stream restart at zero
+*  with the nonce given by the master, and the slices of the previous
+*  session are discarded. A restart flips SPI_CRYPT_SESSION_FLAG in the
+*  frames sent from now on.
+*
+* Parameters:
+*  (uint8_t const *) session_nonce - SPI_CRYPT_NONCE_SIZE bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spi_crypt_start(uint8_t const *session_nonce)
+{
+    uint8_t nonce[CHACHA_NONCE_SIZE] = {0u};
+    uint32_t index;
+
+    kernel_copy(&nonce[CHACHA_NONCE_SIZE - SPI_CRYPT_NONCE_SIZE], session_nonce, SPI_CRYPT_NONCE_SIZE);
+
+    for (index = 0UL; index < SPI_CRYPT_STREAMS; index++)
+    {
+        nonce[0] = (uint8_t)index;
+        chacha_init(&crypt_streams[index].key, crypt_key, nonce);
+        crypt_streams[index].next = 0UL;
+        crypt_streams[index].ready = 0u;
+    }
+
+    crypt_session_flag = crypt_active ? (uint8_t)(crypt_session_flag ^ SPI_CRYPT_SESSION_FLAG) : 0u;
+    crypt_active = true;
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_encrypt
+********************************************************************************
+*
+* Summary:
+*  Builds the encrypted form of a frame to send: identifier, TX class and
+*  session flag, low byte of the counter, then the frame XORed with its
+*  keystream slice.
+*  Each class counts its own frames, so the counters stay in sequence
+*  when a frame of a higher class overtakes the frames queued before it.
+*
+* Parameters:
+*  (uint32_t) tx_class - SPI_TX_CONTROL, SPI_TX_BULK or SPI_TX_LOG
+*  (uint8_t *) out - Encrypted frame, length + SPI_CRYPT_OVERHEAD bytes
+*  (uint8_t const *) frame - Frame, at most SPI_FRAME_MAX_SIZE bytes
+*  (uint32_t) length - Length of the frame
+*
+* Return:
+*  (uint32_t) Length of the encrypted frame, or 0 without a session
+*
+*******************************************************************************/
+uint32_t spi_crypt_encrypt(uint32_t tx_class, uint8_t *out, uint8_t const *frame, uint32_t length)
+{
+    crypt_stream_t *stream = &crypt_streams[SPI_CRYPT_TO_MASTER + tx_class];
+    uint32_t counter = stream->next;
+
+    if (!crypt_active)
+    {
+        crypt_stats.no_session++;
+        return 0UL;
+    }
+
+    stream->next++;
+
+    out[0] = (uint8_t)((SPI_CRYPT_FRAME_ID + tx_class) | crypt_session_flag);
+    out[SPI_CRYPT_SEQ_POS] = (uint8_t)counter;
+    kernel_copy(&out[SPI_CRYPT_DATA_POS], frame, length);
+    kernel_xor(&out[SPI_CRYPT_DATA_POS], take_slice(stream, counter), length);
+    crypt_stats.encrypted++;
+
+    return length + SPI_CRYPT_DATA_POS;
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_decrypt
+********************************************************************************
+*
+* Summary:
+*  Decrypts a received frame in place. The full counter is recovered from
+*  its low byte, allowing up to SPI_CRYPT_MAX_GAP lost frames; an older
+*  counter is a replay and is rejected. A frame in clear is accepted only
+*  if it is a session request and no session is active, so a restart
+*  cannot bring back the counters of a nonce already used.
+*
+* Parameters:
+*  (uint8_t *) frame - Received frame
+*  (uint32_t *) length - Received length, replaced by the decrypted length
+*
+* Return:
+*  (uint8_t *) Decrypted frame within the buffer, or NULL if rejected
+*
+*******************************************************************************/
+uint8_t *spi_crypt_decrypt(uint8_t *frame, uint32_t *length)
+{
+    crypt_stream_t *stream = &crypt_streams[SPI_CRYPT_TO_SLAVE];
+    uint32_t gap;
+    uint32_t counter;
+
+    if (frame[0] != SPI_CRYPT_FRAME_ID)
+    {
+        if ((!crypt_active) && (frame[0] == CMD_CRYPT_START) &&
+            (*length == (COMMAND_PAYLOAD_POS + SPI_CRYPT_NONCE_SIZE)))
+        {
+            return frame;
+        }
+        crypt_stats.rejected++;
+        return NULL;
+    }
+
+    gap = (uint8_t)(frame[SPI_CRYPT_SEQ_POS] - (uint8_t)stream->next);
+    if ((!crypt_active) || (*length <= SPI_CRYPT_DATA_POS) || (gap > SPI_CRYPT_MAX_GAP))
+    {
+        crypt_stats.rejected++;
+        return NULL;
+    }
+
+    counter = stream->next + gap;
+    stream->next = counter + 1UL;
+
+    *length -= SPI_CRYPT_DATA_POS;
+    kernel_xor(&frame[SPI_CRYPT_DATA_POS], take_slice(stream, counter), *length);
+    crypt_stats.decrypted++;
+
+    return &frame[SPI_CRYPT_DATA_POS];
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_poll
+********************************************************************************
+*
+* Summary:
+*  Generates one keystream slice while the link is idle, for the next
+*  frames to send first, by class priority, then for the next frames to
+*  receive. One block per call keeps the main loop responsive.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spi_crypt_poll(void)
+{
+    uint32_t tx_class;
+
+    if (crypt_active && is_link_idle())
+    {
+        for (tx_class = 0UL; tx_class < SPI_TX_CLASSES; tx_class++)
+        {
+            if (refill(&crypt_streams[SPI_CRYPT_TO_MASTER + tx_class]))
+            {
+                return;
+            }
+        }
+        (void) refill(&crypt_streams[SPI_CRYPT_TO_SLAVE]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: spi_crypt_get_stats
+********************************************************************************
+*
+* Summary:
+*  Copies the encryption statistics. The misses show whether the idle time
+*  is enough to generate the keystream ahead of the traffic.
+*
+* Parameters:
+*  (spi_crypt_stats_t *) stats - Destination
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void spi_crypt_get_stats(spi_crypt_stats_t *stats)
+{
+    *stats = crypt_stats;
+}
+
+#endif
+
+/* [] END OF FILE */
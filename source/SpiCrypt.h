@@ -0,0 +1,141 @@
+/******************************************************************************
+* File Name: SpiCrypt.h
+*
+* Description: This file contains the macros and function prototypes of the
+*              optional encryption of the SPI frames.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_SPICRYPT_H_
+#define SOURCE_SPICRYPT_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+#include "ChaCha.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Encrypt the frames in both directions with ChaCha, against snooping on
+ * the bus. The frames are not authenticated. */
+#ifndef SPI_CRYPT
+#define SPI_CRYPT               (0u)
+#endif
+
+#if ((SPI_CRYPT != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "SPI frame encryption requires SPI_FRAMING_COBS"
+#endif
+
+#if ((SPI_CRYPT != 0u) && (SPI_FRAME_MAX_SIZE > CHACHA_BLOCK_SIZE))
+#error "SPI frame encryption uses one keystream block per frame"
+#endif
+
+/* Key shared with the master, 32 bytes. Replace it for each product. */
+#ifndef SPI_CRYPT_KEY
+#define SPI_CRYPT_KEY                                                       \
+    {                                                                       \
+        0x00u, 0x01u, 0x02u, 0x03u, 0x04u, 0x05u, 0x06u, 0x07u,             \
+        0x08u, 0x09u, 0x0Au, 0x0Bu, 0x0Cu, 0x0Du, 0x0Eu, 0x0Fu,             \
+        0x10u, 0x11u, 0x12u, 0x13u, 0x14u, 0x15u, 0x16u, 0x17u,             \
+        0x18u, 0x19u, 0x1Au, 0x1Bu, 0x1Cu, 0x1Du, 0x1Eu, 0x1Fu              \
+    }
+#endif
+
+/* Opcode starting a session. Request: opcode and an 8-byte nonce the
+ * master never uses twice with the same key, in clear while no session
+ * is active, otherwise encrypted with the current session. Reply,
+ * encrypted with the new session: the opcode. */
+#define CMD_CRYPT_START         (0xB0u)
+#define SPI_CRYPT_NONCE_SIZE    (8u)
+
+/* Encrypted frame: identifier, plus the TX class in frames of the slave,
+ * low byte of the frame counter of its stream, then the frame XORed with
+ * the keystream block of the counter */
+#define SPI_CRYPT_FRAME_ID      (0xE0u)
+
+/* Set in the identifier of the frames of the slave in every other session,
+ * so the master drops those of the previous session still queued */
+#define SPI_CRYPT_SESSION_FLAG  (0x04u)
+#define SPI_CRYPT_SEQ_POS       (1u)
+#define SPI_CRYPT_DATA_POS      (2u)
+
+/* Bytes added to each frame on the wire */
+#if (SPI_CRYPT != 0u)
+#define SPI_CRYPT_OVERHEAD      (SPI_CRYPT_DATA_POS)
+#else
+#define SPI_CRYPT_OVERHEAD      (0u)
+#endif
+
+/* Keystreams, each with its own frame counter, told apart by the first
+ * nonce byte: the frames of the master, then those of the slave, one per
+ * TX class, as the classes do not go out in the order they are queued */
+#define SPI_CRYPT_TO_SLAVE      (0u)
+#define SPI_CRYPT_TO_MASTER     (1u)    /* Plus the TX class */
+#define SPI_CRYPT_STREAMS       (SPI_CRYPT_TO_MASTER + SPI_TX_CLASSES)
+
+/* Keystream slices generated ahead, per stream. A frame finding its
+ * slice ready costs only the XOR. */
+#ifndef SPI_CRYPT_WINDOW
+#define SPI_CRYPT_WINDOW        (4u)
+#endif
+
+/* Frames of a stream that may be lost before the counter can no longer
+ * be recovered from its low byte */
+#define SPI_CRYPT_MAX_GAP       (127u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t encrypted;                 /* Frames sent */
+    uint32_t decrypted;                 /* Frames received */
+    uint32_t rejected;                  /* Received in clear or out of sequence */
+    uint32_t no_session;                /* Not sent, no session started */
+    uint32_t misses;                    /* Slices generated in the frame path */
+} spi_crypt_stats_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (SPI_CRYPT != 0u)
+uint32_t spi_crypt_init(void);
+void spi_crypt_start(uint8_t const *);
+uint32_t spi_crypt_encrypt(uint32_t, uint8_t *, uint8_t const *, uint32_t);
+uint8_t *spi_crypt_decrypt(uint8_t *, uint32_t *);
+void spi_crypt_poll(void);
+void spi_crypt_get_stats(spi_crypt_stats_t *);
+#endif
+
+#endif
@@ -37,32 +37,436 @@
 * so agrees to indemnify Cypress against all liability.
 *******************************************************************************/
 #include "SpiSlave.h"
+#include "Cobs.h"
+#include "RingBuffer.h"
+#include "Kernels.h"
+#include "SysTimer.h"
+#include "CritSection.h"
+#include "ClockGovernor.h"
+#include "Transport.h"
+#include "SpiCrypt.h"
+#include "Benchmark.h"
 
 
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
-cy_stc_scb_spi_context_t sSPI_context;
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/* Raw bytes from the RX FIFO, decoded by read_frame() */
+static uint8_t rx_ring_storage[SPI_RX_RING_SIZE];
+static ring_buffer_t rx_ring;
 
-/* Assign SPI interrupt number and priority */
-#define sSPI_INTR_PRIORITY   (3U)
+/* Encoded frames waiting for the TX FIFO, one ring per class */
+static uint8_t tx_control_storage[SPI_TX_CONTROL_RING_SIZE];
+static uint8_t tx_bulk_storage[SPI_TX_BULK_RING_SIZE];
+static uint8_t tx_log_storage[SPI_TX_LOG_RING_SIZE];
+static ring_buffer_t tx_rings[SPI_TX_CLASSES];
+
+static const uint8_t tx_depth[SPI_TX_CLASSES] =
+{
+    SPI_TX_CONTROL_DEPTH, SPI_TX_BULK_DEPTH, SPI_TX_LOG_DEPTH
+};
+
+/* Frames queued and frames sent per class; each counter has one writer,
+ * so their difference is the depth without a critical section */
+static uint32_t tx_queued[SPI_TX_CLASSES];
+static volatile uint32_t tx_sent[SPI_TX_CLASSES];
+
+/* Frames the weighted classes may still send in this round */
+static uint32_t tx_bulk_credit;
+static uint32_t tx_log_credit;
+
+/* Class whose frame is being sent, SPI_TX_CLASSES between frames */
+static uint32_t tx_current_class;
+
+/* Decoder state and the frame being decoded, encrypted with SPI_CRYPT */
+static uint8_t rx_frame[SPI_FRAME_MAX_SIZE + SPI_CRYPT_OVERHEAD];
+static cobs_decoder_t rx_decoder;
+
+/* Set by the ISR when received bytes were lost */
+static volatile bool rx_resync;
+
+static volatile spi_stream_stats_t stream_stats;
+
+/* Frame completion notification */
+static spi_frame_callback_t frame_callback;
+static bool rx_in_frame;                /* Non-delimiter byte seen since the last delimiter */
+static bool rx_idle_stored;             /* Last byte stored in the RX ring is a delimiter */
+
+/* Arrival time of each frame, with the RX ring position just past its
+ * closing delimiter so read_frame() can match it to the decoded frame */
+static uint16_t rx_stamp_pos[SPI_RX_TIMESTAMP_SLOTS];
+static uint32_t rx_stamp_us[SPI_RX_TIMESTAMP_SLOTS];
+static volatile uint8_t rx_stamp_head;
+static volatile uint8_t rx_stamp_tail;
+static uint32_t frame_timestamp;        /* Of the frame last returned */
+
+#if (BENCHMARK != 0u)
+/* Fastest and slowest SPI interrupt entries, in cycles with the timer reads */
+static uint32_t isr_cycles_min = UINT32_MAX;
+static uint32_t isr_cycles_max;
+#endif
+
+#if (SPI_COALESCE != 0u)
+static volatile uint32_t frames_unnotified;
+static uint32_t first_unnotified_ms;    /* Arrival time of the oldest one */
+#endif
+#elif (SPI_DAISY_CHAIN_LENGTH > 1u)
+/* Daisy-chain transaction in progress */
+static uint8_t *chain_rx_buffer;        /* Own packet is stored here */
+static uint32_t chain_forward_size;     /* Bytes forwarded downstream */
+static uint32_t chain_total_size;       /* Bytes in the whole transaction */
+static volatile uint32_t chain_count;   /* Bytes received so far */
+static volatile bool chain_active;
+#elif (SPI_MULTIDROP != 0u)
+/* Flash row holding the slave address. It is kept in a row of its own so
+ * it can be rewritten without touching the application image. */
+CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const volatile uint8_t slave_address_row[CY_FLASH_SIZEOF_ROW] = {SPI_SLAVE_ADDRESS};
+
+/* Copy of the address compared in the ISR */
+static uint8_t slave_address;
+
+/* Multi-drop packet in progress */
+static uint8_t *drop_rx_buffer;
+static uint8_t *drop_tx_buffer;
+static uint32_t drop_size;
+static volatile uint32_t drop_count;
+static volatile bool drop_active;
+static bool drop_ignore;                /* Packet addressed to another slave */
+#endif
 
 /*******************************************************************************
  * Function declaration
  ******************************************************************************/
 static void SPI_Isr(void);
+#if (BENCHMARK != 0u)
+static void SPI_TimedIsr(void);
+#endif
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+static uint32_t next_tx_class(void);
+static uint8_t next_tx_byte(void);
+static uint32_t take_rx_timestamp(void);
+#endif
+#if (SPI_COALESCE != 0u)
+static void SPI_CoalesceTick(void);
+#endif
 
 /*******************************************************************************
  * Function Name: sSPI_Interrupt
  *******************************************************************************
  *
- * Invokes the Cy_SCB_SPI_Interrupt() PDL driver function.
+ * Services the transfer of the PDL driver through transport_service(). With
+ * COBS framing the FIFOs are serviced directly instead: received bytes are moved
+ * to the RX ring and the TX FIFO is topped up from the TX rings, padded with
+ * delimiters while there is nothing to send. Every frame completed in the
+ * FIFO is counted, and the application is notified once per entry, or once
+ * per batch with interrupt coalescing.
  *
  *******************************************************************************/
 static void SPI_Isr(void)
 {
-    Cy_SCB_SPI_Interrupt(sSPI_HW, &sSPI_context);
+#if ((CLOCK_GOVERNOR != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+    /* Every interrupt belongs to a transaction */
+    clock_governor_activity();
+#endif
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    uint32_t fifo_size = transport_fifo_size();
+    uint32_t frames = 0UL;
+    uint8_t byte;
+    uint8_t stamp_head;
+    bool stored;
+
+    stream_stats.interrupts++;
+
+    while (0UL != transport_rx_count())
+    {
+        byte = transport_read();
+
+        /* Idle fill clocked by a polling master is not queued: one
+         * delimiter in the ring separates frames as well as many */
+        if ((byte == COBS_DELIMITER) && (!rx_in_frame) && rx_idle_stored)
+        {
+            continue;
+        }
+
+        stored = ring_buffer_put(&rx_ring, byte);
+        if (!stored)
+        {
+            stream_stats.rx_overflows++;
+            rx_resync = true;
+        }
+        rx_idle_stored = stored && (byte == COBS_DELIMITER);
+
+        if (byte != COBS_DELIMITER)
+        {
+            rx_in_frame = true;
+        }
+        else if (rx_in_frame)
+        {
+            rx_in_frame = false;
+            frames++;
+
+            stamp_head = rx_stamp_head;
+            if (stored && ((uint8_t)(stamp_head - rx_stamp_tail) < SPI_RX_TIMESTAMP_SLOTS))
+            {
+                rx_stamp_pos[stamp_head % SPI_RX_TIMESTAMP_SLOTS] = rx_ring.head;
+                rx_stamp_us[stamp_head % SPI_RX_TIMESTAMP_SLOTS] = systimer_get_us();
+                rx_stamp_head = (uint8_t)(stamp_head + 1u);
+            }
+        }
+        else
+        {
+            /* Idle fill between frames */
+        }
+    }
+
+    if (transport_clear_rx_status())
+    {
+        /* The hardware FIFO overflowed before the ISR ran */
+        stream_stats.rx_overflows++;
+        rx_resync = true;
+    }
+
+    while (transport_tx_count() < fifo_size)
+    {
+        transport_write(next_tx_byte());
+    }
+
+#if (CLOCK_GOVERNOR != 0u)
+    /* Idle delimiters clocked by the master do not count as activity */
+    if ((0UL != frames) || rx_in_frame || (SPI_TX_CLASSES != tx_current_class))
+    {
+        clock_governor_activity();
+    }
+#endif
+
+#if (SPI_COALESCE != 0u)
+    if (0UL != frames)
+    {
+        if (0UL == frames_unnotified)
+        {
+            first_unnotified_ms = systimer_get_ms();
+        }
+        frames_unnotified += frames;
+    }
+
+    frames = 0UL;
+    if ((frames_unnotified >= SPI_COALESCE_BATCH) ||\
+        ((0UL != frames_unnotified) &&\
+         ((systimer_get_ms() - first_unnotified_ms) >= SPI_COALESCE_MAX_LATENCY_MS)))
+    {
+        frames = frames_unnotified;
+        frames_unnotified = 0UL;
+    }
+#endif
+
+    if ((0UL != frames) && (NULL != frame_callback))
+    {
+        stream_stats.notifications++;
+        frame_callback(frames);
+    }
+#elif (SPI_DAISY_CHAIN_LENGTH > 1u)
+    uint8_t byte;
+
+    /* Everything before the last packet belongs to slaves further down the
+     * chain: pass it straight to the TX FIFO behind our own packet, which
+     * delays it by exactly one packet. The last packet is ours. */
+    while (chain_active && (0UL != transport_rx_count()))
+    {
+        byte = transport_read();
+
+        if (chain_count < chain_forward_size)
+        {
+            transport_write(byte);
+        }
+        else
+        {
+            chain_rx_buffer[chain_count - chain_forward_size] = byte;
+        }
+
+        chain_count++;
+
+        if (chain_count == chain_total_size)
+        {
+            chain_active = false;
+            transport_set_rx_interrupt(false, 0UL);
+        }
+    }
+
+    (void) transport_clear_rx_status();
+#elif (SPI_MULTIDROP != 0u)
+    uint8_t byte;
+
+    while (drop_active && (0UL != transport_rx_count()))
+    {
+        byte = transport_read();
+
+        if (!drop_ignore)
+        {
+            drop_rx_buffer[drop_count] = byte;
+        }
+
+        if (drop_count == PACKET_ADDR_POS)
+        {
+            if (byte == slave_address)
+            {
+                /* Only the addressed slave drives the shared MISO line */
+                transport_drive_miso(true);
+            }
+            else if (byte != SPI_BROADCAST_ADDRESS)
+            {
+                drop_ignore = true;
+            }
+            else
+            {
+                /* Broadcast: accept the packet but leave MISO released */
+            }
+        }
+
+        drop_count++;
+
+        if (drop_count == drop_size)
+        {
+            transport_drive_miso(false);
+
+            if (drop_ignore)
+            {
+                /* Not ours: re-arm for the next packet without waking the
+                 * application. The status packet was shifted out unseen and
+                 * is queued again. */
+                transport_clear_tx();
+                transport_write_array(drop_tx_buffer, drop_size);
+                drop_count = 0UL;
+                drop_ignore = false;
+            }
+            else
+            {
+                drop_active = false;
+                transport_set_rx_interrupt(false, 0UL);
+            }
+        }
+    }
+
+    (void) transport_clear_rx_status();
+#else
+    transport_service();
+#endif
+}
+
+#if (BENCHMARK != 0u)
+/*******************************************************************************
+ * Function Name: SPI_TimedIsr
+ *******************************************************************************
+ *
+ * Runs SPI_Isr() and keeps its fastest and slowest entries for the
+ * benchmark. An entry that the SysTick interrupt lands in includes it.
+ *
+ *******************************************************************************/
+static void SPI_TimedIsr(void)
+{
+    uint32_t start = systimer_get_cycles();
+    uint32_t elapsed;
+
+    SPI_Isr();
+
+    elapsed = systimer_get_cycles() - start;
+    isr_cycles_min = (elapsed < isr_cycles_min) ? elapsed : isr_cycles_min;
+    isr_cycles_max = (elapsed > isr_cycles_max) ? elapsed : isr_cycles_max;
 }
+#endif
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/*******************************************************************************
+ * Function Name: next_tx_class
+ *******************************************************************************
+ *
+ * Picks the class of the next frame: control if one is waiting, otherwise
+ * bulk and log in turn by weight. Credits are refilled once no class with
+ * frames waiting has any left, so an idle class does not build up a burst.
+ * Returns SPI_TX_CLASSES if nothing is waiting.
+ *
+ *******************************************************************************/
+static uint32_t next_tx_class(void)
+{
+    bool bulk_waiting = (0u != ring_buffer_count(&tx_rings[SPI_TX_BULK]));
+    bool log_waiting = (0u != ring_buffer_count(&tx_rings[SPI_TX_LOG]));
+
+    if (0u != ring_buffer_count(&tx_rings[SPI_TX_CONTROL]))
+    {
+        return SPI_TX_CONTROL;
+    }
+
+    if (!(bulk_waiting && (0UL != tx_bulk_credit)) && !(log_waiting && (0UL != tx_log_credit)))
+    {
+        tx_bulk_credit = SPI_TX_BULK_WEIGHT;
+        tx_log_credit = SPI_TX_LOG_WEIGHT;
+    }
+
+    if (bulk_waiting && (0UL != tx_bulk_credit))
+    {
+        tx_bulk_credit--;
+        return SPI_TX_BULK;
+    }
+
+    if (log_waiting && (0UL != tx_log_credit))
+    {
+        tx_log_credit--;
+        return SPI_TX_LOG;
+    }
+
+    return SPI_TX_CLASSES;
+}
+
+/*******************************************************************************
+ * Function Name: next_tx_byte
+ *******************************************************************************
+ *
+ * Returns the next byte for the TX FIFO. A frame is always sent to its
+ * end before another class is picked, and a delimiter is sent while
+ * nothing is waiting.
+ *
+ *******************************************************************************/
+static uint8_t next_tx_byte(void)
+{
+    uint8_t byte = COBS_DELIMITER;
+
+    if (SPI_TX_CLASSES == tx_current_class)
+    {
+        tx_current_class = next_tx_class();
+    }
+
+    if ((SPI_TX_CLASSES != tx_current_class) && ring_buffer_get(&tx_rings[tx_current_class], &byte))
+    {
+        if (byte == COBS_DELIMITER)
+        {
+            tx_sent[tx_current_class]++;
+            tx_current_class = SPI_TX_CLASSES;
+        }
+    }
+
+    return byte;
+}
+#endif
+
+#if (SPI_COALESCE != 0u)
+/*******************************************************************************
+ * Function Name: SPI_CoalesceTick
+ *******************************************************************************
+ *
+ * SysTick callback. Bytes below the RX FIFO trigger level and frames not
+ * yet reported do not raise an interrupt by themselves, so the SPI
+ * interrupt is pended to process them within the latency bound.
+ *
+ *******************************************************************************/
+static void SPI_CoalesceTick(void)
+{
+    if ((0UL != transport_rx_count()) || (0UL != frames_unnotified))
+    {
+        transport_pend_interrupt();
+    }
+}
+#endif
 
 /*******************************************************************************
 * Function Name: init_slave
@@ -70,7 +474,8 @@ static void SPI_Isr(void)
 *
 * Summary:
 *  This function initializes the SPI Slave based on the
-*  configuration done in design.modus file.
+*  configuration done in design.modus file, or the host transport.
+*  With interrupt coalescing, the system timer must already be running.
 *
 * Parameters:
 *  None
@@ -81,46 +486,397 @@ static void SPI_Isr(void)
 ******************************************************************************/
 uint32_t init_slave(void)
 {
-    cy_en_scb_spi_status_t spi_status;
-    cy_en_sysint_status_t intr_status;
+    /* Configure the SPI block and hook the interrupt service routine */
+#if (BENCHMARK != 0u)
+    if (INIT_SUCCESS != transport_init(&SPI_TimedIsr))
+#else
+    if (INIT_SUCCESS != transport_init(&SPI_Isr))
+#endif
+    {
+        return(INIT_FAILURE);
+    }
 
-    /* Configure the SPI block */
-    spi_status = Cy_SCB_SPI_Init(sSPI_HW, &sSPI_config, &sSPI_context);
+#if (SPI_MULTIDROP != 0u)
+    /* Release MISO until a packet addressed to this slave arrives */
+    transport_drive_miso(false);
+    slave_address = get_slave_address();
+#endif
 
-    /* If the initialization fails, return failure status */
-    if(spi_status != CY_SCB_SPI_SUCCESS)
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    ring_buffer_init(&rx_ring, rx_ring_storage, SPI_RX_RING_SIZE);
+    ring_buffer_init(&tx_rings[SPI_TX_CONTROL], tx_control_storage, SPI_TX_CONTROL_RING_SIZE);
+    ring_buffer_init(&tx_rings[SPI_TX_BULK], tx_bulk_storage, SPI_TX_BULK_RING_SIZE);
+    ring_buffer_init(&tx_rings[SPI_TX_LOG], tx_log_storage, SPI_TX_LOG_RING_SIZE);
+    tx_current_class = SPI_TX_CLASSES;
+    rx_stamp_head = 0u;
+    rx_stamp_tail = 0u;
+    cobs_decoder_init(&rx_decoder, rx_frame, sizeof(rx_frame));
+
+    /* Start with the TX FIFO full of delimiters so the master reads an
+     * idle link, and take an interrupt for every received byte */
+    transport_clear_tx();
+    while (transport_tx_count() < transport_fifo_size())
     {
-        return(INIT_FAILURE);
+        transport_write(COBS_DELIMITER);
+    }
+#if (SPI_COALESCE != 0u)
+    /* Interrupt only once the RX FIFO is half full; the rest is picked up
+     * by the SysTick flush */
+    transport_set_rx_interrupt(true, (transport_fifo_size() / 2UL) - 1UL);
+    (void) Cy_SysTick_SetCallback(SPI_COALESCE_TICK_SLOT, &SPI_CoalesceTick);
+#else
+    transport_set_rx_interrupt(true, 0UL);
+#endif
+#endif
+
+    /* Enable the interrupt and the SPI Slave block */
+    transport_enable();
+
+    /* Initialization completed */
+    return(INIT_SUCCESS);
+}
+
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/******************************************************************************
+* Function Name: read_frame
+*******************************************************************************
+*
+* Summary:
+*  This function decodes the bytes received so far and returns the next
+*  complete frame. It does not block: if no complete frame is available,
+*  the partial frame is kept and decoding resumes on the next call.
+*  After an error the decoder skips to the next delimiter, so the stream
+*  is resynchronised within one frame. With SPI_CRYPT the frame is
+*  decrypted, and a frame that fails decryption is dropped as malformed.
+*
+* Parameters:
+*  - (uint8_t *) frame - Buffer to store the decoded frame
+*  - (uint32_t) size - Size of the buffer
+*  - (uint32_t *) length - Length of the decoded frame
+*
+* Return:
+*  - (uint32_t) - TRANSFER_COMPLETE if a frame was decoded, TRANSFER_PENDING
+*                 if more bytes are needed or TRANSFER_FAILURE if a
+*                 malformed frame was dropped
+*
+******************************************************************************/
+uint32_t read_frame(uint8_t *frame, uint32_t size, uint32_t *length)
+{
+    uint8_t const *plain;
+    uint32_t plain_length;
+    uint8_t byte;
+    crit_state_t crit_state;
+    bool resync;
+
+    /* Test and clear together so a loss reported meanwhile is not missed */
+    CRIT_SECTION_ENTER(crit_state);
+    resync = rx_resync;
+    rx_resync = false;
+    CRIT_SECTION_EXIT(crit_state);
+
+    if (resync)
+    {
+        cobs_decoder_resync(&rx_decoder);
+    }
+
+    while (ring_buffer_get(&rx_ring, &byte))
+    {
+        switch (cobs_decode_byte(&rx_decoder, byte))
+        {
+            case COBS_DECODE_COMPLETE:
+                plain = rx_frame;
+                plain_length = rx_decoder.length;
+#if (SPI_CRYPT != 0u)
+                if (0UL != plain_length)
+                {
+                    plain = spi_crypt_decrypt(rx_frame, &plain_length);
+                }
+#endif
+                if ((NULL == plain) || (plain_length == 0u) || (plain_length > size))
+                {
+                    stream_stats.frame_errors++;
+                    return TRANSFER_FAILURE;
+                }
+
+                kernel_copy(frame, plain, plain_length);
+                *length = plain_length;
+                stream_stats.frames++;
+                frame_timestamp = take_rx_timestamp();
+                return TRANSFER_COMPLETE;
+
+            case COBS_DECODE_ERROR:
+                stream_stats.frame_errors++;
+                return TRANSFER_FAILURE;
+
+            default:
+                break;
+        }
+    }
+
+    return TRANSFER_PENDING;
+}
+
+/*******************************************************************************
+* Function Name: take_rx_timestamp
+********************************************************************************
+*
+* Summary:
+*  Returns the arrival time of the frame whose delimiter was just decoded.
+*  Entries of frames dropped by the decoder are discarded on the way. If
+*  the frame has no entry, because the timestamp slots were full, the
+*  current time is returned.
+*
+*******************************************************************************/
+static uint32_t take_rx_timestamp(void)
+{
+    uint16_t pos = rx_ring.tail;
+    uint8_t tail = rx_stamp_tail;
+    uint8_t slot;
+    uint32_t timestamp = systimer_get_us();
+
+    while (tail != rx_stamp_head)
+    {
+        slot = tail % SPI_RX_TIMESTAMP_SLOTS;
+
+        if ((int16_t)(pos - rx_stamp_pos[slot]) < 0)
+        {
+            /* Belongs to a frame still in the RX ring */
+            break;
+        }
+
+        tail = (uint8_t)(tail + 1u);
+
+        if (rx_stamp_pos[slot] == pos)
+        {
+            timestamp = rx_stamp_us[slot];
+            break;
+        }
     }
 
-    /* Set active slave select to line 0 */
-    Cy_SCB_SPI_SetActiveSlaveSelect(sSPI_HW, CY_SCB_SPI_SLAVE_SELECT0);
+    rx_stamp_tail = tail;
 
-    /* Populate configuration structure */
-    const cy_stc_sysint_t spi_intr_config =
+    return timestamp;
+}
+
+/******************************************************************************
+* Function Name: get_frame_timestamp
+*******************************************************************************
+*
+* Summary:
+*  This function returns the time the last frame returned by read_frame()
+*  was received, taken in the SPI interrupt when its delimiter arrived.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  - (uint32_t) - Receive time in microseconds, see systimer_get_us()
+*
+******************************************************************************/
+uint32_t get_frame_timestamp(void)
+{
+    return frame_timestamp;
+}
+
+/******************************************************************************
+* Function Name: write_frame
+*******************************************************************************
+*
+* Summary:
+*  This function queues a control frame, such as the reply to a command.
+*  It is the same as write_class_frame() with SPI_TX_CONTROL.
+*
+* Parameters:
+*  - (uint8_t const *) frame - Frame to send
+*  - (uint32_t) length - Length of the frame
+*
+* Return:
+*  - (uint32_t) - TRANSFER_COMPLETE if the frame was queued or
+*                 TRANSFER_FAILURE if it was dropped
+*
+******************************************************************************/
+uint32_t write_frame(uint8_t const *frame, uint32_t length)
+{
+    return write_class_frame(SPI_TX_CONTROL, frame, length);
+}
+
+/******************************************************************************
+* Function Name: write_class_frame
+*******************************************************************************
+*
+* Summary:
+*  This function encodes a frame and queues it in the ring of its class.
+*  The frame is placed in the ring as a whole, so it is never interleaved
+*  with idle delimiters or frames of other classes. A frame that is too
+*  long, or that exceeds the depth or the ring of its class, is dropped
+*  and counted. With SPI_CRYPT the frame is encrypted first, and dropped
+*  while no session is started.
+*
+* Parameters:
+*  - (uint32_t) tx_class - SPI_TX_CONTROL, SPI_TX_BULK or SPI_TX_LOG
+*  - (uint8_t const *) frame - Frame to send
+*  - (uint32_t) length - Length of the frame
+*
+* Return:
+*  - (uint32_t) - TRANSFER_COMPLETE if the frame was queued or
+*                 TRANSFER_FAILURE if it was dropped
+*
+******************************************************************************/
+uint32_t write_class_frame(uint32_t tx_class, uint8_t const *frame, uint32_t length)
+{
+#if (SPI_CRYPT != 0u)
+    uint8_t sealed[SPI_FRAME_MAX_SIZE + SPI_CRYPT_OVERHEAD];
+#endif
+    uint8_t encoded[COBS_ENCODED_MAX(SPI_FRAME_MAX_SIZE + SPI_CRYPT_OVERHEAD) + 1u];
+    uint32_t encoded_length;
+
+    if (tx_class >= SPI_TX_CLASSES)
     {
-        .intrSrc      = sSPI_IRQ,
-        .intrPriority = sSPI_INTR_PRIORITY,
-    };
+        return TRANSFER_FAILURE;
+    }
 
-    /* Hook interrupt service routine and enable interrupt */
-    intr_status = Cy_SysInt_Init(&spi_intr_config, &SPI_Isr);
+    if ((length == 0u) || (length > SPI_FRAME_MAX_SIZE) ||
+        ((tx_queued[tx_class] - tx_sent[tx_class]) >= tx_depth[tx_class]))
+    {
+        stream_stats.tx_drops[tx_class]++;
+        return TRANSFER_FAILURE;
+    }
 
-    if(intr_status != CY_SYSINT_SUCCESS)
+#if (SPI_CRYPT != 0u)
+    /* Without a session, nothing may go out in clear */
+    length = spi_crypt_encrypt(tx_class, sealed, frame, length);
+    if (0UL == length)
     {
-        return(INIT_FAILURE);
+        stream_stats.tx_drops[tx_class]++;
+        return TRANSFER_FAILURE;
     }
+    frame = sealed;
+#endif
 
-    NVIC_EnableIRQ(sSPI_IRQ);
+    encoded_length = cobs_encode(frame, length, encoded);
+    encoded[encoded_length++] = COBS_DELIMITER;
 
-    /* Enable the SPI Slave block */
-    Cy_SCB_SPI_Enable(sSPI_HW);
+    if (!ring_buffer_write(&tx_rings[tx_class], encoded, (uint16_t)encoded_length))
+    {
+        stream_stats.tx_drops[tx_class]++;
+        return TRANSFER_FAILURE;
+    }
 
-    /* Initialization completed */
-    return(INIT_SUCCESS);
+    tx_queued[tx_class]++;
+
+    return TRANSFER_COMPLETE;
+}
+
+/******************************************************************************
+* Function Name: is_link_idle
+*******************************************************************************
+*
+* Summary:
+*  This function reports whether the link has nothing to process: no
+*  received bytes are waiting to be decoded and no control or bulk frame
+*  is waiting to be sent. Log frames do not count, as they are meant to
+*  fill idle time.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  - (bool) - true if the link is idle
+*
+******************************************************************************/
+bool is_link_idle(void)
+{
+    return (0u == ring_buffer_count(&rx_ring)) &&
+           (0u == ring_buffer_count(&tx_rings[SPI_TX_CONTROL])) &&
+           (0u == ring_buffer_count(&tx_rings[SPI_TX_BULK]));
+}
+
+/******************************************************************************
+* Function Name: get_stream_stats
+*******************************************************************************
+*
+* Summary:
+*  This function returns a copy of the link statistics.
+*
+* Parameters:
+*  - (spi_stream_stats_t *) stats - Location to store the statistics
+*
+* Return:
+*  None
+*
+******************************************************************************/
+void get_stream_stats(spi_stream_stats_t *stats)
+{
+    crit_state_t crit_state;
+    uint32_t index;
+
+    /* Take a consistent snapshot of counters updated by the ISR */
+    CRIT_SECTION_ENTER(crit_state);
+    stats->frames = stream_stats.frames;
+    stats->frame_errors = stream_stats.frame_errors;
+    stats->rx_overflows = stream_stats.rx_overflows;
+    stats->interrupts = stream_stats.interrupts;
+    stats->notifications = stream_stats.notifications;
+    for (index = 0UL; index < SPI_TX_CLASSES; index++)
+    {
+        stats->tx_drops[index] = stream_stats.tx_drops[index];
+    }
+    CRIT_SECTION_EXIT(crit_state);
 }
 
+#if (BENCHMARK != 0u)
+/******************************************************************************
+* Function Name: get_isr_cycles
+*******************************************************************************
+*
+* Summary:
+*  This function returns the fastest and slowest SPI interrupt entries
+*  since the previous call, and starts timing them again.
+*
+* Parameters:
+*  - (uint32_t *) min_cycles - Fastest entry in cycles, 0 if none
+*  - (uint32_t *) max_cycles - Slowest entry in cycles
+*
+* Return:
+*  None
+*
+******************************************************************************/
+void get_isr_cycles(uint32_t *min_cycles, uint32_t *max_cycles)
+{
+    crit_state_t crit_state;
+
+    CRIT_SECTION_ENTER(crit_state);
+    *min_cycles = (UINT32_MAX == isr_cycles_min) ? 0UL : isr_cycles_min;
+    *max_cycles = isr_cycles_max;
+    isr_cycles_min = UINT32_MAX;
+    isr_cycles_max = 0UL;
+    CRIT_SECTION_EXIT(crit_state);
+}
+#endif
 
+/******************************************************************************
+* Function Name: register_frame_callback
+*******************************************************************************
+*
+* Summary:
+*  This function registers the function called from the SPI interrupt when
+*  complete frames are waiting in the RX ring. The frames are then read
+*  with read_frame().
+*
+* Parameters:
+*  - (spi_frame_callback_t) callback - Function to call, or NULL
+*
+* Return:
+*  None
+*
+******************************************************************************/
+void register_frame_callback(spi_frame_callback_t callback)
+{
+    frame_callback = callback;
+}
+
+#else
 /******************************************************************************
 * Function Name: read_packet
 *******************************************************************************
@@ -129,6 +885,11 @@ uint32_t init_slave(void)
 *  This function reads the data received by the slave. Note that
 *  the below function is blocking until the required number of
 *  bytes is received by the slave.
+*  In daisy-chain mode the transaction carries one packet per slave in
+*  the chain, and only the last packet received is returned.
+*  In multi-drop mode, packets addressed to other slaves are dropped in
+*  the ISR and the function returns only for packets addressed to this
+*  slave or broadcast.
 *
 * Parameters:
 *  - (uint8_t *) rxBuffer - Pointer to the receive buffer where data
@@ -143,18 +904,82 @@ uint32_t init_slave(void)
 uint32_t read_packet(uint8_t *txBuffer, uint8_t *rxBuffer, uint32_t transferSize)
 {
     uint32_t slave_status;
-    cy_en_scb_spi_status_t status;
+    bool status;
+
+#if (SPI_DAISY_CHAIN_LENGTH > 1u)
+    /* Our packet is shifted out first, ahead of the forwarded bytes. The
+     * ISR must forward each byte before the packet drains from the FIFO,
+     * so the packet has to be shorter than the FIFO. */
+    status = false;
+
+    if (transferSize < transport_fifo_size())
+    {
+        transport_clear_tx();
+        transport_write_array(txBuffer, transferSize);
 
+        chain_rx_buffer = rxBuffer;
+        chain_forward_size = transferSize * (SPI_DAISY_CHAIN_LENGTH - 1u);
+        chain_total_size = transferSize * SPI_DAISY_CHAIN_LENGTH;
+        chain_count = 0UL;
+        chain_active = true;
+
+        transport_set_rx_interrupt(true, 0UL);
+        status = true;
+    }
+
+    if(status)
+    {
+        /* Blocking wait for the whole chain transaction */
+        while (chain_active)
+        {
+#if (CLOCK_GOVERNOR != 0u)
+            clock_governor_poll();
+#endif
+        }
+#elif (SPI_MULTIDROP != 0u)
+    /* The status packet is preloaded so it is ready as soon as MISO is
+     * enabled; the ISR filters packets addressed to other slaves */
+    status = false;
+
+    if (transferSize <= transport_fifo_size())
+    {
+        transport_clear_tx();
+        transport_write_array(txBuffer, transferSize);
+
+        drop_rx_buffer = rxBuffer;
+        drop_tx_buffer = txBuffer;
+        drop_size = transferSize;
+        drop_count = 0UL;
+        drop_ignore = false;
+        drop_active = true;
+
+        transport_set_rx_interrupt(true, 0UL);
+        status = true;
+    }
+
+    if(status)
+    {
+        /* Blocking wait for a packet addressed to this slave */
+        while (drop_active)
+        {
+#if (CLOCK_GOVERNOR != 0u)
+            clock_governor_poll();
+#endif
+        }
+#else
     /* Prepare for a transfer. */
-    status = Cy_SCB_SPI_Transfer(sSPI_HW, txBuffer, rxBuffer, transferSize, &sSPI_context);
+    status = transport_transfer(txBuffer, rxBuffer, transferSize);
 
-    if(status == CY_SCB_SPI_SUCCESS)
+    if(status)
     {
         /* Blocking wait for transfer completion */
-        while (0UL != (CY_SCB_SPI_TRANSFER_ACTIVE &\
-                       Cy_SCB_SPI_GetTransferStatus(sSPI_HW, &sSPI_context)))
+        while (transport_transfer_active())
         {
+#if (CLOCK_GOVERNOR != 0u)
+            clock_governor_poll();
+#endif
         }
+#endif
 
         /* Check start and end of packet markers */
         if ((rxBuffer[PACKET_SOP_POS] == PACKET_SOP) &&\
@@ -178,5 +1003,67 @@ uint32_t read_packet(uint8_t *txBuffer, uint8_t *rxBuffer, uint32_t transferSize
    return slave_status;
 }
 
+#endif
+
+#if (SPI_MULTIDROP != 0u)
+/******************************************************************************
+* Function Name: get_slave_address
+*******************************************************************************
+*
+* Summary:
+*  This function returns the slave address stored in flash.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  - (uint8_t) - Address of this slave
+*
+******************************************************************************/
+uint8_t get_slave_address(void)
+{
+    return slave_address_row[0];
+}
+
+/******************************************************************************
+* Function Name: set_slave_address
+*******************************************************************************
+*
+* Summary:
+*  This function stores a new slave address in flash and starts using it.
+*  The broadcast address cannot be assigned to a slave.
+*
+* Parameters:
+*  - (uint8_t) address - New address of this slave
+*
+* Return:
+*  - (cy_en_flashdrv_status_t) - CY_FLASH_DRV_SUCCESS if the address was
+*                                stored, otherwise the flash driver error
+*
+******************************************************************************/
+cy_en_flashdrv_status_t set_slave_address(uint8_t address)
+{
+    uint32_t row[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)] = {0UL};
+    cy_en_flashdrv_status_t flash_status;
+    crit_state_t crit_state;
+
+    if (address == SPI_BROADCAST_ADDRESS)
+    {
+        return CY_FLASH_DRV_INVALID_INPUT_PARAMETERS;
+    }
 
+    ((uint8_t *)row)[0] = address;
 
+    /* Interrupts stay masked for the whole row write */
+    CRIT_SECTION_ENTER(crit_state);
+    flash_status = Cy_Flash_WriteRow((uint32_t)(uintptr_t)slave_address_row, row);
+    CRIT_SECTION_EXIT(crit_state);
+
+    if (flash_status == CY_FLASH_DRV_SUCCESS)
+    {
+        slave_address = address;
+    }
+
+    return flash_status;
+}
+#endif
@@ -53,20 +53,155 @@
 /* SPI transfer status */
 #define TRANSFER_COMPLETE       (0UL)
 #define TRANSFER_FAILURE        (1UL)
+#define TRANSFER_PENDING        (2UL)
+
+/* Framing of the SPI byte stream */
+#define SPI_FRAMING_SOP_EOP     (0u)    /* Fixed packets with SOP/EOP markers */
+#define SPI_FRAMING_COBS        (1u)    /* COBS frames separated by zero bytes */
+
+#ifndef SPI_FRAMING
+#define SPI_FRAMING             (SPI_FRAMING_SOP_EOP)
+#endif
+
+/* Streaming buffers used with COBS framing (sizes must be powers of two) */
+#define SPI_RX_RING_SIZE        (128u)
+
+/* Classes of outbound frames with COBS framing. Control frames have strict
+ * priority; bulk and log frames share the rest of the link by weight. A
+ * class is only switched at a frame boundary. */
+#define SPI_TX_CONTROL          (0u)    /* Replies to commands */
+#define SPI_TX_BULK             (1u)    /* Samples, events and telemetry */
+#define SPI_TX_LOG              (2u)    /* Debug log records */
+#define SPI_TX_CLASSES          (3u)
+
+/* Ring size of each class (powers of two) */
+#define SPI_TX_CONTROL_RING_SIZE (128u)
+#define SPI_TX_BULK_RING_SIZE   (256u)
+#define SPI_TX_LOG_RING_SIZE    (256u)
+
+/* Frames queued per class before new ones are dropped */
+#define SPI_TX_CONTROL_DEPTH    (4u)
+#define SPI_TX_BULK_DEPTH       (8u)
+#define SPI_TX_LOG_DEPTH        (8u)
+
+/* Frames sent from each class per round while both have frames waiting */
+#define SPI_TX_BULK_WEIGHT      (3u)
+#define SPI_TX_LOG_WEIGHT       (1u)
+
+/* Largest decoded frame accepted or sent with COBS framing */
+#ifndef SPI_FRAME_MAX_SIZE
+#define SPI_FRAME_MAX_SIZE      (32u)
+#endif
+
+/* Received frames whose arrival time is kept until they are read (power
+ * of two). Frames beyond this are stamped when read_frame() returns them. */
+#define SPI_RX_TIMESTAMP_SLOTS  (8u)
+
+/* Interrupt coalescing with COBS framing: the RX FIFO interrupt fires only
+ * when the FIFO is half full, and the application is notified once per
+ * batch of frames instead of once per frame */
+#ifndef SPI_COALESCE
+#define SPI_COALESCE            (0u)
+#endif
+
+/* Frames collected before the application is notified */
+#define SPI_COALESCE_BATCH      (4u)
+
+/* Longest time a received frame or byte waits before it is processed */
+#define SPI_COALESCE_MAX_LATENCY_MS (2u)
+
+/* SysTick callback slot used to flush the RX FIFO below the trigger level */
+#define SPI_COALESCE_TICK_SLOT  (1u)
+
+#if ((SPI_COALESCE != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "Interrupt coalescing requires SPI_FRAMING_COBS"
+#endif
+
+/* Number of slaves sharing one slave select with MOSI and MISO chained.
+ * With more than one, every slave forwards what it receives delayed by one
+ * packet and keeps the last packet of the transaction as its own. */
+#ifndef SPI_DAISY_CHAIN_LENGTH
+#define SPI_DAISY_CHAIN_LENGTH  (1u)
+#endif
+
+#if ((SPI_DAISY_CHAIN_LENGTH > 1u) && (SPI_FRAMING != SPI_FRAMING_SOP_EOP))
+#error "Daisy-chain mode requires SPI_FRAMING_SOP_EOP"
+#endif
+
+/* Multi-drop mode: several slaves share one slave select and the packet
+ * carries the address of the slave it is meant for */
+#ifndef SPI_MULTIDROP
+#define SPI_MULTIDROP           (0u)
+#endif
+
+/* Address used until one is stored in flash, and the address every
+ * slave accepts (without driving MISO) */
+#define SPI_SLAVE_ADDRESS       (0x01u)
+#define SPI_BROADCAST_ADDRESS   (0xFFu)
+
+#if ((SPI_MULTIDROP != 0u) && ((SPI_FRAMING != SPI_FRAMING_SOP_EOP) || (SPI_DAISY_CHAIN_LENGTH > 1u)))
+#error "Multi-drop mode requires SPI_FRAMING_SOP_EOP without a daisy chain"
+#endif
 
 /* TX Packet Head and Tail */
 #define PACKET_SOP              (0x01UL)
 #define PACKET_EOP              (0x17UL)
 
 /* Element index in the packet */
+#if (SPI_MULTIDROP != 0u)
+/* The command byte gives the slave one byte time to enable MISO after
+ * matching the address, so the status is sent one byte later */
+#define PACKET_SOP_POS          (0UL)
+#define PACKET_ADDR_POS         (1UL)
+#define PACKET_CMD_POS          (2UL)
+#define PACKET_STATUS_POS       (3UL)
+#define PACKET_EOP_POS          (4UL)
+#else
 #define PACKET_SOP_POS          (0UL)
 #define PACKET_CMD_POS          (1UL)
+#define PACKET_STATUS_POS       (1UL)
 #define PACKET_EOP_POS          (2UL)
+#endif
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Link statistics kept in COBS streaming mode */
+typedef struct
+{
+    uint32_t frames;        /* Frames decoded successfully */
+    uint32_t frame_errors;  /* Frames dropped as malformed or too long */
+    uint32_t rx_overflows;  /* Bytes lost because the RX ring or FIFO was full */
+    uint32_t interrupts;    /* SPI interrupt entries */
+    uint32_t notifications; /* Frame callbacks issued */
+    uint32_t tx_drops[SPI_TX_CLASSES]; /* Frames dropped per class, depth or ring full */
+} spi_stream_stats_t;
+
+/* Called from the SPI interrupt with the number of frames completed since
+ * the previous call */
+typedef void (*spi_frame_callback_t)(uint32_t);
 
 /*******************************************************************************
 *         Function Prototypes
 *******************************************************************************/
 uint32_t init_slave(void);
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+uint32_t read_frame(uint8_t *, uint32_t, uint32_t *);
+uint32_t write_frame(uint8_t const *, uint32_t);
+uint32_t write_class_frame(uint32_t, uint8_t const *, uint32_t);
+bool is_link_idle(void);
+void get_stream_stats(spi_stream_stats_t *);
+void register_frame_callback(spi_frame_callback_t);
+uint32_t get_frame_timestamp(void);
+/* With BENCHMARK */
+void get_isr_cycles(uint32_t *, uint32_t *);
+#else
 uint32_t read_packet(uint8_t *, uint8_t *, uint32_t);
+#endif
+#if (SPI_MULTIDROP != 0u)
+uint8_t get_slave_address(void);
+cy_en_flashdrv_status_t set_slave_address(uint8_t);
+#endif
 
 #endif
@@ -0,0 +1,206 @@
+/******************************************************************************
+* File Name: StackMonitor.c
+*
+* Description: This file contains the stack painting at boot and the
+*              high-water-mark query.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "StackMonitor.h"
+#include "Command.h"
+
+#if (STACK_MONITOR != 0u)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Bounds of the stack reserved by the linker */
+#if defined(__ARMCC_VERSION)
+extern uint32_t Image$$ARM_LIB_STACK$$ZI$$Base[];
+extern uint32_t Image$$ARM_LIB_STACK$$ZI$$Limit[];
+#define STACK_LIMIT             ((uint32_t *)Image$$ARM_LIB_STACK$$ZI$$Base)
+#define STACK_TOP               ((uint32_t *)Image$$ARM_LIB_STACK$$ZI$$Limit)
+#elif defined(__ICCARM__)
+#pragma section = "CSTACK"
+#define STACK_LIMIT             ((uint32_t *)__section_begin("CSTACK"))
+#define STACK_TOP               ((uint32_t *)__section_end("CSTACK"))
+#elif defined(__GNUC__)
+extern uint32_t __StackLimit[];
+extern uint32_t __StackTop[];
+#define STACK_LIMIT             (__StackLimit)
+#define STACK_TOP               (__StackTop)
+#else
+#error "Unsupported toolchain for the stack monitor"
+#endif
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+static uint32_t stack_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+#endif
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/*******************************************************************************
+* Function Name: stack_command
+********************************************************************************
+*
+* Summary:
+*  Returns the flags byte, then the stack size, the high-water mark and
+*  the current use, 32-bit little-endian.
+*
+*******************************************************************************/
+static uint32_t stack_command(uint8_t const *request, uint32_t length,
+                              uint8_t *reply, uint32_t *reply_length)
+{
+    stack_status_t status;
+    uint32_t values[3];
+    uint32_t pos = 2UL;
+    uint32_t index;
+
+    (void) request;
+    (void) length;
+
+    stack_monitor_get_status(&status);
+    values[0] = status.size;
+    values[1] = status.high_water;
+    values[2] = status.current;
+
+    reply[COMMAND_OPCODE_POS] = CMD_STACK;
+    reply[1] = (uint8_t)status.flags;
+    for (index = 0UL; index < CY_ARRAY_SIZE(values); index++)
+    {
+        reply[pos++] = (uint8_t)values[index];
+        reply[pos++] = (uint8_t)(values[index] >> 8u);
+        reply[pos++] = (uint8_t)(values[index] >> 16u);
+        reply[pos++] = (uint8_t)(values[index] >> 24u);
+    }
+    *reply_length = pos;
+
+    return COMMAND_SUCCESS;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: stack_monitor_paint
+********************************************************************************
+*
+* Summary:
+*  Paints the stack below the current stack pointer with
+*  STACK_PAINT_PATTERN. Call it first thing in main(), before the deeper
+*  initialization calls and before interrupts are enabled.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stack_monitor_paint(void)
+{
+    uint32_t *word = STACK_LIMIT;
+    uint32_t *stack_pointer = (uint32_t *)__get_MSP();
+
+    /* Plain stores only: a library call would use the stack being painted */
+    while (word < stack_pointer)
+    {
+        *word = STACK_PAINT_PATTERN;
+        word++;
+    }
+}
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/*******************************************************************************
+* Function Name: stack_monitor_init
+********************************************************************************
+*
+* Summary:
+*  Registers the stack status command.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t stack_monitor_init(void)
+{
+    if (COMMAND_SUCCESS != command_register(CMD_STACK, &stack_command, SPI_TX_CONTROL,
+                                             STACK_MONITOR_BUDGET_US))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: stack_monitor_get_status
+********************************************************************************
+*
+* Summary:
+*  Returns the stack size and use. The high-water mark is found by
+*  scanning up from the stack limit for the first word that no longer
+*  holds the paint pattern; a value that happens to equal the pattern
+*  makes it at most one word low.
+*
+* Parameters:
+*  (stack_status_t *) status - Destination
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stack_monitor_get_status(stack_status_t *status)
+{
+    uint32_t const *word = STACK_LIMIT;
+    uint32_t const *top = STACK_TOP;
+
+    while ((word < top) && (STACK_PAINT_PATTERN == *word))
+    {
+        word++;
+    }
+
+    status->flags = (STACK_PAINT_PATTERN != *STACK_LIMIT) ? STACK_FLAG_LIMIT_REACHED : 0UL;
+    status->size = (uint32_t)top - (uint32_t)STACK_LIMIT;
+    status->high_water = (uint32_t)top - (uint32_t)word;
+    status->current = (uint32_t)top - __get_MSP();
+}
+
+#endif
+
+/* [] END OF FILE */
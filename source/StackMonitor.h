@@ -0,0 +1,92 @@
+/******************************************************************************
+* File Name: StackMonitor.h
+*
+* Description: This file contains the function prototypes of the stack
+*              painting and high-water-mark monitor.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_STACKMONITOR_H_
+#define SOURCE_STACKMONITOR_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Stack painted at boot, to measure the deepest use since */
+#ifndef STACK_MONITOR
+#define STACK_MONITOR           (0u)
+#endif
+
+/* Pattern written to the unused stack */
+#define STACK_PAINT_PATTERN     (0xA5A5A5A5UL)
+
+/* Opcode returning the stack usage (with COBS framing) */
+#define CMD_STACK               (0xA0u)
+
+/* Status flags */
+#define STACK_FLAG_LIMIT_REACHED (0x01u) /* The bottom word was overwritten */
+
+/* Reply: opcode, flags, then the stack size, the high-water mark and the
+ * current use in bytes, 32-bit little-endian */
+#define STACK_REPLY_SIZE        (14u)
+
+/* Execution budget of the status handler, a scan of the whole stack */
+#define STACK_MONITOR_BUDGET_US (100u)
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t flags;                     /* STACK_FLAG_x */
+    uint32_t size;                      /* Bytes reserved for the stack */
+    uint32_t high_water;                /* Deepest use since boot, in bytes */
+    uint32_t current;                   /* Use at the time of the call */
+} stack_status_t;
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (STACK_MONITOR != 0u)
+void stack_monitor_paint(void);
+void stack_monitor_get_status(stack_status_t *);
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+uint32_t stack_monitor_init(void);
+#endif
+#endif
+
+#endif
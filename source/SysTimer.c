@@ -0,0 +1,264 @@
+/******************************************************************************
+* File Name: SysTimer.c
+*
+* Description: This file contains function definitions for the system timer.
+*              The SysTick counter runs from the CPU clock, so the elapsed
+*              CPU cycles are read from it directly; the Cortex-M0 has no
+*              cycle counter of its own.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "SysTimer.h"
+#include "CritSection.h"
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Milliseconds since systimer_init() */
+static volatile uint32_t tick_count;
+
+/* Cycles counted at the start of the current tick. Kept separately from
+ * tick_count so a change of the CPU clock does not rescale the past. */
+static volatile uint32_t tick_cycles;
+
+/* SysTick period in CPU cycles */
+static uint32_t cycles_per_tick;
+
+/* CPU cycles per microsecond */
+static uint32_t cycles_per_us;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static void systimer_tick(void);
+
+/*******************************************************************************
+* Function Name: systimer_tick
+********************************************************************************
+*
+* Summary:
+*  SysTick callback. Advances the millisecond and cycle counts.
+*
+*******************************************************************************/
+static void systimer_tick(void)
+{
+    tick_count++;
+    tick_cycles += cycles_per_tick;
+}
+
+/*******************************************************************************
+* Function Name: systimer_init
+********************************************************************************
+*
+* Summary:
+*  Starts SysTick from the CPU clock with a SYSTIMER_TICK_HZ interrupt.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void systimer_init(void)
+{
+    cycles_per_tick = SystemCoreClock / SYSTIMER_TICK_HZ;
+    cycles_per_us = SystemCoreClock / 1000000UL;
+
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_CPU, cycles_per_tick - 1UL);
+    (void) Cy_SysTick_SetCallback(SYSTIMER_CALLBACK_SLOT, &systimer_tick);
+    NVIC_SetPriority(SysTick_IRQn, SYSTIMER_INTR_PRIORITY);
+    Cy_SysTick_Enable();
+}
+
+/*******************************************************************************
+* Function Name: systimer_update_clock
+********************************************************************************
+*
+* Summary:
+*  Reprograms the SysTick period after the CPU clock has changed, so the
+*  tick stays at SYSTIMER_TICK_HZ. SystemCoreClock must already hold the
+*  new frequency. The rest of the tick in progress is run at the new clock
+*  as a shortened period, so no time is lost when the clock changes often.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void systimer_update_clock(void)
+{
+    crit_state_t crit_state;
+    uint32_t elapsed;
+    uint32_t remaining;
+
+    CRIT_SECTION_ENTER(crit_state);
+
+    /* Account for the part of the tick that already elapsed, including a
+     * wrap that is still pending, which is then consumed here */
+    tick_cycles = systimer_get_cycles();
+    if (0UL != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+        tick_count++;
+    }
+    elapsed = (Cy_SysTick_GetReload() - Cy_SysTick_GetValue()) / cycles_per_us;
+
+    cycles_per_tick = SystemCoreClock / SYSTIMER_TICK_HZ;
+    cycles_per_us = SystemCoreClock / 1000000UL;
+    remaining = cycles_per_tick - (elapsed * cycles_per_us);
+
+    /* The counter loads the short period on the clock after the clear,
+     * and the full period from the next wrap on. The cycle base is set
+     * back so the tick callback adding a full period lands right. */
+    tick_cycles -= cycles_per_tick - remaining;
+    Cy_SysTick_SetReload(remaining - 1UL);
+    Cy_SysTick_Clear();
+    Cy_SysTick_SetReload(cycles_per_tick - 1UL);
+
+    CRIT_SECTION_EXIT(crit_state);
+}
+
+/*******************************************************************************
+* Function Name: systimer_get_ms
+********************************************************************************
+*
+* Summary:
+*  Returns the milliseconds elapsed since systimer_init().
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) Milliseconds, wrapping after about 49 days
+*
+*******************************************************************************/
+uint32_t systimer_get_ms(void)
+{
+    return tick_count;
+}
+
+/*******************************************************************************
+* Function Name: systimer_get_cycles
+********************************************************************************
+*
+* Summary:
+*  Returns a free-running count of CPU cycles. It may be called with
+*  interrupts disabled: a SysTick wrap that has not been serviced yet is
+*  detected from the pending flag. This is the time base of the
+*  critical-section profiler, so it masks interrupts directly.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) CPU cycles, wrapping after 2^32 cycles
+*
+*******************************************************************************/
+uint32_t systimer_get_cycles(void)
+{
+    uint32_t intr_state = Cy_SysLib_EnterCriticalSection();
+    uint32_t reload = Cy_SysTick_GetReload();
+    uint32_t base = tick_cycles;
+    uint32_t value = Cy_SysTick_GetValue();
+
+    if (0UL != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        /* The counter wrapped but the tick is not counted yet; read the
+         * value again, as it may have been taken before the wrap */
+        value = Cy_SysTick_GetValue();
+        base += cycles_per_tick;
+    }
+
+    Cy_SysLib_ExitCriticalSection(intr_state);
+
+    return base + (reload - value);
+}
+
+/*******************************************************************************
+* Function Name: systimer_get_us
+********************************************************************************
+*
+* Summary:
+*  Returns a free-running microsecond timestamp. Like
+*  systimer_get_cycles(), it masks interrupts directly.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) Microseconds, wrapping after about 71 minutes
+*
+*******************************************************************************/
+uint32_t systimer_get_us(void)
+{
+    uint32_t intr_state = Cy_SysLib_EnterCriticalSection();
+    uint32_t ms = tick_count;
+    uint32_t reload = Cy_SysTick_GetReload();
+    uint32_t value = Cy_SysTick_GetValue();
+
+    if (0UL != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        value = Cy_SysTick_GetValue();
+        ms++;
+    }
+
+    Cy_SysLib_ExitCriticalSection(intr_state);
+
+    return (ms * 1000UL) + ((reload - value) / cycles_per_us);
+}
+
+/*******************************************************************************
+* Function Name: systimer_cycles_to_us
+********************************************************************************
+*
+* Summary:
+*  Converts a number of CPU cycles at the current clock to microseconds.
+*
+* Parameters:
+*  (uint32_t) cycles - Number of CPU cycles
+*
+* Return:
+*  (uint32_t) Microseconds
+*
+*******************************************************************************/
+uint32_t systimer_cycles_to_us(uint32_t cycles)
+{
+    return cycles / cycles_per_us;
+}
+
+/* [] END OF FILE */
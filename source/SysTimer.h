@@ -0,0 +1,67 @@
+/******************************************************************************
+* File Name: SysTimer.h
+*
+* Description: This file contains the function prototypes for the system
+*              timer used for timestamps and cycle measurements.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_SYSTIMER_H_
+#define SOURCE_SYSTIMER_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* SysTick interrupt rate */
+#define SYSTIMER_TICK_HZ        (1000u)
+
+/* Callback slot used by the timer itself */
+#define SYSTIMER_CALLBACK_SLOT  (0u)
+
+/* SysTick interrupt priority, same as the SPI so neither preempts the other */
+#define SYSTIMER_INTR_PRIORITY  (3u)
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+void systimer_init(void);
+void systimer_update_clock(void);
+uint32_t systimer_get_ms(void);
+uint32_t systimer_get_cycles(void);
+uint32_t systimer_get_us(void);
+uint32_t systimer_cycles_to_us(uint32_t);
+
+#endif
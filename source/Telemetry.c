@@ -0,0 +1,254 @@
+/******************************************************************************
+* File Name: Telemetry.c
+*
+* Description: This file contains function definitions for the
+*              delta-encoded telemetry readout.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Telemetry.h"
+#include "Kernels.h"
+#include "Command.h"
+#include "SysTimer.h"
+
+#if (TELEMETRY != 0u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+
+/* Values set by the application */
+static volatile int32_t current[TELEMETRY_CHANNELS];
+
+/* Snapshot acknowledged by the master, base of the deltas */
+static int32_t reference[TELEMETRY_CHANNELS];
+static uint8_t reference_seq;
+static bool reference_valid;
+
+/* Snapshot sent last, becomes the reference once acknowledged */
+static int32_t last_sent[TELEMETRY_CHANNELS];
+static uint8_t last_seq;
+static bool last_valid;
+
+static uint8_t next_seq;
+static uint32_t since_keyframe;
+
+/*******************************************************************************
+ * Function declaration
+ ******************************************************************************/
+static uint32_t telemetry_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+static uint32_t put_varint(uint8_t *, uint32_t);
+
+/*******************************************************************************
+* Function Name: put_varint
+********************************************************************************
+*
+* Summary:
+*  Stores a value 7 bits per byte, least significant first, with bit 7 set
+*  in every byte but the last. Returns the number of bytes.
+*
+*******************************************************************************/
+static uint32_t put_varint(uint8_t *dest, uint32_t value)
+{
+    uint32_t count = 0UL;
+
+    while (value >= 0x80UL)
+    {
+        dest[count++] = (uint8_t)(value | 0x80UL);
+        value >>= 7u;
+    }
+    dest[count++] = (uint8_t)value;
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: telemetry_command
+********************************************************************************
+*
+* Summary:
+*  Takes a snapshot and sends the channels that differ from the reference,
+*  or all channels as a keyframe. A delta is zigzag encoded so small
+*  negative changes also take one byte.
+*
+*******************************************************************************/
+static uint32_t telemetry_command(uint8_t const *request, uint32_t length,
+                                  uint8_t *reply, uint32_t *reply_length)
+{
+    spi_stream_stats_t stats;
+    int32_t snapshot[TELEMETRY_CHANNELS];
+    uint8_t flags = 0u;
+    uint8_t ack;
+    uint32_t delta;
+    uint32_t pos = TELEMETRY_HEADER_SIZE;
+    uint32_t channel;
+    bool keyframe;
+
+    /* Move the reference to the snapshot the master acknowledges. If it
+     * acknowledges neither the last snapshot nor the reference, it has
+     * lost track and needs a keyframe. */
+    if (length > COMMAND_PAYLOAD_POS)
+    {
+        ack = request[COMMAND_PAYLOAD_POS];
+
+        if (last_valid && (ack == last_seq))
+        {
+            kernel_copy(reference, last_sent, sizeof(reference));
+            reference_seq = last_seq;
+            reference_valid = true;
+        }
+        else if (!reference_valid || (ack != reference_seq))
+        {
+            reference_valid = false;
+        }
+        else
+        {
+            /* Reply to the last request was lost, keep the reference */
+        }
+    }
+    else
+    {
+        reference_valid = false;
+    }
+
+    keyframe = (!reference_valid) || (since_keyframe >= (TELEMETRY_KEYFRAME_INTERVAL - 1UL)) ||
+               ((length > (COMMAND_PAYLOAD_POS + 1UL)) &&
+                (0u != (request[COMMAND_PAYLOAD_POS + 1UL] & TELEMETRY_REQ_KEYFRAME)));
+
+    get_stream_stats(&stats);
+    for (channel = 0UL; channel < TELEMETRY_CHANNELS; channel++)
+    {
+        snapshot[channel] = current[channel];
+    }
+    snapshot[TELEMETRY_UPTIME_MS] = (int32_t)systimer_get_ms();
+    snapshot[TELEMETRY_FRAMES] = (int32_t)stats.frames;
+    snapshot[TELEMETRY_FRAME_ERRORS] = (int32_t)stats.frame_errors;
+    snapshot[TELEMETRY_RX_OVERFLOWS] = (int32_t)stats.rx_overflows;
+
+    for (channel = 0UL; channel < TELEMETRY_CHANNELS; channel++)
+    {
+        delta = (uint32_t)snapshot[channel];
+        if (!keyframe)
+        {
+            delta -= (uint32_t)reference[channel];
+            if (0UL == delta)
+            {
+                continue;
+            }
+        }
+
+        /* Zigzag: 0, -1, 1, -2... map to 0, 1, 2, 3... */
+        delta = (delta << 1u) ^ (uint32_t)((int32_t)delta >> 31u);
+        pos += put_varint(&reply[pos], delta);
+        flags |= (uint8_t)(1UL << channel);
+    }
+
+    if (keyframe)
+    {
+        flags |= TELEMETRY_FLAG_KEYFRAME;
+        since_keyframe = 0UL;
+    }
+    else
+    {
+        since_keyframe++;
+    }
+
+    reply[COMMAND_OPCODE_POS] = CMD_TELEMETRY;
+    reply[1] = next_seq;
+    reply[2] = keyframe ? next_seq : reference_seq;
+    reply[3] = flags;
+    *reply_length = pos;
+
+    kernel_copy(last_sent, snapshot, sizeof(last_sent));
+    last_seq = next_seq;
+    last_valid = true;
+    next_seq++;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: telemetry_init
+********************************************************************************
+*
+* Summary:
+*  Registers the telemetry command. The first snapshot is a keyframe.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t telemetry_init(void)
+{
+    reference_valid = false;
+    last_valid = false;
+    since_keyframe = 0UL;
+
+    if (COMMAND_SUCCESS != command_register(CMD_TELEMETRY, &telemetry_command, SPI_TX_BULK,
+                                             TELEMETRY_BUDGET_US))
+    {
+        return INIT_FAILURE;
+    }
+
+    return INIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: telemetry_set
+********************************************************************************
+*
+* Summary:
+*  Sets the value of an application channel, sent with the next snapshot.
+*
+* Parameters:
+*  (uint32_t) channel - TELEMETRY_APP_CHANNEL or above
+*  (int32_t) value - New value
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void telemetry_set(uint32_t channel, int32_t value)
+{
+    if ((channel >= TELEMETRY_APP_CHANNEL) && (channel < TELEMETRY_CHANNELS))
+    {
+        current[channel] = value;
+    }
+}
+
+#endif
+
+/* [] END OF FILE */
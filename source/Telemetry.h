@@ -0,0 +1,104 @@
+/******************************************************************************
+* File Name: Telemetry.h
+*
+* Description: This file contains the function prototypes for the
+*              delta-encoded telemetry readout.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_TELEMETRY_H_
+#define SOURCE_TELEMETRY_H_
+
+#include "cy_pdl.h"
+#include "SpiSlave.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Telemetry snapshots sent as varint deltas against the snapshot last
+ * acknowledged by the master */
+#ifndef TELEMETRY
+#define TELEMETRY               (0u)
+#endif
+
+#if ((TELEMETRY != 0u) && (SPI_FRAMING != SPI_FRAMING_COBS))
+#error "Telemetry requires SPI_FRAMING_COBS"
+#endif
+
+/* Opcode reading a snapshot. Request: opcode, sequence number of the last
+ * snapshot received, flags. Without a sequence number a keyframe is sent. */
+#define CMD_TELEMETRY           (0x40u)
+
+/* Request flags */
+#define TELEMETRY_REQ_KEYFRAME  (0x01u) /* Send a keyframe */
+
+/* Reply: opcode, sequence number, sequence number of the reference, flags,
+ * then a zigzag varint for each channel marked in the flags */
+#define TELEMETRY_HEADER_SIZE   (4u)
+#define TELEMETRY_FLAG_KEYFRAME (0x80u) /* Values are absolute */
+
+/* Channels: the first ones are the link counters, the others are set by
+ * the application with telemetry_set() */
+#define TELEMETRY_UPTIME_MS     (0u)
+#define TELEMETRY_FRAMES        (1u)
+#define TELEMETRY_FRAME_ERRORS  (2u)
+#define TELEMETRY_RX_OVERFLOWS  (3u)
+#define TELEMETRY_APP_CHANNEL   (4u)
+#ifndef TELEMETRY_CHANNELS
+#define TELEMETRY_CHANNELS      (5u)
+#endif
+
+/* Execution budget of the snapshot handler */
+#define TELEMETRY_BUDGET_US     (100u)
+
+/* A keyframe is sent at least once every this many snapshots */
+#define TELEMETRY_KEYFRAME_INTERVAL (16u)
+
+/* Longest varint of a 32-bit value */
+#define TELEMETRY_VARINT_MAX    (5u)
+
+#if ((TELEMETRY != 0u) && ((TELEMETRY_CHANNELS > 7u) ||\
+     ((TELEMETRY_HEADER_SIZE + (TELEMETRY_CHANNELS * TELEMETRY_VARINT_MAX)) > SPI_FRAME_MAX_SIZE)))
+#error "TELEMETRY_CHANNELS does not fit in a frame"
+#endif
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+#if (TELEMETRY != 0u)
+uint32_t telemetry_init(void);
+void telemetry_set(uint32_t, int32_t);
+#endif
+
+#endif
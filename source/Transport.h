@@ -0,0 +1,86 @@
+/******************************************************************************
+* File Name: Transport.h
+*
+* Description: This file contains the macros and function prototypes
+*              of the byte transport under the SPI slave driver.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SOURCE_TRANSPORT_H_
+#define SOURCE_TRANSPORT_H_
+
+#include "cy_pdl.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+
+/* Backends of the transport. The driver in SpiSlave.c sees a slave SPI
+ * block with an RX and a TX FIFO and one interrupt; the backend maps them
+ * to the SCB, or to a Unix domain socket or pty for a slave built and run
+ * on a Linux host (see the host directory). */
+#define SPI_TRANSPORT_SCB       (0u)
+#define SPI_TRANSPORT_HOST      (1u)
+
+#ifndef SPI_TRANSPORT
+#define SPI_TRANSPORT           (SPI_TRANSPORT_SCB)
+#endif
+
+/*******************************************************************************
+ * Data types
+ ******************************************************************************/
+
+/* Interrupt service routine of the driver */
+typedef void (*transport_isr_t)(void);
+
+/*******************************************************************************
+*         Function Prototypes
+*******************************************************************************/
+uint32_t transport_init(transport_isr_t);
+void transport_enable(void);
+uint32_t transport_fifo_size(void);
+uint32_t transport_rx_count(void);
+uint8_t transport_read(void);
+bool transport_clear_rx_status(void);
+void transport_set_rx_interrupt(bool, uint32_t);
+uint32_t transport_tx_count(void);
+void transport_write(uint8_t);
+void transport_write_array(uint8_t const *, uint32_t);
+void transport_clear_tx(void);
+void transport_drive_miso(bool);
+void transport_pend_interrupt(void);
+bool transport_transfer(uint8_t const *, uint8_t *, uint32_t);
+bool transport_transfer_active(void);
+void transport_service(void);
+
+#endif
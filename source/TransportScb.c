@@ -0,0 +1,326 @@
+/******************************************************************************
+* File Name: TransportScb.c
+*
+* Description: This file contains the SCB backend of the byte transport
+*              under the SPI slave driver.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+#include "Transport.h"
+#include "SpiSlave.h"
+
+#if (SPI_TRANSPORT == SPI_TRANSPORT_SCB)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+cy_stc_scb_spi_context_t sSPI_context;
+
+/* Assign SPI interrupt number and priority */
+#define sSPI_INTR_PRIORITY   (3U)
+
+/*******************************************************************************
+* Function Name: transport_init
+********************************************************************************
+*
+* Summary:
+*  Configures the SCB as a SPI slave, as set in the design.modus file, and
+*  hooks the interrupt service routine. The interrupt stays disabled until
+*  transport_enable().
+*
+* Parameters:
+*  (transport_isr_t) isr - Interrupt service routine
+*
+* Return:
+*  (uint32_t) INIT_SUCCESS or INIT_FAILURE
+*
+*******************************************************************************/
+uint32_t transport_init(transport_isr_t isr)
+{
+    cy_en_scb_spi_status_t spi_status;
+    cy_en_sysint_status_t intr_status;
+
+    /* Configure the SPI block */
+    spi_status = Cy_SCB_SPI_Init(sSPI_HW, &sSPI_config, &sSPI_context);
+
+    /* If the initialization fails, return failure status */
+    if(spi_status != CY_SCB_SPI_SUCCESS)
+    {
+        return(INIT_FAILURE);
+    }
+
+    /* Set active slave select to line 0 */
+    Cy_SCB_SPI_SetActiveSlaveSelect(sSPI_HW, CY_SCB_SPI_SLAVE_SELECT0);
+
+    /* Populate configuration structure */
+    const cy_stc_sysint_t spi_intr_config =
+    {
+        .intrSrc      = sSPI_IRQ,
+        .intrPriority = sSPI_INTR_PRIORITY,
+    };
+
+    /* Hook interrupt service routine */
+    intr_status = Cy_SysInt_Init(&spi_intr_config, isr);
+
+    if(intr_status != CY_SYSINT_SUCCESS)
+    {
+        return(INIT_FAILURE);
+    }
+
+    return(INIT_SUCCESS);
+}
+
+/*******************************************************************************
+* Function Name: transport_enable
+********************************************************************************
+*
+* Summary:
+*  Enables the interrupt and the SCB.
+*
+*******************************************************************************/
+void transport_enable(void)
+{
+    NVIC_EnableIRQ(sSPI_IRQ);
+
+    /* Enable the SPI Slave block */
+    Cy_SCB_SPI_Enable(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_fifo_size
+********************************************************************************
+*
+* Summary:
+*  Returns the depth of each FIFO in bytes.
+*
+*******************************************************************************/
+uint32_t transport_fifo_size(void)
+{
+    return Cy_SCB_GetFifoSize(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_rx_count
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes in the RX FIFO.
+*
+*******************************************************************************/
+uint32_t transport_rx_count(void)
+{
+    return Cy_SCB_SPI_GetNumInRxFifo(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_read
+********************************************************************************
+*
+* Summary:
+*  Reads a byte from the RX FIFO, which must not be empty.
+*
+*******************************************************************************/
+uint8_t transport_read(void)
+{
+    return (uint8_t)Cy_SCB_SPI_Read(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_clear_rx_status
+********************************************************************************
+*
+* Summary:
+*  Clears the RX interrupt sources. Returns true if the RX FIFO overflowed
+*  since the previous call.
+*
+*******************************************************************************/
+bool transport_clear_rx_status(void)
+{
+    bool overflow = (0UL != (CY_SCB_SPI_RX_OVERFLOW & Cy_SCB_SPI_GetRxFifoStatus(sSPI_HW)));
+
+    Cy_SCB_SPI_ClearRxFifoStatus(sSPI_HW, CY_SCB_SPI_RX_NOT_EMPTY | CY_SCB_SPI_RX_TRIGGER |\
+                                          CY_SCB_SPI_RX_OVERFLOW);
+
+    return overflow;
+}
+
+/*******************************************************************************
+* Function Name: transport_set_rx_interrupt
+********************************************************************************
+*
+* Summary:
+*  Enables or disables the RX interrupt. With a level of 0 the interrupt
+*  fires for any byte in the RX FIFO, otherwise once it holds more than
+*  level bytes.
+*
+*******************************************************************************/
+void transport_set_rx_interrupt(bool enable, uint32_t level)
+{
+    if (!enable)
+    {
+        Cy_SCB_SPI_SetRxInterruptMask(sSPI_HW, 0UL);
+    }
+    else if (0UL == level)
+    {
+        Cy_SCB_SPI_SetRxInterruptMask(sSPI_HW, CY_SCB_SPI_RX_NOT_EMPTY);
+    }
+    else
+    {
+        Cy_SCB_SPI_SetRxFifoLevel(sSPI_HW, level);
+        Cy_SCB_SPI_SetRxInterruptMask(sSPI_HW, CY_SCB_SPI_RX_TRIGGER);
+    }
+}
+
+/*******************************************************************************
+* Function Name: transport_tx_count
+********************************************************************************
+*
+* Summary:
+*  Returns the number of bytes in the TX FIFO.
+*
+*******************************************************************************/
+uint32_t transport_tx_count(void)
+{
+    return Cy_SCB_SPI_GetNumInTxFifo(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_write
+********************************************************************************
+*
+* Summary:
+*  Writes a byte to the TX FIFO, which must not be full.
+*
+*******************************************************************************/
+void transport_write(uint8_t byte)
+{
+    (void) Cy_SCB_SPI_Write(sSPI_HW, byte);
+}
+
+/*******************************************************************************
+* Function Name: transport_write_array
+********************************************************************************
+*
+* Summary:
+*  Writes as many bytes of a buffer as fit in the TX FIFO.
+*
+*******************************************************************************/
+void transport_write_array(uint8_t const *data, uint32_t length)
+{
+    (void) Cy_SCB_SPI_WriteArray(sSPI_HW, (void *)data, length);
+}
+
+/*******************************************************************************
+* Function Name: transport_clear_tx
+********************************************************************************
+*
+* Summary:
+*  Empties the TX FIFO.
+*
+*******************************************************************************/
+void transport_clear_tx(void)
+{
+    Cy_SCB_SPI_ClearTxFifo(sSPI_HW);
+}
+
+/*******************************************************************************
+* Function Name: transport_drive_miso
+********************************************************************************
+*
+* Summary:
+*  Drives the MISO pin, or releases it to high impedance for a bus shared
+*  with other slaves.
+*
+*******************************************************************************/
+void transport_drive_miso(bool drive)
+{
+    Cy_GPIO_SetDrivemode(sSPI_MISO_PORT, sSPI_MISO_NUM,
+                         drive ? CY_GPIO_DM_STRONG_IN_OFF : CY_GPIO_DM_HIGHZ);
+}
+
+/*******************************************************************************
+* Function Name: transport_pend_interrupt
+********************************************************************************
+*
+* Summary:
+*  Sets the interrupt pending, so the ISR runs without an RX event.
+*
+*******************************************************************************/
+void transport_pend_interrupt(void)
+{
+    NVIC_SetPendingIRQ(sSPI_IRQ);
+}
+
+/*******************************************************************************
+* Function Name: transport_transfer
+********************************************************************************
+*
+* Summary:
+*  Starts a transfer of a fixed number of bytes through the PDL driver,
+*  which is then serviced by transport_service() from the ISR.
+*
+*******************************************************************************/
+bool transport_transfer(uint8_t const *tx, uint8_t *rx, uint32_t size)
+{
+    return (CY_SCB_SPI_SUCCESS == Cy_SCB_SPI_Transfer(sSPI_HW, (void *)tx, rx, size, &sSPI_context));
+}
+
+/*******************************************************************************
+* Function Name: transport_transfer_active
+********************************************************************************
+*
+* Summary:
+*  Returns true while the transfer started last is in progress.
+*
+*******************************************************************************/
+bool transport_transfer_active(void)
+{
+    return (0UL != (CY_SCB_SPI_TRANSFER_ACTIVE & Cy_SCB_SPI_GetTransferStatus(sSPI_HW, &sSPI_context)));
+}
+
+/*******************************************************************************
+* Function Name: transport_service
+********************************************************************************
+*
+* Summary:
+*  Invokes the Cy_SCB_SPI_Interrupt() PDL driver function, for transfers
+*  started with transport_transfer().
+*
+*******************************************************************************/
+void transport_service(void)
+{
+    Cy_SCB_SPI_Interrupt(sSPI_HW, &sSPI_context);
+}
+#endif
+
+/* [] END OF FILE */
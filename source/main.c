@@ -43,24 +43,49 @@
 /*******************************************************************************
  * Include header files
  ******************************************************************************/
-#include <stdio.h>
-#include <inttypes.h>
 #include "cy_pdl.h"
 #include "cybsp.h"
 #include "SpiSlave.h"
+#include "SysTimer.h"
+#include "CritSection.h"
+#include "DebugLog.h"
+#include "Command.h"
+#include "AdcStream.h"
+#include "GpioCapture.h"
+#include "Telemetry.h"
+#include "ClockGovernor.h"
+#include "FlashScan.h"
+#include "DualSlot.h"
+#include "Benchmark.h"
+#include "Format.h"
+#include "SpiCrypt.h"
+#include "Fragment.h"
+#include "StackMonitor.h"
+
+/* The boot stage of the dual-slot images has its own main(), in BootMain.c */
+#if (DUAL_SLOT_BOOT == 0u)
 
 /*******************************************************************************
 * Macros
 ********************************************************************************/
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/* A COBS frame carries the opcode first; the LED reply echoes it */
+#define FRAME_CMD_POS        (COMMAND_OPCODE_POS)
+#define FRAME_REPLY_LENGTH   (1UL)
+#define SIZE_OF_PACKET       (SPI_FRAME_MAX_SIZE)
+#else
 /* Number of elements in the transmit and receive buffer */
-/* There are three elements - one for head, one for command and one for tail */
-#define NUMBER_OF_ELEMENTS   (3UL)
+/* There are three elements - one for head, one for command and one for tail.
+ * Multi-drop packets add the slave address and a separate status byte. */
+#define NUMBER_OF_ELEMENTS   (PACKET_EOP_POS + 1UL)
 #define SIZE_OF_ELEMENT      (1UL)
 #define SIZE_OF_PACKET       (NUMBER_OF_ELEMENTS * SIZE_OF_ELEMENT)
+#endif
 #define CY_ASSERT_FAILED     (0U)
 
 /* Debug print macro to enable UART print */
-/* (For S0 - Debug print will be always zero as SCB UART is not available) */
+/* (For S0 - Debug print will be always zero as SCB UART is not available;
+ *  use DEBUG_LOG to send diagnostics over the SPI link instead) */
 #if (!defined(CY_DEVICE_CCG3PA))
 #define DEBUG_PRINT         (0u)
 #endif
@@ -71,6 +96,17 @@
 /* Function to turn ON or OFF the LED based on the SPI Master command. */
 static void update_led(uint8_t);
 
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/* Handler of the LED on and off opcodes */
+static uint32_t led_command(uint8_t const *, uint32_t, uint8_t *, uint32_t *);
+
+/* Called from the SPI interrupt when received frames are waiting */
+static void frames_received(uint32_t);
+
+/* Set by frames_received(), cleared by the main loop before draining */
+static volatile bool frames_pending = false;
+#endif
+
 #if DEBUG_PRINT
 cy_stc_scb_uart_context_t CYBSP_UART_context; /* Global variable for UART */
 /* Variable used for tracking the print status */
@@ -94,7 +130,7 @@ void check_status(char *message, cy_rslt_t status)
 {
     char error_msg[50];
 
-    sprintf(error_msg, "Error Code: 0x%08" PRIX32 "\n", status);
+    (void) format(error_msg, sizeof(error_msg), "Error Code: 0x%08X\n", status);
 
     Cy_SCB_UART_PutString(CYBSP_UART_HW, "\r\n=====================================================\r\n");
     Cy_SCB_UART_PutString(CYBSP_UART_HW, "\nFAIL: ");
@@ -128,10 +164,22 @@ int main(void)
 
     /* Buffer to save the received data by the slave */
     uint32_t status = 0;
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    uint32_t length = 0;
+    uint32_t tx_class;
+#if (SPI_COALESCE != 0u)
+    uint32_t intr_state;
+#endif
+#endif
 
     uint8_t rx_buffer[SIZE_OF_PACKET] = {0};
     uint8_t tx_buffer[SIZE_OF_PACKET] = {0};
 
+#if (STACK_MONITOR != 0u)
+    /* Before any deeper call, so the high-water mark covers them */
+    stack_monitor_paint();
+#endif
+
     /* Initialize the device and board peripherals */
     result = cybsp_init() ;
     if (result != CY_RSLT_SUCCESS)
@@ -154,6 +202,12 @@ int main(void)
     Cy_SCB_UART_PutString(CYBSP_UART_HW, "****************** \r\n\n");
 #endif
 
+#if ((SPI_FRAMING == SPI_FRAMING_COBS) || (CRIT_PROFILE != 0u) || (CLOCK_GOVERNOR != 0u))
+    /* Start the system timer used for timestamps and SPI flush timing. The
+     * default SOP/EOP build runs without the SysTick interrupt. */
+    systimer_init();
+#endif
+
     /* Initialize the SPI Slave */
     status = init_slave();
     if(status == INIT_FAILURE)
@@ -167,11 +221,171 @@ int main(void)
     /* Enable global interrupts */
     __enable_irq();
 
+#if (DEBUG_LOG != 0u)
+    debug_log_text("PMG1 MCU: SPI slave");
+#endif
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    command_init();
+    (void) command_register(CYBSP_LED_STATE_ON, &led_command, SPI_TX_CONTROL, COMMAND_BUDGET_DEFAULT_US);
+    (void) command_register(CYBSP_LED_STATE_OFF, &led_command, SPI_TX_CONTROL, COMMAND_BUDGET_DEFAULT_US);
+
+#if (ADC_STREAM != 0u)
+    status = adc_stream_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (GPIO_CAPTURE != 0u)
+    status = gpio_capture_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (TELEMETRY != 0u)
+    status = telemetry_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (FLASH_SCAN != 0u)
+    status = flash_scan_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (DUAL_SLOT != 0u)
+    status = dual_slot_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (BENCHMARK != 0u)
+    status = benchmark_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (STACK_MONITOR != 0u)
+    status = stack_monitor_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (SPI_CRYPT != 0u)
+    status = spi_crypt_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+
+#if (FRAGMENT != 0u)
+    /* Message types are registered with fragment_register() after this */
+    status = fragment_init();
+    if(status == INIT_FAILURE)
+    {
+        CY_ASSERT(CY_ASSERT_FAILED);
+    }
+#endif
+#endif
+
+#if (CLOCK_GOVERNOR != 0u)
+    /* Lower the clock while the link is idle */
+    clock_governor_init();
+#endif
+
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+    register_frame_callback(&frames_received);
+
+    for (;;)
+    {
+#if (SPI_COALESCE != 0u)
+        /* Sleep until the SPI interrupt reports a batch of frames. The
+         * check is made with interrupts masked so a notification arriving
+         * in between still ends the sleep. This region is not profiled: a
+         * pending interrupt wakes the CPU at once, so the sleep does not
+         * delay the SPI interrupt. */
+        intr_state = Cy_SysLib_EnterCriticalSection();
+        if (!frames_pending)
+        {
+            (void) Cy_SysPm_CpuEnterSleep();
+        }
+        Cy_SysLib_ExitCriticalSection(intr_state);
+#endif
+        frames_pending = false;
+
+        /* Process every frame the master has clocked in so far */
+        do
+        {
+            status = read_frame(rx_buffer, SIZE_OF_PACKET, &length);
+
+            if(status == TRANSFER_COMPLETE)
+            {
+                tx_class = command_dispatch(rx_buffer, length, tx_buffer, &length);
+
+                /* A reply dropped here is counted in the link statistics */
+                if (0UL != length)
+                {
+                    (void) write_class_frame(tx_class, tx_buffer, length);
+                }
+            }
+
+            /* A malformed frame is dropped; the decoder resynchronises on
+             * the next delimiter, so there is nothing else to do here */
+        } while (status != TRANSFER_PENDING);
+
+#if (SPI_CRYPT != 0u)
+        /* Keystream for the next frames is generated while the link is idle */
+        spi_crypt_poll();
+#endif
+#if (FRAGMENT != 0u)
+        /* Partial messages the master stopped sending are abandoned */
+        fragment_poll();
+#endif
+#if (DEBUG_LOG != 0u)
+        /* Counter snapshots go out only while the link is idle */
+        debug_log_poll();
+#endif
+#if (FLASH_SCAN != 0u)
+        /* The image CRC advances while the link is idle */
+        flash_scan_poll();
+#endif
+#if (DUAL_SLOT != 0u)
+        /* Reset into the new image once the activation reply is out */
+        dual_slot_poll();
+#endif
+#if (CLOCK_GOVERNOR != 0u)
+        clock_governor_poll();
+#endif
+#if DEBUG_PRINT
+        if (ENTER_LOOP)
+        {
+            Cy_SCB_UART_PutString(CYBSP_UART_HW, "Entered for loop\r\n");
+            ENTER_LOOP = false;
+        }
+#endif
+    }
+#else
     for (;;)
     {
         /* Form the status packet */
         tx_buffer[PACKET_SOP_POS] = PACKET_SOP;
-        tx_buffer[PACKET_CMD_POS] = rx_buffer[PACKET_CMD_POS];
+        tx_buffer[PACKET_STATUS_POS] = rx_buffer[PACKET_CMD_POS];
         tx_buffer[PACKET_EOP_POS] = PACKET_EOP;
 
         /* Get the bytes received by the slave */
@@ -196,6 +410,7 @@ int main(void)
         }
 #endif
     }
+#endif
 }
 
 
@@ -230,5 +445,61 @@ static void update_led(uint8_t LED_Cmd)
     }
 }
 
+#if (SPI_FRAMING == SPI_FRAMING_COBS)
+/*******************************************************************************
+* Function Name: led_command
+********************************************************************************
+*
+* Summary:
+*  Handles the LED on and off opcodes and reports the command back to the
+*  master, as with the fixed packet format.
+*
+* Parameters:
+*  (uint8_t const *) request - Request frame
+*  (uint32_t) length - Length of the request
+*  (uint8_t *) reply - Reply frame
+*  (uint32_t *) reply_length - Length of the reply
+*
+* Return:
+*  (uint32_t) COMMAND_SUCCESS
+*
+*******************************************************************************/
+static uint32_t led_command(uint8_t const *request, uint32_t length,
+                            uint8_t *reply, uint32_t *reply_length)
+{
+    (void) length;
+
+    update_led(request[FRAME_CMD_POS]);
+
+    reply[FRAME_CMD_POS] = request[FRAME_CMD_POS];
+    *reply_length = FRAME_REPLY_LENGTH;
+
+    return COMMAND_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: frames_received
+********************************************************************************
+*
+* Summary:
+*  Frame notification from the SPI interrupt. Wakes the main loop, which
+*  then reads all waiting frames.
+*
+* Parameters:
+*  (uint32_t) frames - Number of frames completed since the last call
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void frames_received(uint32_t frames)
+{
+    (void) frames;
+    frames_pending = true;
+}
+#endif
+
+#endif
+
 /* [] END OF FILE */
 